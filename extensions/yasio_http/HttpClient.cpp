@@ -29,6 +29,7 @@
 #include "yasio_http/HttpClient.h"
 #include <errno.h>
 #include "yasio/yasio.hpp"
+#include "yasio/ref_ptr.hpp"
 
 using namespace yasio;
 
@@ -80,6 +81,23 @@ inline char* char2hex(char* p, unsigned char c, unsigned char a = 'a')
     return p;
 }
 
+inline void appendBytes(sbyte_buffer& buf, cxx17::string_view v)
+{
+    buf.insert(buf.end(), v.data(), v.data() + v.size());
+}
+
+inline void appendDecimal(sbyte_buffer& buf, size_t value)
+{
+    char digits[24];
+    char* p = digits + sizeof(digits);
+    do
+    {
+        *--p = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value);
+    buf.insert(buf.end(), p, digits + sizeof(digits));
+}
+
 std::string HttpClient::urlEncode(cxx17::string_view s)
 {
     std::string encoded;
@@ -228,7 +246,7 @@ HttpClient::~HttpClient()
     clearFinishedResponseQueue();
     if (_cookie)
     {
-        _cookie->writeFile();
+        _cookie->flush();
         delete _cookie;
     }
 }
@@ -330,6 +348,81 @@ void HttpClient::processResponse(HttpResponse* response, int channelIndex)
         finishResponse(response);
 }
 
+void HttpClient::updateHeadTemplate(HttpRequest* request, const Uri& uri)
+{
+    auto& tpl     = request->_headTemplate;
+    auto pathEtc  = uri.getPathEtc();
+    auto host     = uri.getHost();
+    if (!tpl.empty() &&
+        cxx17::string_view{tpl.data() + request->_headTemplatePathOffset, request->_headTemplatePathSize} == pathEtc &&
+        cxx17::string_view{tpl.data() + request->_headTemplateHostOffset, request->_headTemplateHostSize} == host)
+        return;
+
+    tpl.clear();
+    bool usePostData = false;
+    switch (request->getRequestType())
+    {
+    case HttpRequest::Type::Post:
+        appendBytes(tpl, _mksv("POST "));
+        usePostData = true;
+        break;
+    case HttpRequest::Type::Delete:
+        appendBytes(tpl, _mksv("DELETE "));
+        break;
+    case HttpRequest::Type::Put:
+        appendBytes(tpl, _mksv("PUT "));
+        usePostData = true;
+        break;
+    default:
+        appendBytes(tpl, _mksv("GET "));
+        break;
+    }
+
+    request->_headTemplatePathOffset = static_cast<uint32_t>(tpl.size());
+    request->_headTemplatePathSize   = static_cast<uint32_t>(pathEtc.size());
+    appendBytes(tpl, pathEtc);
+    appendBytes(tpl, _mksv(" HTTP/1.1\r\nHost: "));
+    request->_headTemplateHostOffset = static_cast<uint32_t>(tpl.size());
+    request->_headTemplateHostSize   = static_cast<uint32_t>(host.size());
+    appendBytes(tpl, host);
+    appendBytes(tpl, _mksv("\r\n"));
+
+    // process custom headers
+    struct HeaderFlag
+    {
+        enum
+        {
+            UESR_AGENT   = 1,
+            CONTENT_TYPE = 1 << 1,
+            ACCEPT       = 1 << 2,
+        };
+    };
+    int headerFlags = 0;
+    for (auto& header : request->getHeaders())
+    {
+        appendBytes(tpl, header);
+        appendBytes(tpl, _mksv("\r\n"));
+
+        if (cxx20::ic::starts_with(cxx17::string_view{header}, _mksv("User-Agent:")))
+            headerFlags |= HeaderFlag::UESR_AGENT;
+        else if (cxx20::ic::starts_with(cxx17::string_view{header}, _mksv("Content-Type:")))
+            headerFlags |= HeaderFlag::CONTENT_TYPE;
+        else if (cxx20::ic::starts_with(cxx17::string_view{header}, _mksv("Accept:")))
+            headerFlags |= HeaderFlag::ACCEPT;
+    }
+
+    if (!(headerFlags & HeaderFlag::UESR_AGENT))
+        appendBytes(tpl, _mksv("User-Agent: yasio-http\r\n"));
+
+    if (!(headerFlags & HeaderFlag::ACCEPT))
+        appendBytes(tpl, _mksv("Accept: */*;q=0.8\r\n"));
+
+    if (usePostData && !(headerFlags & HeaderFlag::CONTENT_TYPE))
+        appendBytes(tpl, _mksv("Content-Type: application/x-www-form-urlencoded;charset=UTF-8\r\n"));
+
+    request->_headTemplatePostData = usePostData;
+}
+
 void HttpClient::handleNetworkEvent(yasio::io_event* event)
 {
     int channelIndex       = event->cindex();
@@ -355,105 +448,42 @@ void HttpClient::handleNetworkEvent(yasio::io_event* event)
     case YEK_ON_OPEN:
         if (event->status() == 0)
         {
-            obstream obs;
-            bool usePostData = false;
-            auto request     = response->getHttpRequest();
-            switch (request->getRequestType())
-            {
-            case HttpRequest::Type::Get:
-                obs.write_bytes("GET");
-                break;
-            case HttpRequest::Type::Post:
-                obs.write_bytes("POST");
-                usePostData = true;
-                break;
-            case HttpRequest::Type::Delete:
-                obs.write_bytes("DELETE");
-                break;
-            case HttpRequest::Type::Put:
-                obs.write_bytes("PUT");
-                usePostData = true;
-                break;
-            default:
-                obs.write_bytes("GET");
-                break;
-            }
-            obs.write_bytes(" ");
-
-            auto& uri = response->getRequestUri();
-            obs.write_bytes(uri.getPathEtc());
-
-            obs.write_bytes(" HTTP/1.1\r\n");
-
-            obs.write_bytes("Host: ");
-            obs.write_bytes(uri.getHost());
-            obs.write_bytes("\r\n");
-
-            // process custom headers
-            struct HeaderFlag
-            {
-                enum
-                {
-                    UESR_AGENT   = 1,
-                    CONTENT_TYPE = 1 << 1,
-                    ACCEPT       = 1 << 2,
-                };
-            };
-            int headerFlags = 0;
-            auto& headers   = request->getHeaders();
-            if (!headers.empty())
-            {
-                for (auto& header : headers)
-                {
-                    obs.write_bytes(header);
-                    obs.write_bytes("\r\n");
-
-                    if (cxx20::ic::starts_with(cxx17::string_view{header}, _mksv("User-Agent:")))
-                        headerFlags |= HeaderFlag::UESR_AGENT;
-                    else if (cxx20::ic::starts_with(cxx17::string_view{header}, _mksv("Content-Type:")))
-                        headerFlags |= HeaderFlag::CONTENT_TYPE;
-                    else if (cxx20::ic::starts_with(cxx17::string_view{header}, _mksv("Accept:")))
-                        headerFlags |= HeaderFlag::ACCEPT;
-                }
-            }
-
+            auto request = response->getHttpRequest();
+            auto& uri    = response->getRequestUri();
+            updateHeadTemplate(request, uri);
+
+            // Patch the variable parts only: Cookie and Content-Length
+            auto& headTemplate = request->_headTemplate;
+            auto& head         = request->_head;
+            head.clear();
+            std::string cookies;
             if (_cookie)
+                cookies = _cookie->checkAndGetFormatedMatchCookies(uri);
+            head.reserve(headTemplate.size() + cookies.size() + 48);
+            head.insert(head.end(), headTemplate.begin(), headTemplate.end());
+            if (!cookies.empty())
             {
-                auto cookies = _cookie->checkAndGetFormatedMatchCookies(uri);
-                if (!cookies.empty())
-                {
-                    obs.write_bytes("Cookie: ");
-                    obs.write_bytes(cookies);
-                }
+                appendBytes(head, _mksv("Cookie: "));
+                appendBytes(head, cookies);
+                appendBytes(head, _mksv("\r\n"));
             }
 
-            if (!(headerFlags & HeaderFlag::UESR_AGENT))
-                obs.write_bytes("User-Agent: yasio-http\r\n");
-
-            if (!(headerFlags & HeaderFlag::ACCEPT))
-                obs.write_bytes("Accept: */*;q=0.8\r\n");
-
-            if (usePostData)
-            {
-                if (!(headerFlags & HeaderFlag::CONTENT_TYPE))
-                    obs.write_bytes("Content-Type: application/x-www-form-urlencoded;charset=UTF-8\r\n");
-
-                char strContentLength[128] = {0};
-                auto requestData           = request->getRequestData();
-                auto requestDataSize       = request->getRequestDataSize();
-                snprintf(strContentLength, sizeof(strContentLength), "Content-Length: %d\r\n\r\n",
-                         static_cast<int>(requestDataSize));
-                obs.write_bytes(strContentLength);
-
-                if (requestData && requestDataSize > 0)
-                    obs.write_bytes(cxx17::string_view{requestData, static_cast<size_t>(requestDataSize)});
-            }
-            else
+            auto requestDataSize = request->getRequestDataSize();
+            if (request->_headTemplatePostData)
             {
-                obs.write_bytes("\r\n");
+                appendBytes(head, _mksv("Content-Length: "));
+                appendDecimal(head, requestDataSize);
+                appendBytes(head, _mksv("\r\n"));
             }
+            appendBytes(head, _mksv("\r\n"));
 
-            _service->write(event->transport(), std::move(obs.buffer()));
+            // The head and body are sent as one op from the request directly, by one gather write when possible,
+            // the request is retained by the completion handler until the op sent or dropped.
+            cxx17::string_view spans[2] = {{head.data(), head.size()}, {}};
+            if (request->_headTemplatePostData)
+                spans[1] = cxx17::string_view{request->getRequestData(), requestDataSize};
+            yasio::ref_ptr<HttpRequest> holder(request, yasio::own_ref_t{});
+            _service->forward(event->transport(), spans, 2, [holder](int, size_t) {});
 
             auto& timerForRead = channel->get_user_timer();
             timerForRead.cancel();
@@ -521,9 +551,10 @@ void HttpClient::finishResponse(HttpResponse* response)
 
     if (_cookie)
     {
-        auto cookieRange = response->getResponseHeaders().equal_range("set-cookie");
-        for (auto cookieIt = cookieRange.first; cookieIt != cookieRange.second; ++cookieIt)
-            _cookie->updateOrAddCookie(cookieIt->second, response->_requestUri);
+        response->getResponseHeaders().forEach("set-cookie", [this, response](cxx17::string_view value) {
+            _cookie->updateOrAddCookie(value, response->_requestUri);
+        });
+        _cookie->flushIfNeeded();
     }
 
     if (!syncState)
@@ -224,6 +224,8 @@ private:
 
     int tryTakeAvailChannel();
 
+    static void updateHeadTemplate(HttpRequest* request, const Uri& uri);
+
     void handleNetworkEvent(yasio::io_event* event);
 
     void handleNetworkEOF(HttpResponse* response, yasio::io_channel* channel, int internalErrorCode);
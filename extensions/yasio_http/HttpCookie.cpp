@@ -31,8 +31,11 @@
 #include "yasio/split.hpp"
 #include "yasio/file.hpp"
 
+#include <ctype.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <algorithm>
+#include <limits>
 #include <locale>
 #include <iomanip>
 #include <sstream>
@@ -43,6 +46,45 @@ namespace yasio_ext
 
 namespace network
 {
+enum
+{
+    JOURNAL_FLUSH_SIZE = 4096,  // bytes
+    JOURNAL_FLUSH_AGE  = 5,     // seconds
+};
+
+// The domain index key: lowercase without leading dot
+static void normalizeDomain(std::string& key, cxx17::string_view domain)
+{
+    if (!domain.empty() && domain[0] == '.')
+        domain.remove_prefix(1);
+    key.resize(domain.size());
+    for (size_t i = 0; i < domain.size(); ++i)
+        key[i] = static_cast<char>(::tolower(static_cast<unsigned char>(domain[i])));
+}
+
+// Visit buckets of host and it's parent domains, e.g. a.example.com, example.com, com
+template <typename _Fty>
+void HttpCookie::forEachMatchBucket(const Uri& uri, _Fty&& fn) const
+{
+    if (_domains.empty())
+        return;
+
+    std::string host, key;
+    normalizeDomain(host, uri.getHost());
+    size_t offset = 0;
+    for (;;)
+    {
+        key.assign(host, offset, std::string::npos);
+        auto it = _domains.find(key);
+        if (it != _domains.end())
+            fn(it->second, offset == 0);
+        auto dot = host.find('.', offset);
+        if (dot == std::string::npos)
+            break;
+        offset = dot + 1;
+    }
+}
+
 void HttpCookie::readFile()
 {
     enum
@@ -92,63 +134,139 @@ void HttpCookie::readFile()
                 ++count;
             });
             if (count >= 7)
-                _cookies.push_back(std::move(cookieInfo));
+            {
+                ++_fileRecords;
+                updateOrAddCookie(cookieInfo, false);
+            }
         });
     }
 }
 
 const std::vector<CookieInfo>* HttpCookie::getCookies() const
 {
-    return &_cookies;
+    if (_snapshotDirty)
+    {
+        _snapshot.clear();
+        _snapshot.reserve(_cookieCount);
+        for (auto& item : _domains)
+        {
+            for (auto& cookie : item.second)
+                _snapshot.push_back(cookie);
+        }
+        _snapshotDirty = false;
+    }
+    return &_snapshot;
 }
 
 const CookieInfo* HttpCookie::getMatchCookie(const Uri& uri) const
 {
-    for (auto& cookie : _cookies)
+    const CookieInfo* ret = nullptr;
+    auto now              = yasio::time_now();
+    forEachMatchBucket(uri, [&](const DomainBucket& bucket, bool exactHost) {
+        if (ret)
+            return;
+        for (auto& cookie : bucket)
+        {
+            if ((exactHost || cookie.tailmatch) && now < cookie.expires && cxx20::starts_with(uri.getPath(), cookie.path))
+            {
+                ret = &cookie;
+                break;
+            }
+        }
+    });
+    return ret;
+}
+
+void HttpCookie::updateOrAddCookie(CookieInfo* cookie)
+{
+    updateOrAddCookie(*cookie, true);
+}
+
+bool HttpCookie::updateOrAddCookie(CookieInfo& cookie, bool journal)
+{
+    if (journal)
+    {
+        if (_journal.empty())
+            _journalTime = yasio::time_now();
+        appendRecord(_journal, cookie);
+        ++_journalRecords;
+    }
+
+    std::string key;
+    normalizeDomain(key, cookie.domain);
+    auto& bucket = _domains[key];
+
+    bool expired = cookie.expires <= yasio::time_now();
+    auto it      = std::find_if(bucket.begin(), bucket.end(), [&](const CookieInfo& item) { return item.name == cookie.name; });
+    if (it != bucket.end())
     {
-        if (cxx20::ends_with(uri.getHost(), cookie.domain) && cxx20::starts_with(uri.getPath(), cookie.path))
-            return &cookie;
+        _snapshotDirty = true;
+        if (expired)
+        {  // deleted by server
+            bucket.erase(it);
+            --_cookieCount;
+            return true;
+        }
+        CookieInfo merged = std::move(*it);
+        merged.updateValue(cookie);
+        bucket.erase(it);
+        cookie = std::move(merged);
     }
+    else
+    {
+        if (expired)
+            return false;
+        _snapshotDirty = true;
+        ++_cookieCount;
+    }
+
+    if (cookie.expires != (std::numeric_limits<time_t>::max)())
+        _expiryQueue.push(ExpiryEntry{cookie.expires, &bucket, cookie.name});
 
-    return nullptr;
+    // keep longer path first, see: https://datatracker.ietf.org/doc/html/rfc6265#section-5.4
+    auto pos = std::find_if(bucket.begin(), bucket.end(), [&](const CookieInfo& item) { return item.path.size() < cookie.path.size(); });
+    bucket.insert(pos, std::move(cookie));
+    return true;
 }
 
-void HttpCookie::updateOrAddCookie(CookieInfo* cookie)
+void HttpCookie::purgeExpired(time_t now)
 {
-    for (auto& _cookie : _cookies)
+    while (!_expiryQueue.empty() && _expiryQueue.top().expires <= now)
     {
-        if (cookie->isSame(_cookie))
+        auto& entry  = _expiryQueue.top();
+        auto& bucket = *entry.bucket;
+        // the entry is stale if the cookie was updated or removed
+        auto it = std::find_if(bucket.begin(), bucket.end(),
+                               [&](const CookieInfo& item) { return item.expires == entry.expires && item.name == entry.name; });
+        if (it != bucket.end())
         {
-            _cookie.updateValue(*cookie);
-            return;
+            bucket.erase(it);
+            --_cookieCount;
+            _snapshotDirty = true;
         }
+        _expiryQueue.pop();
     }
-    _cookies.push_back(std::move(*cookie));
 }
 
 std::string HttpCookie::checkAndGetFormatedMatchCookies(const Uri& uri)
 {
+    purgeExpired(yasio::time_now());
+
     std::string ret;
-    for (auto iter = _cookies.begin(); iter != _cookies.end();)
-    {
-        auto& cookie = *iter;
-        if (cxx20::ends_with(uri.getHost(), cookie.domain) && cxx20::starts_with(uri.getPath(), cookie.path))
+    forEachMatchBucket(uri, [&](const DomainBucket& bucket, bool exactHost) {
+        for (auto& cookie : bucket)
         {
-            if (yasio::time_now() >= cookie.expires)
+            if ((exactHost || cookie.tailmatch) && cxx20::starts_with(uri.getPath(), cookie.path))
             {
-                iter = _cookies.erase(iter);
-                continue;
-            }
+                if (!ret.empty())
+                    ret += "; ";
 
-            if (!ret.empty())
-                ret += "; ";
-
-            ret += cookie.name;
-            ret.push_back('=');
-            ret += cookie.value;
+                ret += cookie.name;
+                ret.push_back('=');
+                ret += cookie.value;
+            }
         }
-        ++iter;
-    }
+    });
     return ret;
 }
 
@@ -251,10 +369,32 @@ bool HttpCookie::updateOrAddCookie(const cxx17::string_view& cookie, const Uri&
     return true;
 }
 
+void HttpCookie::appendRecord(std::string& out, const CookieInfo& cookie)
+{
+    char expires[32] = {0};  // LONGLONG_STRING_SIZE=20
+    out.append(cookie.domain);
+    out.append(1, '\t');
+    cookie.tailmatch ? out.append("TRUE") : out.append("FALSE");
+    out.append(1, '\t');
+    out.append(cookie.path);
+    out.append(1, '\t');
+    cookie.secure ? out.append("TRUE") : out.append("FALSE");
+    out.append(1, '\t');
+    snprintf(expires, sizeof(expires), "%lld", static_cast<long long>(cookie.expires));
+    out.append(expires);
+    out.append(1, '\t');
+    out.append(cookie.name);
+    out.append(1, '\t');
+    out.append(cookie.value);
+    out.append(1, '\n');
+}
+
 void HttpCookie::writeFile()
 {
     FILE* out;
     out = fopen(_cookieFileName.c_str(), "wb");
+    if (!out)
+        return;
     fputs(
         "# Netscape HTTP Cookie File\n"
         "# http://curl.haxx.se/docs/http-cookies.html\n"
@@ -262,32 +402,52 @@ void HttpCookie::writeFile()
         "# Test yasio_http cookie write.\n\n",
         out);
 
-    std::string line;
+    std::string content;
+    auto now = yasio::time_now();
+    for (auto& item : _domains)
+    {
+        for (auto& cookie : item.second)
+        {
+            if (now < cookie.expires)
+                appendRecord(content, cookie);
+        }
+    }
+    fwrite(content.data(), 1, content.size(), out);
 
-    char expires[32] = {0};  // LONGLONG_STRING_SIZE=20
-    for (auto& cookie : _cookies)
+    fclose(out);
+
+    _fileRecords = _cookieCount;
+    _journal.clear();
+    _journalRecords = 0;
+}
+
+void HttpCookie::flush()
+{
+    if (_journal.empty() || _cookieFileName.empty())
+        return;
+
+    // compact when the file not created yet or most records are overwritten
+    if (_fileRecords == 0 || _fileRecords + _journalRecords > 2 * _cookieCount + 64)
     {
-        line.clear();
-        line.append(cookie.domain);
-        line.append(1, '\t');
-        cookie.tailmatch ? line.append("TRUE") : line.append("FALSE");
-        line.append(1, '\t');
-        line.append(cookie.path);
-        line.append(1, '\t');
-        cookie.secure ? line.append("TRUE") : line.append("FALSE");
-        line.append(1, '\t');
-        snprintf(expires, sizeof(expires), "%lld", static_cast<long long>(cookie.expires));
-        line.append(expires);
-        line.append(1, '\t');
-        line.append(cookie.name);
-        line.append(1, '\t');
-        line.append(cookie.value);
-        // line.append(1, '\n');
-
-        fprintf(out, "%s\n", line.c_str());
+        writeFile();
+        return;
     }
 
+    FILE* out = fopen(_cookieFileName.c_str(), "ab");
+    if (!out)
+        return;
+    fwrite(_journal.data(), 1, _journal.size(), out);
     fclose(out);
+
+    _fileRecords += _journalRecords;
+    _journal.clear();
+    _journalRecords = 0;
+}
+
+void HttpCookie::flushIfNeeded()
+{
+    if (_journal.size() >= JOURNAL_FLUSH_SIZE || (!_journal.empty() && yasio::time_now() - _journalTime >= JOURNAL_FLUSH_AGE))
+        flush();
 }
 
 void HttpCookie::setCookieFileName(cxx17::string_view filename)
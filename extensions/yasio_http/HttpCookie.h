@@ -29,7 +29,11 @@
 /// @cond DO_NOT_SHOW
 
 #include <string.h>
+#include <time.h>
+#include <functional>
+#include <queue>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "yasio/string_view.hpp"
@@ -95,12 +99,27 @@ struct CookieInfo
     time_t expires = 0;
 };
 
+/**
+ * The cookie jar, cookies are indexed by domain and sorted by path length in each domain,
+ * so a request only visits the cookies of it's host and parent domains.
+ *
+ * Changes are journaled to the cookie file by flush(), the file is rewritten only when
+ * the journal grows too large.
+ */
 class HttpCookie
 {
 public:
     void readFile();
 
+    /** Rewrite the cookie file with live cookies */
     void writeFile();
+
+    /** Append the changed cookies since last flush to the cookie file */
+    void flush();
+
+    /** Flush only when the journal exceeds the size or age limit, keep file IO off the per response path */
+    void flushIfNeeded();
+
     void setCookieFileName(cxx17::string_view fileName);
 
     const std::vector<CookieInfo>* getCookies() const;
@@ -112,8 +131,38 @@ public:
     bool updateOrAddCookie(const cxx17::string_view& cookie, const Uri& uri);
 
 private:
+    // cookies of same domain, sorted by path length descending
+    typedef std::vector<CookieInfo> DomainBucket;
+
+    struct ExpiryEntry
+    {
+        time_t expires;
+        DomainBucket* bucket;  // the bucket node never erased, so pointer is stable
+        std::string name;
+
+        bool operator>(const ExpiryEntry& rhs) const { return expires > rhs.expires; }
+    };
+
+    bool updateOrAddCookie(CookieInfo& cookie, bool journal);
+    void purgeExpired(time_t now);
+    void appendRecord(std::string& out, const CookieInfo& cookie);
+
+    template <typename _Fty>
+    void forEachMatchBucket(const Uri& uri, _Fty&& fn) const;
+
     std::string _cookieFileName;
-    std::vector<CookieInfo> _cookies;
+
+    std::unordered_map<std::string, DomainBucket> _domains;
+    std::priority_queue<ExpiryEntry, std::vector<ExpiryEntry>, std::greater<ExpiryEntry>> _expiryQueue;
+    size_t _cookieCount = 0;
+
+    std::string _journal;        // records not flushed yet
+    size_t _journalRecords = 0;  // count of records in journal
+    time_t _journalTime    = 0;  // time of the oldest record in journal
+    size_t _fileRecords    = 0;  // count of records in cookie file, include overwritten ones
+
+    mutable std::vector<CookieInfo> _snapshot;
+    mutable bool _snapshotDirty = false;
 };
 
 }  // namespace network
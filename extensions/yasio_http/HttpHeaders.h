@@ -0,0 +1,261 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// A multi-platform support c++11 library with focus on asynchronous socket I/O for any
+// client application.
+//////////////////////////////////////////////////////////////////////////////////////////
+/*
+The MIT License (MIT)
+
+Copyright (c) 2012-2024 HALX99
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef YASIO__EXT_HTTP_HEADERS_H
+#define YASIO__EXT_HTTP_HEADERS_H
+
+#include <ctype.h>
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+#include "yasio/string_view.hpp"
+#include "yasio/byte_buffer.hpp"
+
+namespace yasio_ext
+{
+
+namespace network
+{
+/**
+ * Flat header block, all names and values are stored in one arena, and indexed by a case insensitive hash.
+ *
+ * The names are stored lowercase, header.first & header.second are string views into the arena,
+ * they are valid until the headers cleared, a copy rebuilds the views into its own arena.
+ */
+class HttpHeaders
+{
+public:
+    struct Entry
+    {
+        cxx17::string_view first;   // name
+        cxx17::string_view second;  // value
+
+        uint32_t nameOffset;
+        uint32_t nameLength;
+        uint32_t valueOffset;
+        uint32_t valueLength;
+        uint32_t hash;
+        int next;  // next entry index with same bucket, -1 for end
+    };
+
+    typedef std::vector<Entry>::const_iterator const_iterator;
+
+    HttpHeaders()
+    {
+        _arena.reserve(1024);
+        _entries.reserve(16);
+        clearBuckets();
+    }
+    HttpHeaders(const HttpHeaders& rhs) { *this = rhs; }
+    HttpHeaders(HttpHeaders&& rhs) { *this = std::move(rhs); }
+
+    HttpHeaders& operator=(const HttpHeaders& rhs)
+    {
+        if (this != &rhs)
+        {
+            _arena   = rhs._arena;
+            _entries = rhs._entries;
+            copyIndex(rhs);
+        }
+        return *this;
+    }
+    HttpHeaders& operator=(HttpHeaders&& rhs)
+    {
+        if (this != &rhs)
+        {
+            _arena   = std::move(rhs._arena);
+            _entries = std::move(rhs._entries);
+            copyIndex(rhs);
+            rhs.clear();
+        }
+        return *this;
+    }
+
+    void clear()
+    {
+        _arena.clear();
+        _entries.clear();
+        clearBuckets();
+    }
+
+    bool empty() const { return _entries.empty(); }
+    size_t size() const { return _entries.size(); }
+
+    const_iterator begin() const { return _entries.begin(); }
+    const_iterator end() const { return _entries.end(); }
+
+    /**
+     * Gets the first value of header, empty if not present.
+     */
+    cxx17::string_view find(cxx17::string_view name) const
+    {
+        auto entry = findEntry(name);
+        return entry ? entry->second : cxx17::string_view{};
+    }
+
+    bool contains(cxx17::string_view name) const { return findEntry(name) != nullptr; }
+
+    /**
+     * Visit all values of header with the same name in received order, e.g. set-cookie
+     */
+    template <typename _Fty>
+    void forEach(cxx17::string_view name, _Fty&& fn) const
+    {
+        uint32_t hash = hashName(name.data(), name.size());
+        for (int index = _buckets[hash & (BUCKET_COUNT - 1)]; index != -1; index = _entries[index].next)
+        {
+            auto& entry = _entries[index];
+            if (entry.hash == hash && cxx20::ic::iequals(entry.first, name))
+                fn(entry.second);
+        }
+    }
+
+    // --- builder, used by parser, field & value may arrive in several pieces
+    void appendField(const char* at, size_t length)
+    {
+        if (!_inField)
+        {
+            if (_inValue)  // the previous header has empty value without value complete notification
+                completeValue();
+            _inField = true;
+            Entry entry{};
+            entry.nameOffset  = static_cast<uint32_t>(_arena.size());
+            entry.valueOffset = entry.nameOffset;
+            entry.next        = -1;
+            _entries.push_back(entry);
+        }
+        for (size_t i = 0; i < length; ++i)
+            _arena.push_back(static_cast<char>(::tolower(static_cast<unsigned char>(at[i]))));
+    }
+    void completeField()
+    {
+        _inField          = false;
+        _inValue          = true;
+        auto& entry       = _entries.back();
+        entry.nameLength  = static_cast<uint32_t>(_arena.size() - entry.nameOffset);
+        entry.hash        = hashName(_arena.data() + entry.nameOffset, entry.nameLength);
+        entry.valueOffset = static_cast<uint32_t>(_arena.size());
+    }
+    void appendValue(const char* at, size_t length) { _arena.insert(_arena.end(), at, at + length); }
+    void completeValue()
+    {
+        _inValue          = false;
+        int index         = static_cast<int>(_entries.size() - 1);
+        auto& entry       = _entries[index];
+        entry.valueLength = static_cast<uint32_t>(_arena.size() - entry.valueOffset);
+
+        // append to tail of bucket chain to keep the received order
+        int* slot = &_buckets[entry.hash & (BUCKET_COUNT - 1)];
+        while (*slot != -1)
+            slot = &_entries[*slot].next;
+        *slot = index;
+        seal();
+    }
+
+private:
+    enum
+    {
+        BUCKET_COUNT = 32
+    };
+
+    // Update views of new entries, or rebase all views when the arena reallocated
+    void seal()
+    {
+        auto base = _arena.data();
+        for (size_t i = (base == _sealedData) ? _sealedCount : 0; i < _entries.size(); ++i)
+        {
+            auto& entry  = _entries[i];
+            entry.first  = cxx17::string_view{base + entry.nameOffset, entry.nameLength};
+            entry.second = cxx17::string_view{base + entry.valueOffset, entry.valueLength};
+        }
+        _sealedData  = base;
+        _sealedCount = _entries.size();
+    }
+
+    // Copy the index & builder state, then rebuild the views of completed entries from the offsets
+    void copyIndex(const HttpHeaders& rhs)
+    {
+        for (int i = 0; i < BUCKET_COUNT; ++i)
+            _buckets[i] = rhs._buckets[i];
+        _inField     = rhs._inField;
+        _inValue     = rhs._inValue;
+        _sealedData  = nullptr;
+        _sealedCount = 0;
+        seal();
+        if (_inField || _inValue)  // the entry being built is sealed when its value completed
+            --_sealedCount;
+    }
+
+    const Entry* findEntry(cxx17::string_view name) const
+    {
+        uint32_t hash = hashName(name.data(), name.size());
+        for (int index = _buckets[hash & (BUCKET_COUNT - 1)]; index != -1; index = _entries[index].next)
+        {
+            auto& entry = _entries[index];
+            if (entry.hash == hash && cxx20::ic::iequals(entry.first, name))
+                return &entry;
+        }
+        return nullptr;
+    }
+
+    void clearBuckets()
+    {
+        for (auto& bucket : _buckets)
+            bucket = -1;
+        _inField     = false;
+        _inValue     = false;
+        _sealedData  = nullptr;
+        _sealedCount = 0;
+    }
+
+    // FNV-1a of lowercase name
+    static uint32_t hashName(const char* name, size_t len)
+    {
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i < len; ++i)
+        {
+            hash ^= static_cast<uint32_t>(::tolower(static_cast<unsigned char>(name[i])));
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    yasio::sbyte_buffer _arena;
+    std::vector<Entry> _entries;
+    int _buckets[BUCKET_COUNT];
+    bool _inField           = false;
+    bool _inValue           = false;
+    const char* _sealedData = nullptr;
+    size_t _sealedCount     = 0;
+};
+
+}  // namespace network
+
+}  // namespace yasio_ext
+
+#endif  // YASIO__EXT_HTTP_HEADERS_H
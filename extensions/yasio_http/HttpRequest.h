@@ -120,7 +120,11 @@ public:
      *
      * @param type the request type.
      */
-    void setRequestType(Type type) { _requestType = type; }
+    void setRequestType(Type type)
+    {
+        _requestType = type;
+        _headTemplate.clear();
+    }
 
     /**
      * Get the request type of HttpRequest object.
@@ -225,7 +229,11 @@ public:
      *
      * @param headers The string vector of custom-defined headers.
      */
-    void setHeaders(const std::vector<std::string>& headers) { _headers = headers; }
+    void setHeaders(const std::vector<std::string>& headers)
+    {
+        _headers = headers;
+        _headTemplate.clear();
+    }
 
     /**
      * Get custom headers.
@@ -267,6 +275,18 @@ protected:
     std::vector<std::string> _hosts;
 
     std::shared_ptr<std::promise<HttpResponse*>> _syncState;
+
+    /// The cached request head without Cookie and Content-Length, rebuilt when type, headers
+    /// or the target (host, path) changed, see HttpClient::updateHeadTemplate
+    yasio::sbyte_buffer _headTemplate;
+    uint32_t _headTemplatePathOffset = 0;
+    uint32_t _headTemplatePathSize   = 0;
+    uint32_t _headTemplateHostOffset = 0;
+    uint32_t _headTemplateHostSize   = 0;
+    bool _headTemplatePostData       = false;
+
+    /// The head being sent, the template patched with Cookie and Content-Length, kept until sent
+    yasio::sbyte_buffer _head;
 };
 
 }  // namespace network
@@ -27,11 +27,8 @@
 
 #ifndef __YASIO_EXT_HTTP_RESPONSE__
 #define __YASIO_EXT_HTTP_RESPONSE__
-#include <ctype.h>
-#include <map>
-#include <unordered_map>
-#include <algorithm>
 #include "yasio_http/HttpRequest.h"
+#include "yasio_http/HttpHeaders.h"
 #include "yasio_http/Uri.h"
 #include "llhttp.h"
 
@@ -58,7 +55,7 @@ class HttpResponse : public TSRefCountedObject
     friend class HttpClient;
 
 public:
-    using ResponseHeaderMap = std::multimap<std::string, std::string>;
+    using ResponseHeaderMap = HttpHeaders;
 
     /**
      * Constructor, it's used by HttpClient internal, users don't need to create HttpResponse manually.
@@ -143,10 +140,11 @@ private:
     {
         if ((_redirectCount < HttpRequest::MAX_REDIRECT_COUNT))
         {
-            auto iter = _responseHeaders.find("location");
-            if (iter != _responseHeaders.end())
+            auto location = _responseHeaders.find("location");
+            if (!location.empty())
             {
-                auto redirectUrl = iter->second;
+                // copy it, the headers will be cleared by setLocation
+                std::string redirectUrl(location.data(), location.size());
                 if (_responseCode == 302)
                     getHttpRequest()->setRequestType(HttpRequest::Type::Get);
                 // YASIO_LOG("Process url redirect (%d): %s", _responseCode, redirectUrl.c_str());
@@ -180,7 +178,6 @@ private:
             _responseHeaders.clear();
             _finished = false;
             _responseData.clear();
-            _currentHeader.clear();
             _responseCode = -1;
             _internalCode = 0;
 
@@ -214,26 +211,25 @@ private:
     static int on_header_field(llhttp_t* context, const char* at, size_t length)
     {
         auto thiz = (HttpResponse*)context->data;
-        thiz->_currentHeader.insert(thiz->_currentHeader.end(), at, at + length);
+        thiz->_responseHeaders.appendField(at, length);
         return 0;
     }
     static int on_header_field_complete(llhttp_t* context)
     {
         auto thiz = (HttpResponse*)context->data;
-        std::transform(thiz->_currentHeader.begin(), thiz->_currentHeader.end(), thiz->_currentHeader.begin(),
-                       ::tolower);
+        thiz->_responseHeaders.completeField();
         return 0;
     }
     static int on_header_value(llhttp_t* context, const char* at, size_t length)
     {
         auto thiz = (HttpResponse*)context->data;
-        thiz->_currentHeaderValue.insert(thiz->_currentHeaderValue.end(), at, at + length);
+        thiz->_responseHeaders.appendValue(at, length);
         return 0;
     }
     static int on_header_value_complete(llhttp_t* context)
     {
         auto thiz = (HttpResponse*)context->data;
-        thiz->_responseHeaders.emplace(std::move(thiz->_currentHeader), std::move(thiz->_currentHeaderValue));
+        thiz->_responseHeaders.completeValue();
         return 0;
     }
     static int on_body(llhttp_t* context, const char* at, size_t length)
@@ -258,9 +254,7 @@ protected:
     Uri _requestUri;
     bool _finished = false;             /// to indicate if the http request is successful simply
     yasio::sbyte_buffer _responseData;  /// the returned raw data. You can also dump it as a string
-    std::string _currentHeader;
-    std::string _currentHeaderValue;
-    ResponseHeaderMap _responseHeaders;  /// the returned raw header data. You can also dump it as a string
+    ResponseHeaderMap _responseHeaders;  /// the returned headers, stored in one arena
     int _responseCode = -1;              /// the status code returned from server, e.g. 200, 404
     int _internalCode = 0;               /// the ret code of perform
     llhttp_t _context;
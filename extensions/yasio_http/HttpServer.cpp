@@ -0,0 +1,503 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// A multi-platform support c++11 library with focus on asynchronous socket I/O for any
+// client application.
+//////////////////////////////////////////////////////////////////////////////////////////
+/*
+The MIT License (MIT)
+
+Copyright (c) 2012-2024 HALX99
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "yasio_http/HttpServer.h"
+
+#include <stdio.h>
+
+#include "yasio/yasio.hpp"
+#include "llhttp.h"
+
+using namespace yasio;
+
+namespace yasio_ext
+{
+
+namespace network
+{
+
+namespace
+{
+// The owned body not larger than it is copied into the head
+enum
+{
+    INLINE_BODY_SIZE = 4096
+};
+
+const char* getStatusText(int code)
+{
+    switch (code)
+    {
+    case 100:
+        return "Continue";
+    case 101:
+        return "Switching Protocols";
+    case 200:
+        return "OK";
+    case 201:
+        return "Created";
+    case 202:
+        return "Accepted";
+    case 204:
+        return "No Content";
+    case 206:
+        return "Partial Content";
+    case 301:
+        return "Moved Permanently";
+    case 302:
+        return "Found";
+    case 304:
+        return "Not Modified";
+    case 400:
+        return "Bad Request";
+    case 401:
+        return "Unauthorized";
+    case 403:
+        return "Forbidden";
+    case 404:
+        return "Not Found";
+    case 405:
+        return "Method Not Allowed";
+    case 413:
+        return "Payload Too Large";
+    case 500:
+        return "Internal Server Error";
+    case 501:
+        return "Not Implemented";
+    case 503:
+        return "Service Unavailable";
+    default:
+        return "Unknown";
+    }
+}
+}  // namespace
+
+cxx17::string_view HttpServerRequest::getHeader(cxx17::string_view name) const
+{
+    for (auto& header : _headers)
+        if (cxx20::ic::iequals(header.first, name))
+            return header.second;
+    return cxx17::string_view{};
+}
+
+void HttpServerResponse::addHeader(cxx17::string_view name, cxx17::string_view value)
+{
+    _headers.append(name.data(), name.size());
+    _headers.append(": ", 2);
+    _headers.append(value.data(), value.size());
+    _headers.append("\r\n", 2);
+}
+
+void HttpServerResponse::setBody(cxx17::string_view body, cxx17::string_view contentType)
+{
+    _body.assign(body.data(), body.data() + body.size());
+    _staticBody = nullptr;
+    if (!contentType.empty())
+        addHeader("Content-Type", contentType);
+}
+
+void HttpServerResponse::setBody(yasio::sbyte_buffer&& body, cxx17::string_view contentType)
+{
+    _body       = std::move(body);
+    _staticBody = nullptr;
+    if (!contentType.empty())
+        addHeader("Content-Type", contentType);
+}
+
+void HttpServerResponse::setStaticBody(const void* data, size_t size, cxx17::string_view contentType)
+{
+    _body.clear();
+    _staticBody     = static_cast<const char*>(data);
+    _staticBodySize = size;
+    if (!contentType.empty())
+        addHeader("Content-Type", contentType);
+}
+
+/*
+ * The per connection state, the request head and body are appended to one arena which reused
+ * by subsequent requests of the keep-alive connection, so no allocation at steady state.
+ */
+struct HttpServer::Connection
+{
+    struct Span
+    {
+        size_t offset;
+        size_t size;
+    };
+
+    HttpServer* owner;
+    io_transport* transport;
+    llhttp_t parser;
+
+    std::string arena;
+    Span url  = {0, 0};
+    Span body = {0, 0};
+    std::vector<std::pair<Span, Span>> headers;
+    bool inField  = false;
+    bool tooLarge = false;
+    bool closing  = false;  // don't process pipelined requests any more
+
+    HttpServerRequest request;
+    HttpServerResponse response;
+
+    Connection(HttpServer* o, io_transport* t) : owner(o), transport(t)
+    {
+        static llhttp_settings_t settings = makeSettings();
+        llhttp_init(&parser, HTTP_REQUEST, &settings);
+        parser.data = this;
+    }
+
+    static llhttp_settings_t makeSettings()
+    {
+        llhttp_settings_t settings;
+        llhttp_settings_init(&settings);
+        settings.on_message_begin         = onMessageBegin;
+        settings.on_url                   = onUrl;
+        settings.on_header_field          = onHeaderField;
+        settings.on_header_field_complete = onHeaderFieldComplete;
+        settings.on_header_value          = onHeaderValue;
+        settings.on_headers_complete      = onHeadersComplete;
+        settings.on_body                  = onBody;
+        settings.on_message_complete      = onMessageComplete;
+        return settings;
+    }
+
+    bool append(const char* at, size_t length)
+    {
+        if (arena.size() + length > owner->_maxRequestSize)
+        {
+            tooLarge = true;
+            return false;
+        }
+        arena.append(at, length);
+        return true;
+    }
+
+    cxx17::string_view view(const Span& span) const { return cxx17::string_view{arena.data() + span.offset, span.size}; }
+
+    static int onMessageBegin(llhttp_t* context)
+    {
+        auto conn = (Connection*)context->data;
+        conn->arena.clear();
+        conn->headers.clear();
+        conn->url     = {0, 0};
+        conn->body    = {0, 0};
+        conn->inField = false;
+        return 0;
+    }
+    static int onUrl(llhttp_t* context, const char* at, size_t length)
+    {
+        auto conn = (Connection*)context->data;
+        if (!conn->append(at, length))
+            return -1;
+        conn->url.size += length;
+        return 0;
+    }
+    static int onHeaderField(llhttp_t* context, const char* at, size_t length)
+    {
+        auto conn = (Connection*)context->data;
+        if (!conn->inField)
+        {
+            conn->inField = true;
+            conn->headers.emplace_back(Span{conn->arena.size(), 0}, Span{0, 0});
+        }
+        if (!conn->append(at, length))
+            return -1;
+        conn->headers.back().first.size += length;
+        return 0;
+    }
+    static int onHeaderFieldComplete(llhttp_t* context)
+    {
+        auto conn                   = (Connection*)context->data;
+        conn->inField               = false;
+        conn->headers.back().second = Span{conn->arena.size(), 0};
+        return 0;
+    }
+    static int onHeaderValue(llhttp_t* context, const char* at, size_t length)
+    {
+        auto conn = (Connection*)context->data;
+        if (!conn->append(at, length))
+            return -1;
+        conn->headers.back().second.size += length;
+        return 0;
+    }
+    static int onHeadersComplete(llhttp_t* context)
+    {
+        auto conn  = (Connection*)context->data;
+        conn->body = Span{conn->arena.size(), 0};
+        if (context->content_length > conn->owner->_maxRequestSize)
+        {
+            conn->tooLarge = true;
+            return -1;
+        }
+        conn->arena.reserve(conn->arena.size() + static_cast<size_t>(context->content_length));
+        return 0;
+    }
+    static int onBody(llhttp_t* context, const char* at, size_t length)
+    {
+        auto conn = (Connection*)context->data;
+        if (!conn->append(at, length))
+            return -1;
+        conn->body.size += length;
+        return 0;
+    }
+    static int onMessageComplete(llhttp_t* context)
+    {
+        auto conn = (Connection*)context->data;
+        conn->owner->handleRequest(conn);
+        return conn->closing ? HPE_PAUSED : 0;
+    }
+};
+
+HttpServer::HttpServer(int channels) : _ownService(true)
+{
+    _service = new io_service(channels);
+    _service->set_option(YOPT_S_FORWARD_PACKET, 1);  // requests are parsed from the raw stream
+    _service->start([this](event_ptr&& e) { handleNetworkEvent(e.get()); });
+}
+
+HttpServer::HttpServer(yasio::io_service* service) : _service(service), _ownService(false) {}
+
+HttpServer::~HttpServer()
+{
+    if (_ownService)
+    {
+        _service->stop();
+        delete _service;
+    }
+    _connections.clear();
+}
+
+void HttpServer::route(cxx17::string_view method, cxx17::string_view path, RouteHandler handler)
+{
+    Route route;
+    route.method.assign(method.data(), method.size());
+    route.prefix  = !path.empty() && path.back() == '*';
+    route.handler = std::move(handler);
+    if (route.prefix)
+    {
+        route.path.assign(path.data(), path.size() - 1);
+        _prefixRoutes.push_back(std::move(route));
+    }
+    else
+    {
+        route.path.assign(path.data(), path.size());
+        auto key = route.path;
+        _exactRoutes.emplace(std::move(key), std::move(route));
+    }
+}
+
+void HttpServer::listen(int index, cxx17::string_view host, unsigned short port)
+{
+    if (static_cast<int>(_listening.size()) <= index)
+        _listening.resize(index + 1);
+    _listening[index] = true;
+
+    std::string hostName(host.data(), host.size());
+    _service->set_option(YOPT_C_MOD_FLAGS, index, YCF_REUSEADDR, 0);
+    _service->set_option(YOPT_C_REMOTE_ENDPOINT, index, hostName.c_str(), (int)port);
+    _service->open(index, YCK_TCP_SERVER);
+}
+
+void HttpServer::close(int index) { _service->close(index); }
+
+bool HttpServer::handleNetworkEvent(yasio::io_event* event)
+{
+    int index = event->cindex();
+    if (index < 0 || index >= static_cast<int>(_listening.size()) || !_listening[index])
+        return false;
+
+    switch (event->kind())
+    {
+    case YEK_ON_PACKET:
+    {
+        auto it = _connections.find(event->transport());
+        if (it == _connections.end())
+            break;
+        auto conn = it->second.get();
+        if (conn->closing)
+            break;
+
+        const char* data;
+        size_t len;
+        auto&& pkt = event->packet_view();
+        if (pkt.data())
+        {
+            data = pkt.data();
+            len  = pkt.size();
+        }
+        else
+        {
+            data = packet_data(event->packet());
+            len  = packet_len(event->packet());
+        }
+
+        auto err = llhttp_execute(&conn->parser, data, len);
+        if (err != HPE_OK && err != HPE_PAUSED && !conn->closing)
+            sendError(conn, err == HPE_PAUSED_UPGRADE ? 501 : (conn->tooLarge ? 413 : 400));
+        break;
+    }
+    case YEK_ON_OPEN:
+        if (!event->passive() && event->status() == 0)
+        {
+            auto transport = event->transport();
+            _connections[transport].reset(new Connection(this, transport));
+        }
+        break;
+    case YEK_ON_CLOSE:
+        if (!event->passive())
+            _connections.erase(event->transport());
+        break;
+    }
+    return true;
+}
+
+const HttpServer::RouteHandler* HttpServer::findRoute(cxx17::string_view method, cxx17::string_view path) const
+{
+    if (!_exactRoutes.empty())
+    {
+        auto range = _exactRoutes.equal_range(std::string{path.data(), path.size()});
+        for (auto it = range.first; it != range.second; ++it)
+            if (it->second.method.empty() || cxx20::ic::iequals(it->second.method, method))
+                return &it->second.handler;
+    }
+    for (auto& route : _prefixRoutes)
+        if (cxx20::starts_with(path, cxx17::string_view{route.path}) &&
+            (route.method.empty() || cxx20::ic::iequals(route.method, method)))
+            return &route.handler;
+    return nullptr;
+}
+
+void HttpServer::handleRequest(Connection* conn)
+{
+    ++_requestCount;
+
+    auto& request      = conn->request;
+    request._method    = llhttp_method_name(static_cast<llhttp_method_t>(conn->parser.method));
+    request._url       = conn->view(conn->url);
+    request._body      = conn->view(conn->body);
+    // upgrade not supported, the stream after request can't be parsed, so close once the response sent
+    request._keepAlive = llhttp_should_keep_alive(&conn->parser) && !conn->parser.upgrade;
+    request._transport = conn->transport;
+    request._headers.clear();
+    for (auto& header : conn->headers)
+        request._headers.emplace_back(conn->view(header.first), conn->view(header.second));
+
+    auto qpos = request._url.find('?');
+    if (qpos != cxx17::string_view::npos)
+    {
+        request._path  = request._url.substr(0, qpos);
+        request._query = request._url.substr(qpos + 1);
+    }
+    else
+    {
+        request._path  = request._url;
+        request._query = cxx17::string_view{};
+    }
+
+    auto& response           = conn->response;
+    response._status         = 200;
+    response._staticBody     = nullptr;
+    response._staticBodySize = 0;
+    response._headers.clear();
+    response._body.clear();
+
+    auto handler = findRoute(request._method, request._path);
+    if (handler)
+        (*handler)(request, response);
+    else if (_notFoundHandler)
+        _notFoundHandler(request, response);
+    else
+        response._status = 404;
+
+    sendResponse(conn, response, request._keepAlive, conn->parser.method == HTTP_HEAD);
+}
+
+void HttpServer::sendResponse(Connection* conn, HttpServerResponse& response, bool keepAlive, bool headOnly)
+{
+    size_t bodySize = response._staticBody ? response._staticBodySize : response._body.size();
+    bool inlineBody = !headOnly && !response._staticBody && bodySize <= INLINE_BODY_SIZE;
+
+    char statusLine[64];
+    int n = snprintf(statusLine, sizeof(statusLine), "HTTP/1.1 %d %s\r\n", response._status,
+                     getStatusText(response._status));
+    char contentLength[48];
+    int m = snprintf(contentLength, sizeof(contentLength), "Content-Length: %zu\r\n", bodySize);
+
+    // The head and small owned body are sent with one write, the others are sent as one op without copy
+    sbyte_buffer head;
+    head.reserve(n + response._headers.size() + m + 24 + (inlineBody ? bodySize : 0));
+    head.insert(head.end(), statusLine, statusLine + n);
+    head.insert(head.end(), response._headers.data(), response._headers.data() + response._headers.size());
+    head.insert(head.end(), contentLength, contentLength + m);
+    if (!keepAlive)
+    {
+        static const char connectionClose[] = "Connection: close\r\n";
+        head.insert(head.end(), connectionClose, connectionClose + sizeof(connectionClose) - 1);
+    }
+    static const char crlf[] = "\r\n";
+    head.insert(head.end(), crlf, crlf + 2);
+    if (inlineBody)
+        head.insert(head.end(), response._body.begin(), response._body.end());
+
+    completion_cb_t completion;
+    if (!keepAlive)
+    {
+        conn->closing  = true;
+        auto transport = conn->transport;
+        completion     = [this, transport](int, size_t) { _service->close(transport); };
+    }
+
+    if (!headOnly && !inlineBody && bodySize)
+    {
+        // the head and owned body are kept by the completion handler until sent
+        auto buffers = std::make_shared<std::pair<sbyte_buffer, sbyte_buffer>>(std::move(head), std::move(response._body));
+        cxx17::string_view spans[2] = {
+            {buffers->first.data(), buffers->first.size()},
+            {response._staticBody ? response._staticBody : buffers->second.data(), bodySize}};
+        _service->forward(conn->transport, spans, 2, [buffers, completion](int ec, size_t bytes) {
+            if (completion)
+                completion(ec, bytes);
+        });
+    }
+    else
+        _service->write(conn->transport, std::move(head), std::move(completion));
+}
+
+void HttpServer::sendError(Connection* conn, int status)
+{
+    HttpServerResponse& response = conn->response;
+    response._status             = status;
+    response._staticBody         = nullptr;
+    response._headers.clear();
+    response._body.clear();
+    sendResponse(conn, response, false, false);
+}
+
+}  // namespace network
+
+}  // namespace yasio_ext
@@ -0,0 +1,229 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// A multi-platform support c++11 library with focus on asynchronous socket I/O for any
+// client application.
+//////////////////////////////////////////////////////////////////////////////////////////
+/*
+The MIT License (MIT)
+
+Copyright (c) 2012-2024 HALX99
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef YASIO__EXT_HTTPSERVER_H
+#define YASIO__EXT_HTTPSERVER_H
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "yasio/yasio_fwd.hpp"
+#include "yasio/string_view.hpp"
+#include "yasio/byte_buffer.hpp"
+
+/**
+ * @addtogroup network
+ * @{
+ */
+
+namespace yasio_ext
+{
+
+namespace network
+{
+/**
+ * The request passed to route handler, all views are valid during the handler call only.
+ */
+class HttpServerRequest
+{
+    friend class HttpServer;
+
+public:
+    /** The method name, e.g. GET, POST */
+    cxx17::string_view getMethod() const { return _method; }
+
+    /** The request target, e.g. /metrics?format=json */
+    cxx17::string_view getUrl() const { return _url; }
+
+    /** The path of url without query */
+    cxx17::string_view getPath() const { return _path; }
+
+    /** The query of url without '?' */
+    cxx17::string_view getQuery() const { return _query; }
+
+    /** Gets header value by case insensitive name, empty if not present */
+    cxx17::string_view getHeader(cxx17::string_view name) const;
+
+    const std::vector<std::pair<cxx17::string_view, cxx17::string_view>>& getHeaders() const { return _headers; }
+
+    cxx17::string_view getBody() const { return _body; }
+
+    bool isKeepAlive() const { return _keepAlive; }
+
+    yasio::io_transport* getTransport() const { return _transport; }
+
+private:
+    cxx17::string_view _method;
+    cxx17::string_view _url;
+    cxx17::string_view _path;
+    cxx17::string_view _query;
+    cxx17::string_view _body;
+    std::vector<std::pair<cxx17::string_view, cxx17::string_view>> _headers;
+    bool _keepAlive                 = true;
+    yasio::io_transport* _transport = nullptr;
+};
+
+/**
+ * The response filled by route handler.
+ */
+class HttpServerResponse
+{
+    friend class HttpServer;
+
+public:
+    void setStatus(int code) { _status = code; }
+    int getStatus() const { return _status; }
+
+    /** Adds a response header, Content-Length and Connection are generated by server */
+    void addHeader(cxx17::string_view name, cxx17::string_view value);
+
+    /** Sets body by copy */
+    void setBody(cxx17::string_view body, cxx17::string_view contentType = "text/plain");
+
+    /** Sets body by move */
+    void setBody(yasio::sbyte_buffer&& body, cxx17::string_view contentType = "text/plain");
+
+    /**
+     * Sets body without copy, the memory must keep valid until the response sent,
+     * it's suitable for static content.
+     */
+    void setStaticBody(const void* data, size_t size, cxx17::string_view contentType = "text/plain");
+
+private:
+    int _status = 200;
+    std::string _headers;
+    yasio::sbyte_buffer _body;
+    const char* _staticBody = nullptr;
+    size_t _staticBodySize  = 0;
+};
+
+/**
+ * Lightweight HTTP/1.1 server runs on YCK_TCP_SERVER channels, request parsed by llhttp in HTTP_REQUEST mode.
+ *
+ * Keep-alive and pipelining are supported, the pipelined requests are handled in order at network thread,
+ * and the responses are queued to io_service with the same order.
+ *
+ * The server either owns an io_service, or attaches to user's io_service, in which case the user should
+ * call handleNetworkEvent with events of server channels from the event callback.
+ */
+class HttpServer
+{
+public:
+    typedef std::function<void(const HttpServerRequest&, HttpServerResponse&)> RouteHandler;
+
+    /**
+     * Create server with it's own io_service.
+     */
+    explicit HttpServer(int channels = 1);
+
+    /**
+     * Attach to user's io_service, the io_service should enable YOPT_S_FORWARD_PACKET.
+     */
+    explicit HttpServer(yasio::io_service* service);
+
+    ~HttpServer();
+
+    /**
+     * Register route handler.
+     *
+     * @param method the method to match, empty for any method
+     * @param path exact path to match, or prefix match when end with '*'
+     */
+    void route(cxx17::string_view method, cxx17::string_view path, RouteHandler handler);
+
+    /**
+     * Sets handler for unmatched requests, default reply 404.
+     */
+    void setNotFoundHandler(RouteHandler handler) { _notFoundHandler = std::move(handler); }
+
+    /**
+     * Sets max request size of head + body, default is: 1MBytes, exceed will reply 413 and close.
+     */
+    void setMaxRequestSize(size_t value) { _maxRequestSize = value; }
+
+    /**
+     * Start listening at channel index.
+     */
+    void listen(int index, cxx17::string_view host, unsigned short port);
+
+    void close(int index);
+
+    /**
+     * Process network event of server channels.
+     *
+     * @return false if the event doesn't belongs to this server
+     */
+    bool handleNetworkEvent(yasio::io_event* event);
+
+    yasio::io_service* getInternalService() { return _service; }
+
+    unsigned long long getRequestCount() const { return _requestCount; }
+
+private:
+    struct Connection;
+    struct Route
+    {
+        std::string method;
+        std::string path;
+        bool prefix;
+        RouteHandler handler;
+    };
+
+    void handleRequest(Connection* conn);
+    void sendResponse(Connection* conn, HttpServerResponse& response, bool keepAlive, bool headOnly);
+    void sendError(Connection* conn, int status);
+    const RouteHandler* findRoute(cxx17::string_view method, cxx17::string_view path) const;
+
+    yasio::io_service* _service;
+    bool _ownService;
+
+    std::vector<bool> _listening;  // channels listened by this server
+
+    // exact routes keyed by path, prefix routes are matched in order
+    std::unordered_multimap<std::string, Route> _exactRoutes;
+    std::vector<Route> _prefixRoutes;
+    RouteHandler _notFoundHandler;
+
+    size_t _maxRequestSize = 1024 * 1024;
+
+    unsigned long long _requestCount = 0;
+
+    // connections accessed at network thread only
+    std::unordered_map<yasio::io_transport*, std::unique_ptr<Connection>> _connections;
+};
+
+}  // namespace network
+
+}  // namespace yasio_ext
+
+// end group
+/// @}
+
+#endif  // YASIO__EXT_HTTPSERVER_H
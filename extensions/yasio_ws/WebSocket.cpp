@@ -0,0 +1,794 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// A multi-platform support c++11 library with focus on asynchronous socket I/O for any
+// client application.
+//////////////////////////////////////////////////////////////////////////////////////////
+/*
+The MIT License (MIT)
+
+Copyright (c) 2012-2024 HALX99
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "yasio_ws/WebSocket.h"
+
+#include <string.h>
+#include <mutex>
+#include <random>
+
+#include "yasio/yasio.hpp"
+#include "yasio/utils.hpp"
+
+#include "websocket_parser.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    include <emmintrin.h>
+#    define YASIO__WS_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#    include <arm_neon.h>
+#    define YASIO__WS_NEON 1
+#endif
+
+using namespace yasio;
+
+namespace yasio_ext
+{
+
+namespace network
+{
+
+namespace
+{
+// --- SHA-1, only used for Sec-WebSocket-Accept, see: https://tools.ietf.org/html/rfc3174
+struct Sha1
+{
+    uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+    unsigned char block[64];
+    size_t blockLen = 0;
+    uint64_t totalLen = 0;
+
+    static uint32_t rol(uint32_t v, int n) { return (v << n) | (v >> (32 - n)); }
+
+    void transform(const unsigned char* p)
+    {
+        uint32_t w[80];
+        for (int i = 0; i < 16; ++i)
+            w[i] = (uint32_t)p[i * 4] << 24 | (uint32_t)p[i * 4 + 1] << 16 | (uint32_t)p[i * 4 + 2] << 8 | p[i * 4 + 3];
+        for (int i = 16; i < 80; ++i)
+            w[i] = rol(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (int i = 0; i < 80; ++i)
+        {
+            uint32_t f, k;
+            if (i < 20)
+            {
+                f = (b & c) | (~b & d);
+                k = 0x5A827999;
+            }
+            else if (i < 40)
+            {
+                f = b ^ c ^ d;
+                k = 0x6ED9EBA1;
+            }
+            else if (i < 60)
+            {
+                f = (b & c) | (b & d) | (c & d);
+                k = 0x8F1BBCDC;
+            }
+            else
+            {
+                f = b ^ c ^ d;
+                k = 0xCA62C1D6;
+            }
+            uint32_t t = rol(a, 5) + f + e + k + w[i];
+            e          = d;
+            d          = c;
+            c          = rol(b, 30);
+            b          = a;
+            a          = t;
+        }
+        h[0] += a;
+        h[1] += b;
+        h[2] += c;
+        h[3] += d;
+        h[4] += e;
+    }
+
+    void update(const void* data, size_t len)
+    {
+        auto p = static_cast<const unsigned char*>(data);
+        totalLen += len;
+        while (len > 0)
+        {
+            size_t n = (std::min)(len, sizeof(block) - blockLen);
+            memcpy(block + blockLen, p, n);
+            blockLen += n;
+            p += n;
+            len -= n;
+            if (blockLen == sizeof(block))
+            {
+                transform(block);
+                blockLen = 0;
+            }
+        }
+    }
+
+    void final(unsigned char digest[20])
+    {
+        uint64_t bits = totalLen * 8;
+        unsigned char pad = 0x80;
+        update(&pad, 1);
+        pad = 0;
+        while (blockLen != 56)
+            update(&pad, 1);
+        unsigned char lenbuf[8];
+        for (int i = 0; i < 8; ++i)
+            lenbuf[i] = (unsigned char)(bits >> (56 - i * 8));
+        update(lenbuf, 8);
+        for (int i = 0; i < 20; ++i)
+            digest[i] = (unsigned char)(h[i / 4] >> (24 - (i % 4) * 8));
+    }
+};
+
+std::string base64Encode(const unsigned char* data, size_t len)
+{
+    static const char table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string ret;
+    ret.reserve((len + 2) / 3 * 4);
+    size_t i = 0;
+    for (; i + 2 < len; i += 3)
+    {
+        uint32_t v = (uint32_t)data[i] << 16 | (uint32_t)data[i + 1] << 8 | data[i + 2];
+        ret.push_back(table[(v >> 18) & 0x3f]);
+        ret.push_back(table[(v >> 12) & 0x3f]);
+        ret.push_back(table[(v >> 6) & 0x3f]);
+        ret.push_back(table[v & 0x3f]);
+    }
+    if (i < len)
+    {
+        uint32_t v = (uint32_t)data[i] << 16 | (i + 1 < len ? (uint32_t)data[i + 1] << 8 : 0);
+        ret.push_back(table[(v >> 18) & 0x3f]);
+        ret.push_back(table[(v >> 12) & 0x3f]);
+        ret.push_back(i + 1 < len ? table[(v >> 6) & 0x3f] : '=');
+        ret.push_back('=');
+    }
+    return ret;
+}
+
+// The masking key for client frames, no need to be cryptographic strong but should be unpredictable
+uint32_t nextRandom()
+{
+    static std::mutex mtx;
+    static std::mt19937 rng(std::random_device{}());
+    std::lock_guard<std::mutex> lck(mtx);
+    return static_cast<uint32_t>(rng());
+}
+
+// Find header value by name in the raw handshake head, the name must be lowercase
+cxx17::string_view findHeader(cxx17::string_view head, cxx17::string_view name)
+{
+    size_t pos = head.find("\r\n");
+    while (pos != cxx17::string_view::npos)
+    {
+        pos += 2;
+        auto eol = head.find("\r\n", pos);
+        if (eol == cxx17::string_view::npos || eol == pos)
+            break;
+        auto line  = head.substr(pos, eol - pos);
+        auto colon = line.find(':');
+        if (colon != cxx17::string_view::npos && cxx20::ic::iequals(line.substr(0, colon), name))
+        {
+            auto value = line.substr(colon + 1);
+            while (!value.empty() && (value.front() == ' ' || value.front() == '\t'))
+                value.remove_prefix(1);
+            while (!value.empty() && (value.back() == ' ' || value.back() == '\t'))
+                value.remove_suffix(1);
+            return value;
+        }
+        pos = eol;
+    }
+    return cxx17::string_view{};
+}
+
+bool containsToken(cxx17::string_view value, cxx17::string_view token)
+{
+    size_t start = 0;
+    while (start <= value.size())
+    {
+        auto end = value.find(',', start);
+        if (end == cxx17::string_view::npos)
+            end = value.size();
+        auto item = value.substr(start, end - start);
+        while (!item.empty() && item.front() == ' ')
+            item.remove_prefix(1);
+        while (!item.empty() && item.back() == ' ')
+            item.remove_suffix(1);
+        if (cxx20::ic::iequals(item, token))
+            return true;
+        start = end + 1;
+    }
+    return false;
+}
+}  // namespace
+
+struct WebSocket::Session
+{
+    WebSocket* owner;
+    io_transport* transport;
+    bool client;
+    bool upgraded = false;
+    bool closing  = false;  // close frame sent
+    bool failed   = false;
+    uint16_t failCode   = 0;
+    uint16_t closeCode  = 0;
+
+    std::string handshake;  // buffered handshake head
+    std::string key;        // Sec-WebSocket-Key of client
+
+    websocket_parser parser;
+    int frameOpcode   = 0;
+    bool frameFinal   = false;
+    int messageOpcode = -1;  // opcode of the message being reassembled
+    sbyte_buffer message;
+    sbyte_buffer control;
+
+    // Points to the socket buffer directly when an unmasked final frame arrived in one read
+    const char* directData = nullptr;
+
+    // Closes the transport when the close handshake not completed in time
+    highp_timer_ptr closeTimer;
+
+    Session(WebSocket* o, io_transport* t, bool c) : owner(o), transport(t), client(c)
+    {
+        parser.data = this;
+        websocket_parser_init(&parser);
+    }
+    ~Session()
+    {
+        if (closeTimer)
+            closeTimer->cancel();
+    }
+
+    int fail(uint16_t code)
+    {
+        failed   = true;
+        failCode = code;
+        return -1;
+    }
+
+    static int onFrameHeader(websocket_parser* parser)
+    {
+        auto session         = static_cast<Session*>(parser->data);
+        session->frameOpcode = parser->flags & WS_OP_MASK;
+        session->frameFinal  = !!(parser->flags & WS_FIN);
+        session->directData  = nullptr;
+
+        // https://tools.ietf.org/html/rfc6455#section-5.1
+        if (!session->client && !(parser->flags & WS_HAS_MASK))
+            return session->fail(1002);
+
+        // 0xB-0xF are reserved for further control frames
+        if (session->frameOpcode > OP_PONG)
+            return session->fail(1002);
+
+        if (session->frameOpcode >= OP_CLOSE)
+        {
+            if (!session->frameFinal || parser->length > 125)
+                return session->fail(1002);
+            session->control.clear();
+            session->control.reserve(parser->length);
+            return 0;
+        }
+
+        if (session->frameOpcode == OP_CONTINUE)
+        {
+            if (session->messageOpcode < 0)
+                return session->fail(1002);
+        }
+        else if (session->frameOpcode == OP_TEXT || session->frameOpcode == OP_BINARY)
+        {
+            if (session->messageOpcode >= 0)
+                return session->fail(1002);
+            session->messageOpcode = session->frameOpcode;
+        }
+        else
+            return session->fail(1002);
+
+        if (session->message.size() + parser->length > session->owner->_maxMessageSize)
+            return session->fail(1009);
+        session->message.reserve(session->message.size() + parser->length);
+        return 0;
+    }
+
+    static int onFrameBody(websocket_parser* parser, const char* at, size_t length)
+    {
+        auto session = static_cast<Session*>(parser->data);
+        bool masked  = !!(parser->flags & WS_HAS_MASK);
+        auto& target = session->frameOpcode >= OP_CLOSE ? session->control : session->message;
+
+        // fast path: the whole frame is in the socket buffer, deliver it without copy
+        if (!masked && session->frameFinal && target.empty() && length == parser->length)
+        {
+            session->directData = at;
+            return 0;
+        }
+
+        auto offset = target.size();
+        target.resize(offset + length);
+        if (masked)
+            parser->mask_offset = WebSocket::applyMask(target.data() + offset, at, length, parser->mask, parser->mask_offset);
+        else
+            memcpy(target.data() + offset, at, length);
+        return 0;
+    }
+
+    static int onFrameEnd(websocket_parser* parser)
+    {
+        auto session = static_cast<Session*>(parser->data);
+        const char* data;
+        size_t len;
+        bool control = session->frameOpcode >= OP_CLOSE;
+        if (session->directData)
+        {
+            data = session->directData;
+            len  = parser->length;
+        }
+        else
+        {
+            auto& source = control ? session->control : session->message;
+            data         = source.data();
+            len          = source.size();
+        }
+
+        if (control)
+            session->owner->handleMessage(session, session->frameOpcode, data, len);
+        else if (session->frameFinal)
+        {
+            int opcode             = session->messageOpcode;
+            session->messageOpcode = -1;
+            session->owner->handleMessage(session, opcode, data, len);
+            session->message.clear();
+        }
+        session->directData = nullptr;
+        return session->failed ? -1 : 0;
+    }
+};
+
+WebSocket::WebSocket(int channels) : _channels(channels)
+{
+    _service = new io_service(channels);
+    _service->set_option(YOPT_S_FORWARD_PACKET, 1);  // frames are parsed from the raw stream
+    _service->start([this](event_ptr&& e) { handleNetworkEvent(e.get()); });
+}
+
+WebSocket::~WebSocket()
+{
+    _service->stop();
+    _sessions.clear();
+    delete _service;
+}
+
+bool WebSocket::open(int index, cxx17::string_view url)
+{
+    if (index < 0 || index >= static_cast<int>(_channels.size()))
+        return false;
+
+    bool secure = false;
+    if (cxx20::ic::starts_with(url, cxx17::string_view{"ws://"}))
+        url.remove_prefix(5);
+    else if (cxx20::ic::starts_with(url, cxx17::string_view{"wss://"}))
+    {
+        url.remove_prefix(6);
+        secure = true;
+    }
+    else
+        return false;
+
+#if !defined(YASIO_SSL_BACKEND)
+    if (secure)
+        return false;
+#endif
+
+    auto slash     = url.find('/');
+    auto authority = url.substr(0, slash);
+    auto target    = slash != cxx17::string_view::npos ? url.substr(slash) : cxx17::string_view{"/"};
+    if (authority.empty())
+        return false;
+
+    unsigned short port = secure ? 443 : 80;
+    auto host           = authority;
+    auto colon          = authority.rfind(':');
+    if (colon != cxx17::string_view::npos && authority.find(']', colon) == cxx17::string_view::npos)
+    {
+        host = authority.substr(0, colon);
+        port = static_cast<unsigned short>(atoi(std::string(authority.substr(colon + 1)).c_str()));
+    }
+    if (!host.empty() && host.front() == '[' && host.back() == ']')
+        host = host.substr(1, host.size() - 2);
+
+    auto& config  = _channels[index];
+    config.client = true;
+    config.host.assign(authority.data(), authority.size());
+    config.target.assign(target.data(), target.size());
+
+    std::string hostName(host.data(), host.size());
+    _service->set_option(YOPT_C_REMOTE_ENDPOINT, index, hostName.c_str(), (int)port);
+    return _service->open(index, secure ? YCK_SSL_CLIENT : YCK_TCP_CLIENT);
+}
+
+void WebSocket::listen(int index, cxx17::string_view host, unsigned short port)
+{
+    _channels[index].client = false;
+    std::string hostName(host.data(), host.size());
+    _service->set_option(YOPT_C_REMOTE_ENDPOINT, index, hostName.c_str(), (int)port);
+    _service->open(index, YCK_TCP_SERVER);
+}
+
+int WebSocket::send(io_transport* transport, const void* data, size_t len, int opcode)
+{
+    {
+        std::lock_guard<std::mutex> lck(_upgradedMtx);
+        if (!_upgraded.count(transport->id()))
+            return -1;
+    }
+    bool client = _channels[transport->cindex()].client;
+    auto ptr    = static_cast<const char*>(data);
+    if (opcode >= OP_CLOSE || _fragmentSize == 0 || len <= _fragmentSize)
+        return sendFrame(transport, client, opcode | WS_FIN, ptr, len);
+
+    int total = 0;
+    for (size_t offset = 0; offset < len; offset += _fragmentSize)
+    {
+        size_t n  = (std::min)(_fragmentSize, len - offset);
+        int flags = offset == 0 ? opcode : OP_CONTINUE;
+        if (offset + n == len)
+            flags |= WS_FIN;
+        int ret = sendFrame(transport, client, flags, ptr + offset, n);
+        if (ret < 0)
+            return ret;
+        total += ret;
+    }
+    return total;
+}
+
+void WebSocket::close(io_transport* transport, uint16_t code, cxx17::string_view reason)
+{
+    // the session state is accessed at network thread only
+    std::string text(reason.data(), (std::min)(reason.size(), static_cast<size_t>(123)));
+    auto id = transport->id();
+    _service->schedule(std::chrono::microseconds(0), [this, id, code, text](io_service&) {
+        auto it = _sessions.find(id);
+        if (it != _sessions.end())
+            sendClose(it->second.get(), code, text, false);
+        return true;
+    });
+}
+
+void WebSocket::closeChannel(int index) { _service->close(index); }
+
+int WebSocket::sendFrame(io_transport* transport, bool client, int flags, const char* data, size_t len,
+                         std::function<void(int, size_t)> completion)
+{
+    if (client)
+        flags |= WS_HAS_MASK;
+    sbyte_buffer frame(websocket_calc_frame_size(static_cast<websocket_flags>(flags), len));
+
+    // the frame head only, the payload is copied & masked with applyMask
+    char* p = frame.data();
+    p[0]    = static_cast<char>(((flags & WS_FIN) ? 0x80 : 0) | (flags & WS_OP_MASK));
+    p[1]    = static_cast<char>((flags & WS_HAS_MASK) ? 0x80 : 0);
+    if (len < 126)
+    {
+        p[1] |= static_cast<char>(len);
+        p += 2;
+    }
+    else if (len <= 0xFFFF)
+    {
+        p[1] |= 126;
+        p[2] = static_cast<char>(len >> 8);
+        p[3] = static_cast<char>(len & 0xff);
+        p += 4;
+    }
+    else
+    {
+        p[1] |= 127;
+        for (int i = 0; i < 8; ++i)
+            p[2 + i] = static_cast<char>((static_cast<uint64_t>(len) >> (56 - i * 8)) & 0xff);
+        p += 10;
+    }
+
+    if (flags & WS_HAS_MASK)
+    {
+        uint32_t key = nextRandom();
+        memcpy(p, &key, 4);
+        applyMask(p + 4, data, len, p, 0);
+    }
+    else if (len)
+        memcpy(p, data, len);
+
+    return _service->write(transport, std::move(frame), std::move(completion));
+}
+
+uint8_t WebSocket::applyMask(char* dst, const char* src, size_t len, const char mask[4], uint8_t offset)
+{
+    // rotate the mask so the first byte of src pairs with mask[offset]
+    unsigned char rotated[16];
+    for (int i = 0; i < 16; ++i)
+        rotated[i] = static_cast<unsigned char>(mask[(i + offset) & 3]);
+
+    size_t i = 0;
+#if defined(YASIO__WS_SSE2)
+    const __m128i vmask = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rotated));
+    for (; i + 16 <= len; i += 16)
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+                         _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)), vmask));
+#elif defined(YASIO__WS_NEON)
+    const uint8x16_t vmask = vld1q_u8(rotated);
+    for (; i + 16 <= len; i += 16)
+        vst1q_u8(reinterpret_cast<uint8_t*>(dst + i),
+                 veorq_u8(vld1q_u8(reinterpret_cast<const uint8_t*>(src + i)), vmask));
+#endif
+    uint64_t wmask;
+    memcpy(&wmask, rotated, sizeof(wmask));
+    for (; i + 8 <= len; i += 8)
+    {
+        uint64_t v;
+        memcpy(&v, src + i, sizeof(v));
+        v ^= wmask;
+        memcpy(dst + i, &v, sizeof(v));
+    }
+    // i is multiple of 8 here, so the mask phase is unchanged
+    for (; i < len; ++i)
+        dst[i] = static_cast<char>(src[i] ^ rotated[i & 3]);
+
+    return static_cast<uint8_t>((offset + len) & 3);
+}
+
+std::string WebSocket::computeAccept(cxx17::string_view key)
+{
+    Sha1 sha1;
+    sha1.update(key.data(), key.size());
+    sha1.update(WEBSOCKET_UUID, sizeof(WEBSOCKET_UUID) - 1);
+    unsigned char digest[20];
+    sha1.final(digest);
+    return base64Encode(digest, sizeof(digest));
+}
+
+void WebSocket::handleNetworkEvent(io_event* event)
+{
+    switch (event->kind())
+    {
+    case YEK_ON_PACKET:
+    {
+        auto it = _sessions.find(event->transport()->id());
+        if (it != _sessions.end())
+        {
+            auto&& pkt = event->packet_view();
+            handleInput(it->second.get(), pkt.data(), pkt.size());
+        }
+        break;
+    }
+    case YEK_ON_OPEN:
+        if (event->passive() || event->status() != 0)
+        {
+            if (event->status() != 0 && _onClose)
+                _onClose(event->cindex(), nullptr, event->status());
+            break;
+        }
+        else
+        {
+            auto transport = event->transport();
+            bool client    = _channels[event->cindex()].client;
+            auto session   = new Session(this, transport, client);
+            _sessions[transport->id()].reset(session);
+            if (client)
+            {
+                unsigned char nonce[16];
+                for (int i = 0; i < 16; i += 4)
+                {
+                    uint32_t v = nextRandom();
+                    memcpy(nonce + i, &v, 4);
+                }
+                session->key = base64Encode(nonce, sizeof(nonce));
+
+                auto& config = _channels[event->cindex()];
+                std::string request;
+                request.reserve(256);
+                request += "GET ";
+                request += config.target;
+                request += " HTTP/1.1\r\nHost: ";
+                request += config.host;
+                request += "\r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Key: ";
+                request += session->key;
+                request += "\r\nSec-WebSocket-Version: 13\r\n\r\n";
+                _service->write(transport, request.data(), request.size());
+            }
+        }
+        break;
+    case YEK_ON_CLOSE:
+    {
+        auto it = _sessions.find(event->transport()->id());
+        if (it != _sessions.end())
+        {
+            auto session = it->second.get();
+            if (session->upgraded)
+            {
+                std::lock_guard<std::mutex> lck(_upgradedMtx);
+                _upgraded.erase(session->transport->id());
+            }
+            if (session->upgraded && _onClose)
+                _onClose(event->cindex(), session->transport, session->closeCode ? session->closeCode : event->status());
+            _sessions.erase(it);
+        }
+        break;
+    }
+    }
+}
+
+void WebSocket::handleInput(Session* session, const char* data, size_t len)
+{
+    if (!session->upgraded)
+    {
+        size_t consumed = 0;
+        if (!handleHandshake(session, data, len, consumed))
+        {
+            _service->close(session->transport);
+            return;
+        }
+        data += consumed;
+        len -= consumed;
+        if (!session->upgraded)
+            return;
+    }
+
+    static const websocket_parser_settings settings = {&Session::onFrameHeader, &Session::onFrameBody,
+                                                       &Session::onFrameEnd};
+    if (len > 0 && !session->failed)
+    {
+        websocket_parser_execute(&session->parser, &settings, data, len);
+        if (session->failed)
+            failSession(session, session->failCode);
+    }
+}
+
+bool WebSocket::handleHandshake(Session* session, const char* data, size_t len, size_t& consumed)
+{
+    static const size_t kMaxHandshakeSize = 8192;
+
+    // search the end of head, the delimiter may be split across reads
+    size_t prevSize = session->handshake.size();
+    session->handshake.append(data, len);
+    auto headEnd = session->handshake.find("\r\n\r\n", prevSize > 3 ? prevSize - 3 : 0);
+    if (headEnd == std::string::npos)
+    {
+        consumed = len;
+        return session->handshake.size() <= kMaxHandshakeSize;
+    }
+    headEnd += 4;
+    consumed = headEnd - prevSize;
+
+    cxx17::string_view head(session->handshake.data(), headEnd);
+    if (session->client)
+    {
+        if (!cxx20::starts_with(head, cxx17::string_view{"HTTP/1.1 101"}))
+            return false;
+        if (findHeader(head, "sec-websocket-accept") != computeAccept(session->key))
+            return false;
+    }
+    else
+    {
+        auto key = findHeader(head, "sec-websocket-key");
+        if (!cxx20::starts_with(head, cxx17::string_view{"GET "}) || key.empty() ||
+            !cxx20::ic::iequals(findHeader(head, "upgrade"), cxx17::string_view{"websocket"}) ||
+            !containsToken(findHeader(head, "connection"), "upgrade"))
+        {
+            static const char badRequest[] = "HTTP/1.1 400 Bad Request\r\nConnection: close\r\nContent-Length: 0\r\n\r\n";
+            _service->write(session->transport, badRequest, sizeof(badRequest) - 1);
+            return false;
+        }
+
+        std::string response;
+        response.reserve(160);
+        response += "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Accept: ";
+        response += computeAccept(key);
+        response += "\r\n\r\n";
+        _service->write(session->transport, response.data(), response.size());
+    }
+
+    session->upgraded = true;
+    {
+        std::lock_guard<std::mutex> lck(_upgradedMtx);
+        _upgraded.insert(session->transport->id());
+    }
+    std::string().swap(session->handshake);
+    std::string().swap(session->key);
+    if (_onOpen)
+        _onOpen(session->transport);
+    return true;
+}
+
+void WebSocket::handleMessage(Session* session, int opcode, const char* data, size_t len)
+{
+    switch (opcode)
+    {
+    case OP_PING:
+        if (!session->closing)
+            sendFrame(session->transport, session->client, OP_PONG | WS_FIN, data, len);
+        break;
+    case OP_CLOSE:
+        if (!session->closing)
+        {
+            // echo the close frame, then close transport when it was sent
+            uint16_t code = len >= 2 ? static_cast<uint16_t>(static_cast<uint8_t>(data[0]) << 8 | static_cast<uint8_t>(data[1]))
+                                     : static_cast<uint16_t>(CLOSE_NO_STATUS);
+            sendClose(session, code, {}, true);
+        }
+        else  // the peer echo our close frame
+            _service->close(session->transport);
+        break;
+    default:
+        if (_onMessage)
+            _onMessage(session->transport, opcode, cxx17::string_view{data, len});
+    }
+}
+
+void WebSocket::failSession(Session* session, uint16_t code) { sendClose(session, code, {}, true); }
+
+void WebSocket::sendClose(Session* session, uint16_t code, cxx17::string_view reason, bool closeWhenSent)
+{
+    if (session->closing)
+        return;
+    session->closing   = true;
+    session->closeCode = code;
+
+    char payload[125];
+    size_t n = 0;
+    if (code != CLOSE_NO_STATUS)  // 1005 must not be sent in the close frame
+    {
+        payload[0] = static_cast<char>(code >> 8);
+        payload[1] = static_cast<char>(code & 0xff);
+        n          = (std::min)(reason.size(), sizeof(payload) - 2);
+        memcpy(payload + 2, reason.data(), n);
+        n += 2;
+    }
+    auto transport = session->transport;
+    auto id        = transport->id();
+    std::function<void(int, size_t)> completion;
+    if (closeWhenSent)
+        completion = [this, id](int, size_t) { closeSession(id); };
+    sendFrame(transport, session->client, OP_CLOSE | WS_FIN, payload, n, std::move(completion));
+
+    // the session, and the timer with it, is released once the transport closed
+    session->closeTimer = _service->schedule(std::chrono::milliseconds(_closeTimeout), [this, id](io_service&) {
+        closeSession(id);
+        return true;
+    });
+}
+
+void WebSocket::closeSession(unsigned int id)
+{
+    // the transport of a closed session may be reused by a new connection
+    auto it = _sessions.find(id);
+    if (it != _sessions.end())
+        _service->close(it->second->transport);
+}
+
+}  // namespace network
+
+}  // namespace yasio_ext
@@ -0,0 +1,211 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// A multi-platform support c++11 library with focus on asynchronous socket I/O for any
+// client application.
+//////////////////////////////////////////////////////////////////////////////////////////
+/*
+The MIT License (MIT)
+
+Copyright (c) 2012-2024 HALX99
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef YASIO__EXT_WEBSOCKET_H
+#define YASIO__EXT_WEBSOCKET_H
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "yasio/yasio_fwd.hpp"
+#include "yasio/string_view.hpp"
+#include "yasio/byte_buffer.hpp"
+
+namespace yasio_ext
+{
+
+namespace network
+{
+/**
+ * RFC 6455 WebSocket endpoint on top of yasio::io_service.
+ *
+ * The service runs with YOPT_S_FORWARD_PACKET, so the raw stream is handed to
+ * the frame parser directly on the network thread, no length-field unpacking
+ * and no extra packet copy. All callbacks are invoked on the network thread.
+ *
+ * Each channel can be used as a client (ws://, wss://) or a server (listen).
+ */
+class WebSocket
+{
+public:
+    enum Opcode
+    {
+        OP_CONTINUE = 0x0,
+        OP_TEXT     = 0x1,
+        OP_BINARY   = 0x2,
+        OP_CLOSE    = 0x8,
+        OP_PING     = 0x9,
+        OP_PONG     = 0xA,
+    };
+
+    /** The close status code sent when user doesn't specify one. */
+    static const uint16_t CLOSE_NORMAL = 1000;
+
+    /** The close status reported when the peer's close frame has no status code. */
+    static const uint16_t CLOSE_NO_STATUS = 1005;
+
+    /** Fired when the upgrade handshake completed. */
+    typedef std::function<void(yasio::io_transport*)> OpenCallback;
+
+    /**
+     * Fired when a complete message received, fragmented messages are reassembled.
+     * The data is valid during the callback only.
+     */
+    typedef std::function<void(yasio::io_transport*, int opcode, cxx17::string_view data)> MessageCallback;
+
+    /**
+     * Fired when the transport closed, status is the close status code or a yasio error code.
+     * The transport was already closed, use it as identity only, it's nullptr when connect or listen failed.
+     */
+    typedef std::function<void(int index, yasio::io_transport*, int status)> CloseCallback;
+
+    explicit WebSocket(int channels = 1);
+    ~WebSocket();
+
+    void setOnOpen(OpenCallback cb) { _onOpen = std::move(cb); }
+    void setOnMessage(MessageCallback cb) { _onMessage = std::move(cb); }
+    void setOnClose(CloseCallback cb) { _onClose = std::move(cb); }
+
+    /**
+     * Sets max message size after reassembly, default is: 16MBytes,
+     * the transport will be closed with status 1009 when exceed.
+     */
+    void setMaxMessageSize(size_t value) { _maxMessageSize = value; }
+
+    /**
+     * Sets the fragment size for outgoing messages, 0 means never fragment, default is: 0
+     */
+    void setFragmentSize(size_t value) { _fragmentSize = value; }
+
+    /**
+     * Sets the time in milliseconds to wait the close handshake, default is: 5000,
+     * the transport will be closed when the peer doesn't answer the close frame in time.
+     */
+    void setCloseTimeout(int value) { _closeTimeout = value; }
+
+    /**
+     * Connect to the server at channel index.
+     *
+     * @param url ws://host[:port][/path] or wss://host[:port][/path]
+     * @return false if the url is malformed or wss not supported.
+     */
+    bool open(int index, cxx17::string_view url);
+
+    /**
+     * Listen at channel index as websocket server.
+     */
+    void listen(int index, cxx17::string_view host, unsigned short port);
+
+    /**
+     * Send a message, fragmented when fragment size set.
+     *
+     * @return bytes of frames queued, < 0 if transport not ready or the handshake not finished.
+     */
+    int send(yasio::io_transport* transport, const void* data, size_t len, int opcode = OP_BINARY);
+    int sendText(yasio::io_transport* transport, cxx17::string_view text) { return send(transport, text.data(), text.size(), OP_TEXT); }
+    int ping(yasio::io_transport* transport, cxx17::string_view payload = {})
+    {
+        return send(transport, payload.data(), payload.size(), OP_PING);
+    }
+
+    /**
+     * Send close frame, the transport will be closed when the peer echo the close frame,
+     * or the close timeout expired.
+     */
+    void close(yasio::io_transport* transport, uint16_t code = CLOSE_NORMAL, cxx17::string_view reason = {});
+
+    /**
+     * Close channel immediately.
+     */
+    void closeChannel(int index);
+
+    yasio::io_service* getInternalService() { return _service; }
+
+    /**
+     * Apply XOR mask, see: https://tools.ietf.org/html/rfc6455#section-5.3
+     *
+     * Process 16 bytes per step with SSE2/NEON and 8 bytes per step otherwise.
+     *
+     * @return the mask offset for next call.
+     */
+    static uint8_t applyMask(char* dst, const char* src, size_t len, const char mask[4], uint8_t offset);
+
+    /**
+     * Calc Sec-WebSocket-Accept of the Sec-WebSocket-Key.
+     */
+    static std::string computeAccept(cxx17::string_view key);
+
+private:
+    struct Session;
+
+    void handleNetworkEvent(yasio::io_event* event);
+    void handleInput(Session* session, const char* data, size_t len);
+    bool handleHandshake(Session* session, const char* data, size_t len, size_t& consumed);
+    void handleMessage(Session* session, int opcode, const char* data, size_t len);
+    void failSession(Session* session, uint16_t code);
+    void sendClose(Session* session, uint16_t code, cxx17::string_view reason, bool closeWhenSent);
+    void closeSession(unsigned int id);
+
+    int sendFrame(yasio::io_transport* transport, bool client, int flags, const char* data, size_t len,
+                  std::function<void(int, size_t)> completion = nullptr);
+
+    yasio::io_service* _service;
+
+    OpenCallback _onOpen;
+    MessageCallback _onMessage;
+    CloseCallback _onClose;
+
+    size_t _maxMessageSize = 16 * 1024 * 1024;
+    size_t _fragmentSize   = 0;
+    int _closeTimeout      = 5000;
+
+    struct ChannelConfig
+    {
+        bool client = true;
+        std::string host;    // Host header of client handshake
+        std::string target;  // request target of client handshake
+    };
+    std::vector<ChannelConfig> _channels;
+
+    // sessions accessed at network thread only, keyed by transport id, the transport objects are pooled and reused
+    std::unordered_map<unsigned int, std::unique_ptr<Session>> _sessions;
+
+    // ids of the upgraded transports, checked by send at any thread
+    std::unordered_set<unsigned int> _upgraded;
+    std::mutex _upgradedMtx;
+};
+
+}  // namespace network
+
+}  // namespace yasio_ext
+
+#endif  // YASIO__EXT_WEBSOCKET_H
@@ -0,0 +1,373 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+#include "yasio/obstream.hpp"
+#include "yasio/ibstream.hpp"
+#include "yasio/serialize.hpp"
+
+using namespace yasio;
+
+/*
+ * Verify write_array/read_array produce the same bytes as the scalar path,
+ * and compare the throughput of both.
+ */
+
+static const size_t ELEMENT_COUNT = 10000;
+static const int ROUNDS           = 1000;
+
+template <typename _Fty>
+static double measure_ns_per_elem(_Fty&& fn)
+{
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < ROUNDS; ++i)
+    fn();
+  auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+  return static_cast<double>(elapsed) / (static_cast<double>(ROUNDS) * ELEMENT_COUNT);
+}
+
+template <typename _Nty>
+static bool verify(const std::vector<_Nty>& values)
+{
+  obstream scalar;
+  for (auto v : values)
+    scalar.write(v);
+
+  obstream bulk;
+  bulk.write_array(values);
+  if (scalar.length() != bulk.length() || memcmp(scalar.data(), bulk.data(), scalar.length()) != 0)
+    return false;
+
+  // odd count and misaligned offset to cover the tail path
+  obstream odd;
+  odd.write<uint8_t>(1);
+  odd.write_array(values.data(), values.size() - 1);
+  ibstream_view ibs(&odd);
+  ibs.read<uint8_t>();
+  std::vector<_Nty> out;
+  ibs.read_array(out, values.size() - 1);
+  for (size_t i = 0; i < out.size(); ++i)
+    if (out[i] != values[i])
+      return false;
+  return ibs.eof();
+}
+
+template <typename _Nty>
+static bool run(const char* type_name, const std::vector<_Nty>& values)
+{
+  if (!verify(values))
+  {
+    printf("%s: verify failed!\n", type_name);
+    return false;
+  }
+
+  obstream obs;
+  obs.buffer().reserve(ELEMENT_COUNT * sizeof(_Nty));
+  auto scalar_write = measure_ns_per_elem([&] {
+    obs.clear();
+    for (auto v : values)
+      obs.write(v);
+  });
+  auto bulk_write = measure_ns_per_elem([&] {
+    obs.clear();
+    obs.write_array(values);
+  });
+
+  std::vector<_Nty> out(ELEMENT_COUNT);
+  volatile _Nty sink{};
+  auto scalar_read = measure_ns_per_elem([&] {
+    ibstream_view ibs(&obs);
+    for (size_t i = 0; i < ELEMENT_COUNT; ++i)
+      out[i] = ibs.template read<_Nty>();
+    sink = out[ELEMENT_COUNT - 1];
+  });
+  auto bulk_read = measure_ns_per_elem([&] {
+    ibstream_view ibs(&obs);
+    ibs.read_array(out.data(), ELEMENT_COUNT);
+    sink = out[ELEMENT_COUNT - 1];
+  });
+  (void)sink;
+
+  printf("%-8s write: %6.3f ns/elem -> %6.3f ns/elem (%5.1fx), read: %6.3f ns/elem -> %6.3f ns/elem (%5.1fx)\n", type_name, scalar_write,
+         bulk_write, scalar_write / bulk_write, scalar_read, bulk_read, scalar_read / bulk_read);
+  return true;
+}
+
+template <typename _Nty>
+static std::vector<_Nty> make_values(double scale)
+{
+  std::vector<_Nty> values(ELEMENT_COUNT);
+  for (size_t i = 0; i < ELEMENT_COUNT; ++i)
+    values[i] = static_cast<_Nty>((static_cast<double>(rand()) - RAND_MAX / 2) * scale);
+  return values;
+}
+
+static bool run_varint()
+{
+  // mostly small values like ids and deltas, with some large ones
+  std::vector<uint32_t> values(ELEMENT_COUNT);
+  for (size_t i = 0; i < ELEMENT_COUNT; ++i)
+    values[i] = (i % 16 == 0) ? static_cast<uint32_t>(rand()) * 2654435761u : static_cast<uint32_t>(rand() % 3000);
+
+  obstream ix_obs, vb_obs;
+  for (auto v : values)
+    ix_obs.write_ix(static_cast<int32_t>(v));
+  vb_obs.write_vbyte_array(values);
+
+  ibstream_view ix_ibs(&ix_obs);
+  ibstream_view vb_ibs(&vb_obs);
+  std::vector<uint32_t> out;
+  vb_ibs.read_array(out, 0);
+  vb_ibs.read_vbyte_array(out, ELEMENT_COUNT);
+  for (size_t i = 0; i < ELEMENT_COUNT; ++i)
+  {
+    if (static_cast<uint32_t>(ix_ibs.read_ix<int32_t>()) != values[i] || out[i] != values[i])
+    {
+      printf("varint: verify failed at %zu!\n", i);
+      return false;
+    }
+  }
+  if (!ix_ibs.eof() || !vb_ibs.eof())
+  {
+    printf("varint: verify failed, bytes remain!\n");
+    return false;
+  }
+
+  auto ix_write = measure_ns_per_elem([&] {
+    ix_obs.clear();
+    for (auto v : values)
+      ix_obs.write_ix(static_cast<int32_t>(v));
+  });
+  auto vb_write = measure_ns_per_elem([&] {
+    vb_obs.clear();
+    vb_obs.write_vbyte_array(values);
+  });
+
+  volatile uint32_t sink = 0;
+  auto ix_read = measure_ns_per_elem([&] {
+    ibstream_view ibs(&ix_obs);
+    for (size_t i = 0; i < ELEMENT_COUNT; ++i)
+      out[i] = static_cast<uint32_t>(ibs.read_ix<int32_t>());
+    sink = out[ELEMENT_COUNT - 1];
+  });
+  auto vb_read = measure_ns_per_elem([&] {
+    ibstream_view ibs(&vb_obs);
+    ibs.read_vbyte_array(out.data(), ELEMENT_COUNT);
+    sink = out[ELEMENT_COUNT - 1];
+  });
+  (void)sink;
+
+  printf("varint   write_ix: %6.3f ns/elem (%zu bytes), write_vbyte_array: %6.3f ns/elem (%zu bytes)\n", ix_write, ix_obs.length(), vb_write,
+         vb_obs.length());
+  printf("varint   read_ix: %6.3f ns/elem, read_vbyte_array: %6.3f ns/elem (%5.1fx)\n", ix_read, vb_read, ix_read / vb_read);
+  return true;
+}
+
+// chunked_obstream should produce the same bytes as obstream, the length fields patched across chunks
+static bool run_chunked()
+{
+  chunk_pool pool(64);
+  std::vector<int32_t> values = make_values<int32_t>(1.0);
+
+  obstream flat;
+  chunked_obstream chunked(&pool);
+  for (int i = 0; i < 100; ++i)
+  {
+    auto where  = flat.push<uint32_t>();
+    auto where2 = chunked.push<uint32_t>();
+    flat.write<uint8_t>(static_cast<uint8_t>(i));
+    chunked.write<uint8_t>(static_cast<uint8_t>(i));
+    flat.write_v("hello chunks");
+    chunked.write_v("hello chunks");
+    flat.write_array(values.data(), i);
+    chunked.write_array(values.data(), i);
+    flat.pop<uint32_t>(where);
+    chunked.pop<uint32_t>(where2);
+  }
+  auto& buffer = chunked.buffer();
+  for (size_t i = 0; i + 1 < buffer.chunks().size(); ++i)
+    if (buffer.chunks()[i].size != pool.chunk_size())
+      return false;
+  auto bytes = buffer.flatten();
+  bool ok    = bytes.size() == flat.length() && memcmp(bytes.data(), flat.data(), bytes.size()) == 0;
+  printf("chunked: %s, %d chunks\n", ok ? "ok" : "mismatch", static_cast<int>(buffer.chunks().size()));
+  return ok;
+}
+
+// the bulk half conversion should match the scalar conversion, and round trip by streams
+static bool run_half()
+{
+  for (uint32_t h = 0; h <= 0xffff; ++h)
+  {
+    uint16_t hv = static_cast<uint16_t>(h);
+    float f     = detail::half_to_float(hv), bulk;
+    detail::half_to_float_array(&bulk, &hv, 1);
+    if ((hv & 0x7c00) == 0x7c00 && (hv & 0x3ff))
+      continue; // nan
+    if (memcmp(&f, &bulk, sizeof(f)) != 0 || detail::float_to_half(f) != hv)
+    {
+      printf("half: mismatch at 0x%04x\n", h);
+      return false;
+    }
+  }
+
+  std::vector<float> values = make_values<float>(1e-3);
+  const float specials[]    = {0.0f, -0.0f, 65504.0f, 65519.0f, 65520.0f, 1e10f, -1e10f, 5.9604645e-8f, 2.9802322e-8f, 6.1035156e-5f, 1.00048828125f};
+  values.insert(values.end(), std::begin(specials), std::end(specials));
+  std::vector<uint16_t> bulk(values.size());
+  detail::float_to_half_array(bulk.data(), values.data(), values.size());
+  for (size_t i = 0; i < values.size(); ++i)
+    if (bulk[i] != detail::float_to_half(values[i]))
+    {
+      printf("half: float_to_half mismatch at %g\n", values[i]);
+      return false;
+    }
+
+  obstream obs;
+  obs.write<uint8_t>(1); // misaligned
+  obs.write_half_array(values);
+  ibstream_view ibs(&obs);
+  ibs.read<uint8_t>();
+  std::vector<float> out;
+  ibs.read_half_array(out, values.size());
+  for (size_t i = 0; i < values.size(); ++i)
+    if (out[i] != detail::half_to_float(detail::float_to_half(values[i])))
+      return false;
+  if (!ibs.eof())
+    return false;
+
+  values.resize(ELEMENT_COUNT);
+  double scalar_ns = measure_ns_per_elem([&] {
+    obstream o(ELEMENT_COUNT * 2);
+    for (auto v : values)
+      o.write(detail::float_to_half(v));
+  });
+  double bulk_ns = measure_ns_per_elem([&] {
+    obstream o(ELEMENT_COUNT * 2);
+    o.write_half_array(values);
+  });
+  printf("half     scalar: %6.3f ns/elem, write_half_array: %6.3f ns/elem (%5.1fx)\n", scalar_ns, bulk_ns, scalar_ns / bulk_ns);
+  return true;
+}
+
+enum class item_kind : uint8_t
+{
+  weapon = 1,
+  armor  = 2,
+};
+
+struct vec3 {
+  float x, y, z;
+  YASIO_DEFINE_FIELDS(x, y, z)
+};
+
+struct item_info {
+  item_kind kind;
+  int32_t id;
+  std::string name;
+  YASIO_DEFINE_FIELDS(kind, id, name)
+};
+
+struct player_info {
+  int32_t id;
+  uint16_t level;
+  std::string name;
+  vec3 pos;
+  std::array<int16_t, 4> stats;
+  std::vector<float> path;
+  std::vector<item_info> items;
+  YASIO_DEFINE_FIELDS(id, level, name, pos, stats, path, items)
+};
+
+template <typename _Stream>
+static void write_by_hand(_Stream& obs, const player_info& v)
+{
+  obs.template write<int32_t>(v.id);
+  obs.template write<uint16_t>(v.level);
+  obs.write_v(v.name);
+  obs.write(v.pos.x);
+  obs.write(v.pos.y);
+  obs.write(v.pos.z);
+  for (auto stat : v.stats)
+    obs.write(stat);
+  obs.write_ix(static_cast<int32_t>(v.path.size()));
+  for (auto p : v.path)
+    obs.write(p);
+  obs.write_ix(static_cast<int32_t>(v.items.size()));
+  for (auto& item : v.items)
+  {
+    obs.template write<uint8_t>(static_cast<uint8_t>(item.kind));
+    obs.write(item.id);
+    obs.write_v(item.name);
+  }
+}
+
+// serialize should produce the same bytes as the hand-written sequence
+static bool run_serialize()
+{
+  static_assert(is_fixed_packed<vec3>::value && fixed_packed_size<vec3>::value == 12, "vec3 should be fixed size");
+  static_assert(!is_fixed_packed<player_info>::value, "player_info should not be fixed size");
+
+  player_info player{1001, 30, "yasio", {1.5f, -2.0f, 3.25f}, {{1, 2, 3, 4}}, {0.5f, 1.5f, 2.5f}, {}};
+  player.items.push_back(item_info{item_kind::weapon, 7, "sword"});
+  player.items.push_back(item_info{item_kind::armor, 8, "shield"});
+
+  obstream manual;
+  write_by_hand(manual, player);
+  obstream generated;
+  serialize(generated, player);
+  if (generated.length() != manual.length() || packed_size(player) != manual.length() ||
+      memcmp(generated.data(), manual.data(), manual.length()) != 0)
+  {
+    printf("serialize: mismatch with hand-written!\n");
+    return false;
+  }
+
+  std::array<char, 256> storage;
+  fixed_buffer_span span(storage);
+  fixed_obstream_span span_obs(&span);
+  serialize(span_obs, player);
+  if (span_obs.length() != manual.length() || memcmp(storage.data(), manual.data(), manual.length()) != 0)
+  {
+    printf("serialize: mismatch with fixed_buffer_span!\n");
+    return false;
+  }
+
+  player_info decoded{};
+  ibstream_view ibs(&generated);
+  deserialize(ibs, decoded);
+  bool ok = ibs.eof() && decoded.id == player.id && decoded.level == player.level && decoded.name == player.name &&
+            decoded.pos.z == player.pos.z && decoded.stats == player.stats && decoded.path == player.path && decoded.items.size() == 2 &&
+            decoded.items[1].kind == item_kind::armor && decoded.items[1].name == "shield";
+  if (!ok)
+  {
+    printf("serialize: round trip failed!\n");
+    return false;
+  }
+
+  double manual_ns = measure_ns_per_elem([&] {
+    obstream obs;
+    for (size_t i = 0; i < ELEMENT_COUNT / 100; ++i)
+      write_by_hand(obs, player);
+  });
+  double generated_ns = measure_ns_per_elem([&] {
+    obstream obs;
+    for (size_t i = 0; i < ELEMENT_COUNT / 100; ++i)
+      serialize(obs, player);
+  });
+  printf("struct   hand-written: %6.3f ns/obj, serialize: %6.3f ns/obj (%5.1fx)\n", manual_ns * 100, generated_ns * 100,
+         manual_ns / generated_ns);
+  return true;
+}
+
+int main()
+{
+  srand(2024);
+  bool ok = run("int16", make_values<int16_t>(1.0 / 8)) && run("int32", make_values<int32_t>(1.0)) && run("int64", make_values<int64_t>(1e6)) &&
+            run("float", make_values<float>(1e-3)) && run("double", make_values<double>(1e-6)) && run_varint() &&
+            run_chunked() && run_serialize() &&
+            run_half();
+  printf("%s\n", ok ? "bstream test done." : "bstream test failed!");
+  return ok ? 0 : 1;
+}
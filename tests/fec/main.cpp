@@ -0,0 +1,214 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include "yasio/impl/fec.hpp"
+
+using namespace yasio;
+
+/*
+ * Verify the GF(2^8) kernel and the fec_codec recovery, then benchmark it with a local loss simulator:
+ * datagrams are sent every 1ms over a 20ms one-way link, a lost datagram not recovered by FEC costs
+ * a full RTO per retransmission, so the tail latency shows what the parity bandwidth buys.
+ */
+
+static const int MESSAGE_COUNT = 100000;
+static const int LINK_DELAY_MS = 20;
+static const int RTO_MS        = 60;
+static const int MTU           = 1400;
+
+// Gilbert-Elliott loss model, the burst_rate is the probability of staying in the lossy state
+struct loss_simulator {
+  loss_simulator(double loss_rate, double burst_rate) : loss_rate_(loss_rate), burst_rate_(burst_rate) {}
+  bool drop()
+  {
+    lossy_ = next() < (lossy_ ? burst_rate_ : loss_rate_);
+    return lossy_;
+  }
+  double next()
+  { // xorshift64
+    seed_ ^= seed_ << 13;
+    seed_ ^= seed_ >> 7;
+    seed_ ^= seed_ << 17;
+    return static_cast<double>(seed_ >> 11) / 9007199254740992.0;
+  }
+  double loss_rate_;
+  double burst_rate_;
+  bool lossy_     = false;
+  uint64_t seed_ = 0x9e3779b97f4a7c15ull;
+};
+
+static bool run_kernel()
+{
+  auto& tables = detail::gf256();
+  std::vector<uint8_t> src(4099), dst(src.size()), expect(src.size());
+  for (auto& v : src)
+    v = static_cast<uint8_t>(rand());
+  for (int c = 0; c < 256; ++c)
+  {
+    for (size_t i = 0; i < src.size(); ++i)
+      expect[i] = dst[i] ^ tables.mul(static_cast<uint8_t>(c), src[i]);
+    detail::gf256_mul_add(dst.data(), src.data(), static_cast<uint8_t>(c), src.size());
+    if (dst != expect)
+    {
+      printf("fec: gf256_mul_add mismatch, c=%d\n", c);
+      return false;
+    }
+  }
+
+  const int rounds = 100000;
+  auto start       = std::chrono::steady_clock::now();
+  for (int i = 0; i < rounds; ++i)
+    detail::gf256_mul_add(dst.data(), src.data(), static_cast<uint8_t>(i | 2), MTU);
+  double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  printf("fec      gf256_mul_add: %7.1f MB/s (checksum %d)\n", rounds * static_cast<double>(MTU) / secs / (1 << 20), dst[7]);
+  return true;
+}
+
+// Drop exactly parity_shards shards of each group, every message must be recovered
+static bool run_recovery(int data_shards, int parity_shards)
+{
+  fec_codec encoder(data_shards, parity_shards, MTU), decoder(data_shards, parity_shards, MTU);
+  std::vector<int> received(data_shards * 50, 0);
+  const int total = data_shards + parity_shards;
+  int sent        = 0;
+  bool ok         = true;
+  auto input      = [&](const char* data, int len) {
+    int id = 0;
+    memcpy(&id, data, sizeof(id));
+    if (id < 0 || id >= static_cast<int>(received.size()) || len != 4 + id % 1000)
+    {
+      ok = false;
+      return -1;
+    }
+    ++received[id];
+    return 0;
+  };
+  auto output = [&](const void* shard, int len) {
+    int seq = sent++;
+    if ((seq % total + seq / total) % total < parity_shards) // move the lost shards across groups
+      return len;
+    return decoder.decode(shard, len, input) == 0 ? len : -1;
+  };
+  std::vector<char> message(MTU);
+  for (int id = 0; id < static_cast<int>(received.size()); ++id)
+  {
+    memcpy(message.data(), &id, sizeof(id));
+    encoder.encode(message.data(), 4 + id % 1000, output);
+  }
+  for (int count : received)
+    ok = ok && count == 1;
+  if (!ok)
+    printf("fec: recovery failed with %d+%d shards\n", data_shards, parity_shards);
+  return ok;
+}
+
+struct latency_result {
+  double p50, p99, p999;
+  double bandwidth; // bytes on wire / payload bytes
+  double recovered; // ratio of lost data recovered by parity
+};
+
+static latency_result simulate(int data_shards, int parity_shards, double loss_rate, double burst_rate)
+{
+  loss_simulator link(loss_rate, burst_rate), retrans(loss_rate, burst_rate);
+  std::vector<int> latency(MESSAGE_COUNT, -1);
+  std::vector<char> message(1000);
+  int now = 0, lost = 0;
+  size_t wire_bytes = 0, payload_bytes = 0;
+
+  auto input = [&](const char* data, int /*len*/) {
+    int id = 0;
+    memcpy(&id, data, sizeof(id));
+    if (latency[id] < 0)
+      latency[id] = now + LINK_DELAY_MS - id;
+    return 0;
+  };
+  auto deliver = [&](const void* data, int len, bool is_data, fec_codec* decoder) {
+    wire_bytes += len;
+    if (link.drop())
+    {
+      lost += is_data;
+      return len;
+    }
+    if (decoder)
+      decoder->decode(data, len, input);
+    else
+      input(static_cast<const char*>(data), len);
+    return len;
+  };
+
+  if (data_shards > 0)
+  {
+    fec_codec encoder(data_shards, parity_shards, MTU), decoder(data_shards, parity_shards, MTU);
+    for (int id = 0; id < MESSAGE_COUNT; ++id, ++now)
+    {
+      memcpy(message.data(), &id, sizeof(id));
+      payload_bytes += message.size();
+      encoder.encode(message.data(), static_cast<int>(message.size()), [&](const void* shard, int len) {
+        unsigned flag = detail::fec_read_u16(static_cast<const uint8_t*>(shard) + 4);
+        return deliver(shard, len, flag == fec_codec::flag_data, &decoder);
+      });
+    }
+  }
+  else
+  {
+    for (int id = 0; id < MESSAGE_COUNT; ++id, ++now)
+    {
+      memcpy(message.data(), &id, sizeof(id));
+      payload_bytes += message.size();
+      deliver(message.data(), static_cast<int>(message.size()), true, nullptr);
+    }
+  }
+
+  int unrecovered = 0;
+  for (auto& value : latency)
+  {
+    if (value >= 0)
+      continue;
+    ++unrecovered;
+    value = LINK_DELAY_MS + RTO_MS;
+    while (retrans.drop())
+      value += RTO_MS;
+  }
+  std::sort(latency.begin(), latency.end());
+  latency_result result;
+  result.p50       = latency[MESSAGE_COUNT / 2];
+  result.p99       = latency[MESSAGE_COUNT * 99 / 100];
+  result.p999      = latency[MESSAGE_COUNT * 999 / 1000];
+  result.bandwidth = static_cast<double>(wire_bytes) / payload_bytes;
+  result.recovered = lost ? static_cast<double>(lost - unrecovered) / lost : 1.0;
+  return result;
+}
+
+static void run_benchmark()
+{
+  struct profile {
+    const char* name;
+    double loss_rate, burst_rate;
+  } profiles[] = {{"1% random", 0.01, 0.01}, {"5% random", 0.05, 0.05}, {"10% random", 0.1, 0.1}, {"5% bursty", 0.03, 0.4}};
+  struct config {
+    int data_shards, parity_shards;
+  } configs[] = {{0, 0}, {10, 3}, {4, 2}};
+
+  printf("fec      profile     shards  bandwidth  recovered  p50(ms)  p99(ms)  p999(ms)\n");
+  for (auto& p : profiles)
+    for (auto& c : configs)
+    {
+      auto r = simulate(c.data_shards, c.parity_shards, p.loss_rate, p.burst_rate);
+      printf("fec      %-10s  %2d+%-2d   %8.2fx  %8.1f%%  %7.0f  %7.0f  %8.0f\n", p.name, c.data_shards, c.parity_shards, r.bandwidth,
+             r.recovered * 100, r.p50, r.p99, r.p999);
+    }
+}
+
+int main()
+{
+  srand(2024);
+  bool ok = run_kernel() && run_recovery(10, 3) && run_recovery(4, 2) && run_recovery(1, 1) && run_recovery(200, 56);
+  if (ok)
+    run_benchmark();
+  printf("%s\n", ok ? "fec test done." : "fec test failed!");
+  return ok ? 0 : 1;
+}
@@ -6,12 +6,44 @@
 #include "yasio/yasio.hpp"
 
 #include <fstream>
+#include <memory>
 
 using namespace yasio;
 using namespace yasio_ext::network;
 
 #define CHROME_UA "User-Agent: Mozilla/5.0 (Windows NT 10.0; WOW64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/114.0.0.0 Safari/537.36"
 
+// The copies of headers own their arena, the views stay valid after the source released
+static void testHeadersCopy()
+{
+  std::unique_ptr<HttpHeaders> source(new HttpHeaders());
+  source->appendField("Content-Type", 12);
+  source->completeField();
+  source->appendValue("text/html", 9);
+  source->completeValue();
+  source->appendField("Set-Cookie", 10);
+  source->completeField();
+  source->appendValue("a=1", 3);
+  source->completeValue();
+
+  HttpHeaders copied(*source);
+  HttpHeaders assigned;
+  assigned = *source;
+  HttpHeaders temp(*source);
+  HttpHeaders moved(std::move(temp));
+  source.reset();
+
+  for (auto headers : {&copied, &assigned, &moved})
+  {
+    if (headers->size() != 2 || headers->find("content-type") != "text/html" || headers->find("SET-COOKIE") != "a=1")
+    {
+      printf("===>headers copy failed\n");
+      exit(1);
+    }
+  }
+  printf("===>headers copy succeed\n");
+}
+
 void yasioTest()
 {
   auto httpClient = HttpClient::getInstance();
@@ -38,7 +70,7 @@ void yasioTest()
       printf("===>request failed with %d\n", response->getResponseCode());
     printf("%s", "===>response headers:\n");
     for (auto& header : response->getResponseHeaders())
-      printf("\t%s: %s\n", header.first.c_str(), header.second.c_str());
+      printf("\t%.*s: %.*s\n", (int)header.first.size(), header.first.data(), (int)header.second.size(), header.second.data());
     response->release();
   }
   HttpClient::destroyInstance();
@@ -50,6 +82,7 @@ int main(int, char**)
   SetConsoleOutputCP(CP_UTF8);
 #endif
 
+  testHeadersCopy();
   yasioTest();
 
   return 0;
@@ -0,0 +1,157 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <thread>
+#include <vector>
+
+#include "yasio/yasio.hpp"
+#include "yasio_http/HttpServer.h"
+#include "llhttp.h"
+
+using namespace yasio;
+using namespace yasio_ext::network;
+
+/*
+ * wrk style load benchmark of yasio_http HttpServer:
+ *   httpdtest [duration_seconds(10)] [connections(50)] [pipeline(16)]
+ * Each connection keeps 'pipeline' requests in flight, a new request is sent once a response completed.
+ */
+
+#define HTTPD_PORT 18080
+
+static const char s_static_body[] = "OK";
+
+struct bench_conn {
+  llhttp_t parser;
+  transport_handle_t transport = nullptr;
+  std::deque<highp_time_t> inflight; // send timestamps of pipelined requests
+};
+
+struct bench_ctx {
+  io_service* service;
+  std::vector<bench_conn> conns;
+  std::vector<highp_time_t> latencies;
+  long long responses  = 0;
+  long long bytes      = 0;
+  long long errors     = 0;
+  bool stopped         = false;
+  int pipeline         = 16;
+};
+
+static const char s_request[] = "GET /health HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n";
+
+static bench_ctx* s_ctx = nullptr;
+
+static int on_response_complete(llhttp_t* parser)
+{
+  auto conn = (bench_conn*)parser->data;
+  if (conn->inflight.empty())
+    return 0;
+  s_ctx->latencies.push_back(highp_clock() - conn->inflight.front());
+  conn->inflight.pop_front();
+  ++s_ctx->responses;
+  if (!s_ctx->stopped)
+  {
+    conn->inflight.push_back(highp_clock());
+    s_ctx->service->forward(conn->transport, s_request, sizeof(s_request) - 1, nullptr);
+  }
+  return 0;
+}
+
+int main(int argc, char** argv)
+{
+  int duration    = argc > 1 ? atoi(argv[1]) : 10;
+  int connections = argc > 2 ? atoi(argv[2]) : 50;
+  int pipeline    = argc > 3 ? atoi(argv[3]) : 16;
+
+  HttpServer server;
+  server.route("GET", "/health", [](const HttpServerRequest&, HttpServerResponse& response) {
+    response.setStaticBody(s_static_body, sizeof(s_static_body) - 1);
+  });
+  server.route("GET", "/metrics", [&](const HttpServerRequest&, HttpServerResponse& response) {
+    char buf[64];
+    int n = snprintf(buf, sizeof(buf), "requests_total %llu\n", server.getRequestCount());
+    response.setBody(cxx17::string_view{buf, static_cast<size_t>(n)});
+  });
+  server.listen(0, "127.0.0.1", HTTPD_PORT);
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+  llhttp_settings_t settings;
+  llhttp_settings_init(&settings);
+  settings.on_message_complete = on_response_complete;
+
+  bench_ctx ctx;
+  ctx.conns.resize(connections);
+  ctx.pipeline = pipeline;
+  ctx.latencies.reserve(1024 * 1024);
+  s_ctx = &ctx;
+
+  io_service client(connections);
+  ctx.service = &client;
+  client.set_option(YOPT_S_FORWARD_PACKET, 1);
+  for (int i = 0; i < connections; ++i)
+    client.set_option(YOPT_C_REMOTE_ENDPOINT, i, "127.0.0.1", HTTPD_PORT);
+
+  client.start([&](event_ptr&& ev) {
+    auto& conn = ctx.conns[ev->cindex()];
+    switch (ev->kind())
+    {
+      case YEK_ON_OPEN:
+        if (ev->status() == 0)
+        {
+          conn.transport = ev->transport();
+          llhttp_init(&conn.parser, HTTP_RESPONSE, &settings);
+          conn.parser.data = &conn;
+          for (int i = 0; i < ctx.pipeline; ++i)
+          {
+            conn.inflight.push_back(highp_clock());
+            client.forward(conn.transport, s_request, sizeof(s_request) - 1, nullptr);
+          }
+        }
+        else
+          ++ctx.errors;
+        break;
+      case YEK_ON_PACKET: {
+        auto&& pkt = ev->packet_view();
+        ctx.bytes += pkt.size();
+        if (llhttp_execute(&conn.parser, pkt.data(), pkt.size()) != HPE_OK)
+          ++ctx.errors;
+        break;
+      }
+      case YEK_ON_CLOSE:
+        conn.transport = nullptr;
+        break;
+    }
+  });
+
+  printf("Running %ds test @ http://127.0.0.1:%d/health\n  %d connections, pipeline %d\n", duration, HTTPD_PORT, connections,
+         pipeline);
+  for (int i = 0; i < connections; ++i)
+    client.open(i, YCK_TCP_CLIENT);
+
+  std::this_thread::sleep_for(std::chrono::seconds(duration));
+
+  // stop at network thread to avoid race with the response handler
+  std::atomic<bool> stopped{false};
+  client.schedule(std::chrono::microseconds(1), [&](io_service&) {
+    ctx.stopped = true;
+    stopped     = true;
+    return true;
+  });
+  while (!stopped)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  client.stop();
+
+  auto& lat = ctx.latencies;
+  std::sort(lat.begin(), lat.end());
+  auto percentile = [&](double p) -> double { return lat.empty() ? 0.0 : lat[(size_t)((lat.size() - 1) * p)] / 1000.0; };
+  printf("  Latency(ms): p50=%.3f, p90=%.3f, p99=%.3f, max=%.3f\n", percentile(0.5), percentile(0.9), percentile(0.99),
+         percentile(1.0));
+  printf("  %lld requests in %ds, %.2fMB read, %lld errors\n", ctx.responses, duration, ctx.bytes / (1024.0 * 1024.0), ctx.errors);
+  printf("Requests/sec: %.2f\n", (double)ctx.responses / duration);
+  printf("Transfer/sec: %.2fMB\n", ctx.bytes / (1024.0 * 1024.0) / duration);
+  return 0;
+}
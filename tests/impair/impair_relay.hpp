@@ -0,0 +1,291 @@
+#ifndef YASIO__IMPAIR_RELAY_HPP
+#define YASIO__IMPAIR_RELAY_HPP
+#include <algorithm>
+#include <atomic>
+#include <queue>
+#include <random>
+#include <thread>
+#include <vector>
+#include "yasio/xxsocket.hpp"
+#include "yasio/io_watcher.hpp"
+#include "yasio/byte_buffer.hpp"
+#include "yasio/utils.hpp"
+
+/*
+** The user-space network impairment relay, forward local traffic from listen port to target port,
+** and impair each direction with loss, delay, jitter, reordering and bandwidth cap.
+**
+**   UDP: one client session, the last peer sent to listen port receives the replies.
+**   TCP: one connection at a time, only delay, jitter and bandwidth cap applied, the stream order kept.
+*/
+struct impair_profile {
+  const char* name;
+  double loss;    // loss rate [0,1]
+  double burst;   // the probability of keeping lossy state (Gilbert-Elliott), <= loss: random loss
+  int delay_ms;   // one-way delay
+  int jitter_ms;  // the delay varies in [-jitter, +jitter]
+  double reorder; // the rate of packets sent without delay, jump ahead of queued ones
+  int rate_kbps;  // bandwidth cap, 0: unlimited
+  int queue_ms;   // the max queuing delay under bandwidth cap, exceeds will be tail dropped(UDP only)
+};
+
+class impair_relay {
+public:
+  impair_relay(const impair_profile& profile, bool tcp, u_short listen_port, u_short target_port)
+      : profile_(profile), tcp_(tcp), listen_port_(listen_port), target_port_(target_port), rng_(20240601)
+  {}
+  ~impair_relay() { stop(); }
+
+  bool start()
+  {
+    if (tcp_)
+    {
+      if (!listener_.open(AF_INET, SOCK_STREAM) || listener_.set_optval(SOL_SOCKET, SO_REUSEADDR, 1) != 0 ||
+          listener_.bind("127.0.0.1", listen_port_) != 0 || listener_.listen(1) != 0)
+        return false;
+      listener_.set_nonblocking(true);
+      watcher_.mod_event(listener_.native_handle(), yasio::socket_event::read, 0);
+    }
+    else
+    {
+      if (!front_.open(AF_INET, SOCK_DGRAM) || front_.bind("127.0.0.1", listen_port_) != 0 || !back_.open(AF_INET, SOCK_DGRAM) ||
+          back_.connect("127.0.0.1", target_port_) != 0)
+        return false;
+      set_buffers(front_);
+      set_buffers(back_);
+      front_.set_nonblocking(true);
+      back_.set_nonblocking(true);
+      watcher_.mod_event(front_.native_handle(), yasio::socket_event::read, 0);
+      watcher_.mod_event(back_.native_handle(), yasio::socket_event::read, 0);
+    }
+    stop_flag_ = false;
+    worker_    = std::thread(&impair_relay::run, this);
+    return true;
+  }
+  void stop()
+  {
+    if (!worker_.joinable())
+      return;
+    stop_flag_ = true;
+    watcher_.wakeup();
+    worker_.join();
+  }
+
+  // The count of datagrams or chunks forwarded and dropped
+  unsigned long long forwarded() const { return forwarded_; }
+  unsigned long long dropped() const { return dropped_; }
+
+private:
+  enum
+  {
+    upstream,   // listen port --> target port
+    downstream, // target port --> listen port
+  };
+  enum
+  {
+    max_stream_backlog = 1024 * 1024, // stop reading tcp when queued bytes exceeds
+  };
+  struct packet {
+    yasio::highp_time_t release; // us
+    unsigned long long seq;
+    int dir;
+    yasio::sbyte_buffer data;
+    bool operator<(const packet& rhs) const { return release != rhs.release ? release > rhs.release : seq > rhs.seq; }
+  };
+  struct link {
+    bool lossy               = false;
+    yasio::highp_time_t next_free   = 0; // the time link idle under bandwidth cap
+    yasio::highp_time_t last_release = 0;
+    size_t backlog           = 0; // queued bytes, for tcp backpressure
+    yasio::sbyte_buffer pending; // tcp bytes partially sent
+  };
+
+  static void set_buffers(yasio::xxsocket& s)
+  {
+    s.set_optval(SOL_SOCKET, SO_RCVBUF, 4 * 1024 * 1024);
+    s.set_optval(SOL_SOCKET, SO_SNDBUF, 4 * 1024 * 1024);
+  }
+
+  double random() { return std::uniform_real_distribution<double>(0, 1)(rng_); }
+
+  bool drop(link& l)
+  {
+    l.lossy = random() < (l.lossy ? (std::max)(profile_.burst, profile_.loss) : profile_.loss);
+    return l.lossy;
+  }
+
+  void schedule(int dir, const char* data, int len)
+  {
+    auto& l  = links_[dir];
+    auto now = yasio::highp_clock();
+    if (!tcp_ && profile_.loss > 0 && drop(l))
+    {
+      ++dropped_;
+      return;
+    }
+    yasio::highp_time_t depart = now;
+    if (profile_.rate_kbps > 0)
+    {
+      auto start = (std::max)(now, l.next_free);
+      if (!tcp_ && profile_.queue_ms > 0 && start - now > profile_.queue_ms * 1000LL)
+      {
+        ++dropped_;
+        return;
+      }
+      l.next_free = start + len * 8000LL / profile_.rate_kbps;
+      depart      = l.next_free;
+    }
+    yasio::highp_time_t release = depart + profile_.delay_ms * 1000LL;
+    if (profile_.jitter_ms > 0)
+      release += static_cast<yasio::highp_time_t>((random() * 2 - 1) * profile_.jitter_ms * 1000);
+    if (!tcp_ && profile_.reorder > 0 && random() < profile_.reorder)
+      release = depart;
+    else
+    { // jitter alone never reorders, same as a real link
+      release        = (std::max)(release, l.last_release);
+      l.last_release = release;
+    }
+    l.backlog += len;
+    queue_.push(packet{release, seq_++, dir, yasio::sbyte_buffer(data, data + len)});
+  }
+
+  void run()
+  {
+    std::vector<char> buf(65536);
+    while (!stop_flag_)
+    {
+      yasio::highp_time_t wait_us = 10000;
+      if (!queue_.empty())
+        wait_us = (std::max)((yasio::highp_time_t)0, (std::min)(wait_us, queue_.top().release - yasio::highp_clock()));
+      if (!links_[upstream].pending.empty() || !links_[downstream].pending.empty())
+        wait_us = (std::min)(wait_us, (yasio::highp_time_t)1000);
+      watcher_.poll_io(wait_us);
+
+      if (tcp_)
+        handle_tcp_input(buf);
+      else
+      {
+        yasio::ip::endpoint peer;
+        int n;
+        while ((n = front_.recvfrom(buf.data(), static_cast<int>(buf.size()), peer)) > 0)
+        {
+          client_ = peer;
+          schedule(upstream, buf.data(), n);
+        }
+        while ((n = back_.recv(buf.data(), static_cast<int>(buf.size()))) > 0)
+          schedule(downstream, buf.data(), n);
+      }
+
+      auto now = yasio::highp_clock();
+      while (!queue_.empty() && queue_.top().release <= now)
+      {
+        auto& top = queue_.top();
+        output(top.dir, top.data);
+        links_[top.dir].backlog -= top.data.size();
+        queue_.pop();
+      }
+      if (tcp_)
+        flush_tcp();
+    }
+  }
+
+  void output(int dir, const yasio::sbyte_buffer& data)
+  {
+    ++forwarded_;
+    if (tcp_)
+      links_[dir].pending.insert(links_[dir].pending.end(), data.begin(), data.end());
+    else if (dir == upstream)
+      back_.send(data.data(), static_cast<int>(data.size()));
+    else if (client_.af() != 0)
+      front_.sendto(data.data(), static_cast<int>(data.size()), client_);
+  }
+
+  void handle_tcp_input(std::vector<char>& buf)
+  {
+    if (watcher_.is_ready(listener_.native_handle(), yasio::socket_event::read))
+    {
+      yasio::xxsocket conn = listener_.accept();
+      if (conn.is_open())
+      {
+        close_tcp();
+        front_ = std::move(conn);
+        if (!back_.open(AF_INET, SOCK_STREAM) || back_.connect_n("127.0.0.1", target_port_, std::chrono::seconds(3)) != 0)
+          close_tcp();
+        else
+        {
+          front_.set_nonblocking(true);
+          back_.set_nonblocking(true);
+          front_.set_optval(IPPROTO_TCP, TCP_NODELAY, 1);
+          back_.set_optval(IPPROTO_TCP, TCP_NODELAY, 1);
+          watcher_.mod_event(front_.native_handle(), yasio::socket_event::read, 0);
+          watcher_.mod_event(back_.native_handle(), yasio::socket_event::read, 0);
+        }
+      }
+    }
+    if (front_.is_open() && !read_stream(front_, upstream, buf))
+      close_tcp();
+    if (back_.is_open() && !read_stream(back_, downstream, buf))
+      close_tcp();
+  }
+  bool read_stream(yasio::xxsocket& s, int dir, std::vector<char>& buf)
+  {
+    while (links_[dir].backlog < max_stream_backlog)
+    {
+      int n = s.recv(buf.data(), static_cast<int>(buf.size()));
+      if (n > 0)
+        schedule(dir, buf.data(), n);
+      else
+        return n < 0 && yasio::xxsocket::not_recv_error(yasio::xxsocket::get_last_errno());
+    }
+    return true;
+  }
+  void flush_tcp()
+  {
+    for (int dir = upstream; dir <= downstream; ++dir)
+    {
+      auto& pending = links_[dir].pending;
+      auto& s       = dir == upstream ? back_ : front_;
+      if (pending.empty() || !s.is_open())
+        continue;
+      int n = s.send(pending.data(), static_cast<int>(pending.size()));
+      if (n > 0)
+        pending.erase(pending.begin(), pending.begin() + n);
+      else if (n < 0 && !yasio::xxsocket::not_send_error(yasio::xxsocket::get_last_errno()))
+        close_tcp();
+    }
+  }
+  void close_tcp()
+  {
+    for (auto s : {&front_, &back_})
+      if (s->is_open())
+      {
+        watcher_.mod_event(s->native_handle(), 0, yasio::socket_event::read);
+        s->close();
+      }
+    queue_   = std::priority_queue<packet>();
+    links_[upstream]   = link{};
+    links_[downstream] = link{};
+  }
+
+  impair_profile profile_;
+  bool tcp_;
+  u_short listen_port_;
+  u_short target_port_;
+
+  yasio::xxsocket listener_; // tcp only
+  yasio::xxsocket front_;    // the socket face to client
+  yasio::xxsocket back_;     // the socket face to target
+  yasio::ip::endpoint client_;
+  yasio::io_watcher watcher_;
+
+  std::priority_queue<packet> queue_;
+  link links_[2];
+  unsigned long long seq_ = 0;
+  std::mt19937 rng_;
+
+  std::thread worker_;
+  std::atomic<bool> stop_flag_{false};
+  std::atomic<unsigned long long> forwarded_{0};
+  std::atomic<unsigned long long> dropped_{0};
+};
+#endif
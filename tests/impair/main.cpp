@@ -0,0 +1,246 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include "yasio/yasio.hpp"
+#include "impair_relay.hpp"
+
+using namespace yasio;
+
+/*
+ * Benchmark TCP/UDP/KCP through the local impairment relay:
+ *   sender --> relay(loss, delay, jitter, reorder, bandwidth cap) --> receiver
+ * The sender sends timestamped messages at a fixed rate, the receiver reports goodput and one-way
+ * latency percentiles, so the kcp settings can be tuned under each profile on a single box.
+ *
+ * usage: impairtest [profile|all] [tcp|udp|kcp|all] [options]
+ *   --rate msgs/s(1000) --size bytes(1000) --time seconds(5)
+ *   --kcp-nodelay nodelay,interval,resend,nc(1,10,2,1) --kcp-window sndwnd,rcvwnd(32,128)
+ *   --kcp-fec data,parity(0,0) --kcp-flush policy,delay(0,10)
+ */
+
+#define IMPAIRTEST_PROTO_TCP 1
+#define IMPAIRTEST_PROTO_UDP 2
+#define IMPAIRTEST_PROTO_KCP 3
+
+enum
+{
+  RECEIVER_PORT = 30101,
+  RELAY_PORT    = 30102,
+};
+
+static const impair_profile s_profiles[] = {
+    // name, loss, burst, delay_ms, jitter_ms, reorder, rate_kbps, queue_ms
+    {"clean", 0, 0, 0, 0, 0, 0, 0},
+    {"lan", 0, 0, 1, 0, 0, 0, 0},
+    {"wifi", 0.01, 0, 10, 5, 0, 0, 0},
+    {"4g", 0.02, 0.25, 30, 10, 0.01, 20000, 200},
+    {"lossy", 0.1, 0, 50, 20, 0.05, 0, 0},
+    {"narrow", 0.005, 0, 50, 5, 0, 2000, 300},
+};
+
+struct bench_options {
+  int rate    = 1000;
+  int size    = 1000;
+  int seconds = 5;
+  int kcp_nodelay[4] = {1, 10, 2, 1};
+  int kcp_window[2]  = {32, 128};
+  int kcp_fec[2]     = {0, 0};
+  int kcp_flush[2]   = {0, 10};
+};
+
+struct bench_result {
+  long long sent     = 0;
+  long long received = 0;
+  double goodput     = 0; // Mbits/s
+  double p50 = 0, p99 = 0, p999 = 0, max = 0; // ms
+};
+
+static const char* proto_name(int proto)
+{
+  static const char* protos[] = {"null", "TCP", "UDP", "KCP"};
+  return protos[proto];
+}
+
+static bench_result run_bench(const impair_profile& profile, int proto, const bench_options& opts)
+{
+  bench_result result;
+  impair_relay relay(profile, proto == IMPAIRTEST_PROTO_TCP, RELAY_PORT, RECEIVER_PORT);
+  if (!relay.start())
+  {
+    printf("start relay failed, ec=%d\n", xxsocket::get_last_errno());
+    return result;
+  }
+
+  io_hostent eps[] = {{"127.0.0.1", RECEIVER_PORT}, {"127.0.0.1", RELAY_PORT}};
+  io_service service(eps, 2);
+  static const int kinds[][2] = {{0, 0}, {YCK_TCP_SERVER, YCK_TCP_CLIENT}, {YCK_UDP_SERVER, YCK_UDP_CLIENT}, {YCK_KCP_SERVER, YCK_KCP_CLIENT}};
+  service.set_option(YOPT_S_HRES_TIMER, 1);
+  service.set_option(YOPT_C_MOD_FLAGS, 0, YCF_REUSEADDR, 0);
+  for (int index = 0; index < 2; ++index)
+  {
+    // frame: [length:u32][seq:u32][send time:i64][padding]
+    service.set_option(YOPT_C_UNPACK_PARAMS, index, 65535, 0, 4, 0);
+#if defined(YASIO_ENABLE_KCP)
+    service.set_option(YOPT_C_KCP_CONV, index, 8633);
+    service.set_option(YOPT_C_KCP_NODELAY, index, opts.kcp_nodelay[0], opts.kcp_nodelay[1], opts.kcp_nodelay[2], opts.kcp_nodelay[3]);
+    service.set_option(YOPT_C_KCP_WINDOW_SIZE, index, opts.kcp_window[0], opts.kcp_window[1]);
+    service.set_option(YOPT_C_KCP_FEC, index, opts.kcp_fec[0], opts.kcp_fec[1]);
+    service.set_option(YOPT_C_KCP_FLUSH_POLICY, index, opts.kcp_flush[0], opts.kcp_flush[1]);
+#endif
+  }
+
+  std::mutex mtx;
+  std::vector<int> latencies; // us
+  std::atomic<long long> received_bytes{0};
+  std::atomic<transport_handle_t> sender{nullptr};
+  service.start([&](event_ptr&& ev) {
+    if (ev->kind() == YEK_ON_PACKET && ev->cindex() == 0)
+    {
+      auto& packet = ev->packet();
+      ibstream_view ibs(packet.data(), static_cast<int>(packet.size()));
+      ibs.read<uint32_t>();
+      ibs.read<uint32_t>();
+      auto latency = yasio::highp_clock() - ibs.read<int64_t>();
+      received_bytes += packet.size();
+      std::lock_guard<std::mutex> lck(mtx);
+      latencies.push_back(static_cast<int>(latency));
+    }
+    else if (ev->kind() == YEK_ON_OPEN && ev->status() == 0)
+    {
+      if (proto == IMPAIRTEST_PROTO_TCP)
+      { // measure the link instead of nagle
+        int nodelay = 1;
+        service.set_option(YOPT_B_SOCKOPT, static_cast<io_base*>(ev->transport()), IPPROTO_TCP, TCP_NODELAY, &nodelay, static_cast<int>(sizeof(nodelay)));
+      }
+      if (ev->cindex() == 1)
+        sender = ev->transport();
+    }
+  });
+  service.open(0, kinds[proto][0]);
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  service.open(1, kinds[proto][1]);
+  for (int i = 0; i < 100 && !sender; ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  if (!sender)
+  {
+    printf("%s connect failed!\n", proto_name(proto));
+    return result;
+  }
+
+  // paced by elapsed time, so a late tick catches up
+  std::vector<char> padding((std::max)(opts.size - 16, 0));
+  auto start = yasio::highp_clock();
+  auto stop  = start + opts.seconds * 1000000LL;
+  for (auto now = start; now < stop; now = yasio::highp_clock())
+  {
+    long long expected = (now - start) * opts.rate / 1000000;
+    for (; result.sent < expected; ++result.sent)
+    {
+      obstream obs(opts.size);
+      auto where = obs.push<uint32_t>();
+      obs.write(static_cast<uint32_t>(result.sent));
+      obs.write(static_cast<int64_t>(yasio::highp_clock()));
+      obs.write_bytes(padding.data(), static_cast<int>(padding.size()));
+      obs.pop<uint32_t>(where, static_cast<uint32_t>(obs.length()));
+      service.write(sender, std::move(obs.buffer()));
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(500));
+  }
+
+  // drain until nothing arrived in 500ms
+  for (long long last = -1; last != received_bytes;)
+  {
+    last = received_bytes;
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+  }
+  service.stop();
+  relay.stop();
+
+  std::sort(latencies.begin(), latencies.end());
+  result.received = static_cast<long long>(latencies.size());
+  result.goodput  = received_bytes * 8.0 / opts.seconds / 1000000;
+  if (!latencies.empty())
+  {
+    result.p50  = latencies[latencies.size() / 2] / 1000.0;
+    result.p99  = latencies[latencies.size() * 99 / 100] / 1000.0;
+    result.p999 = latencies[latencies.size() * 999 / 1000] / 1000.0;
+    result.max  = latencies.back() / 1000.0;
+  }
+  return result;
+}
+
+static bool parse_ints(const char* arg, int* values, int count)
+{
+  for (int i = 0; i < count; ++i)
+  {
+    char* end = nullptr;
+    values[i] = static_cast<int>(strtol(arg, &end, 10));
+    if (end == arg || (i + 1 < count && *end != ','))
+      return false;
+    arg = end + 1;
+  }
+  return true;
+}
+
+int main(int argc, char** argv)
+{
+  const char* profile_name = argc > 1 ? argv[1] : "all";
+  const char* proto_arg    = argc > 2 ? argv[2] : "all";
+  bench_options opts;
+  for (int i = 3; i + 1 < argc; i += 2)
+  {
+    const char* opt = argv[i];
+    const char* val = argv[i + 1];
+    bool ok         = true;
+    if (!strcmp(opt, "--rate"))
+      ok = parse_ints(val, &opts.rate, 1);
+    else if (!strcmp(opt, "--size"))
+      ok = parse_ints(val, &opts.size, 1) && opts.size >= 16;
+    else if (!strcmp(opt, "--time"))
+      ok = parse_ints(val, &opts.seconds, 1);
+    else if (!strcmp(opt, "--kcp-nodelay"))
+      ok = parse_ints(val, opts.kcp_nodelay, 4);
+    else if (!strcmp(opt, "--kcp-window"))
+      ok = parse_ints(val, opts.kcp_window, 2);
+    else if (!strcmp(opt, "--kcp-fec"))
+      ok = parse_ints(val, opts.kcp_fec, 2);
+    else if (!strcmp(opt, "--kcp-flush"))
+      ok = parse_ints(val, opts.kcp_flush, 2);
+    else
+      ok = false;
+    if (!ok)
+    {
+      printf("invalid option: %s %s\n", opt, val);
+      return 1;
+    }
+  }
+
+  std::vector<int> protos;
+  if (cxx20::ic::iequals(proto_arg, "tcp") || cxx20::ic::iequals(proto_arg, "all"))
+    protos.push_back(IMPAIRTEST_PROTO_TCP);
+  if (cxx20::ic::iequals(proto_arg, "udp") || cxx20::ic::iequals(proto_arg, "all"))
+    protos.push_back(IMPAIRTEST_PROTO_UDP);
+#if defined(YASIO_ENABLE_KCP)
+  if (cxx20::ic::iequals(proto_arg, "kcp") || cxx20::ic::iequals(proto_arg, "all"))
+    protos.push_back(IMPAIRTEST_PROTO_KCP);
+#endif
+
+  printf("profile  proto      sent  received    loss  goodput(Mbits/s)  p50(ms)  p99(ms)  p999(ms)  max(ms)\n");
+  for (auto& profile : s_profiles)
+  {
+    if (!cxx20::ic::iequals(profile_name, "all") && !cxx20::ic::iequals(profile_name, profile.name))
+      continue;
+    for (int proto : protos)
+    {
+      auto r = run_bench(profile, proto, opts);
+      printf("%-8s %-5s %9lld %9lld %6.2f%% %17.2f %8.1f %8.1f %9.1f %8.1f\n", profile.name, proto_name(proto), r.sent, r.received,
+             r.sent ? (r.sent - r.received) * 100.0 / r.sent : 0, r.goodput, r.p50, r.p99, r.p999, r.max);
+    }
+  }
+  return 0;
+}
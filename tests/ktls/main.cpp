@@ -0,0 +1,108 @@
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include "yasio/yasio.hpp"
+
+#include "sslcerts.hpp"
+
+using namespace yasio;
+
+/*
+ * Verify the kTLS transports, see: YOPT_S_SSL_KTLS
+ *   a. the kernel encrypts the records sent once handshake finished, checked by BIO_get_ktls_send,
+ *      skipped when the kernel or OpenSSL doesn't support kTLS
+ *   b. the socket BIO writes to the peer reset without SIGPIPE handler, the process must survive
+ */
+
+#if YASIO_SSL_BACKEND == 1 && defined(__linux__) && defined(SSL_OP_ENABLE_KTLS) && !defined(OPENSSL_NO_KTLS)
+enum
+{
+  KTLS_PORT   = 20235,
+  KTLS_ROUNDS = 20,
+};
+
+// the kernel tls module loaded, see: https://docs.kernel.org/networking/tls.html
+static bool kernel_tls_available()
+{
+  char ulps[256] = {0};
+  auto fp        = fopen("/proc/sys/net/ipv4/tcp_available_ulp", "r");
+  if (!fp)
+    return false;
+  bool found = fgets(ulps, sizeof(ulps), fp) && strstr(ulps, "tls");
+  fclose(fp);
+  return found;
+}
+
+static bool run_round(int& ktls_send)
+{
+  io_hostent eps[] = {{"127.0.0.1", KTLS_PORT}, {"127.0.0.1", KTLS_PORT}};
+  io_service service(eps, 2);
+  service.set_option(YOPT_S_SSL_KTLS, 1);
+  service.set_option(YOPT_S_SSL_CACERT, SSLTEST_CACERT);
+  service.set_option(YOPT_S_SSL_CERT, SSLTEST_CERT, SSLTEST_PKEY);
+  service.set_option(YOPT_C_MOD_FLAGS, 0, YCF_REUSEADDR, 0);
+
+  std::atomic<int> closed{0};
+  service.start([&](event_ptr&& ev) {
+    auto transport = ev->transport();
+    switch (ev->kind())
+    {
+      case YEK_ON_OPEN:
+        if (ev->status() != 0)
+          closed = 2;
+        else if (ev->cindex() == 1)
+        {
+          auto ssl  = static_cast<io_transport_ssl*>(transport)->get_ssl();
+          ktls_send = ssl && BIO_get_ktls_send(::SSL_get_wbio(yssl_unwrap(ssl))) ? 1 : 0;
+          // keep writing while the peer resets
+          for (int i = 0; i < 64; ++i)
+            service.write(transport, sbyte_buffer(16 * 1024, 'k'));
+        }
+        break;
+      case YEK_ON_PACKET:
+        if (ev->cindex() == 0)
+        { // reset the client without close_notify
+          service.set_option(YOPT_B_SOCKOPT, static_cast<io_base*>(transport), SOL_SOCKET, SO_LINGER, &(const linger&)linger{1, 0},
+                             (int)sizeof(linger));
+          service.close(transport);
+        }
+        break;
+      case YEK_ON_CLOSE:
+        if (ev->cindex() == 1)
+          ++closed;
+        break;
+    }
+  });
+  service.open(0, YCK_SSL_SERVER);
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  service.open(1, YCK_SSL_CLIENT);
+  for (int i = 0; i < 300 && !closed; ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  service.stop();
+  return closed == 1;
+}
+
+int main()
+{
+  int ktls_send = -1, passed = 0;
+  for (int round = 0; round < KTLS_ROUNDS; ++round)
+    passed += run_round(ktls_send);
+  bool ok = passed == KTLS_ROUNDS;
+  if (kernel_tls_available())
+  {
+    printf("ktls: BIO_get_ktls_send=%d after handshake\n", ktls_send);
+    ok = ok && ktls_send == 1;
+  }
+  else
+    printf("ktls: the kernel tls module not loaded, skip the BIO_get_ktls_send check\n");
+  printf("ktls: %d of %d rounds closed by peer reset without SIGPIPE handler\n", passed, (int)KTLS_ROUNDS);
+  printf("%s\n", ok ? "ktls test done." : "ktls test failed!");
+  return ok ? 0 : 1;
+}
+#else
+int main()
+{
+  printf("ktls test skipped, requires OpenSSL 3 with kTLS on Linux.\n");
+  return 0;
+}
+#endif
@@ -0,0 +1,155 @@
+#include <stdio.h>
+#include <atomic>
+#include <vector>
+#include "yasio/yasio.hpp"
+
+using namespace yasio;
+
+/*
+ * Verify the send queue watermarks with a raw peer which stops reading until the drain stage:
+ *   a. the idle transport always accepts a message exceeds the high watermark alone
+ *   b. the writes beyond the high watermark are rejected or drop the oldest ones by policy
+ *   c. the oversized message rejected waits the queue drained, then YEK_ON_WRITABLE fires once,
+ *      the oversized message accepted by YSQP_DROP_OLDEST is never dropped
+ */
+
+enum
+{
+  SENDQ_PORT     = 30201,
+  HIGH_BYTES     = 1 << 20,
+  LOW_BYTES      = 256 << 10,
+  SMALL_SIZE     = 64 << 10,
+  OVERSIZED_SIZE = 4 << 20,
+  SMALL_COUNT    = 128,
+};
+
+#define SENDQ_CHECK(cond)                                       \
+  do                                                            \
+  {                                                             \
+    if (!(cond))                                                \
+    {                                                           \
+      printf("sendq: %s check failed: %s\n", policy_name, #cond); \
+      ok = false;                                               \
+    }                                                           \
+  } while (false)
+
+static bool run_policy(int policy)
+{
+  const char* policy_name = policy == YSQP_REJECT ? "YSQP_REJECT" : "YSQP_DROP_OLDEST";
+  bool ok                 = true;
+
+  xxsocket listener;
+  if (!listener.open(AF_INET, SOCK_STREAM) || listener.set_optval(SOL_SOCKET, SO_REUSEADDR, 1) != 0 ||
+      listener.bind("127.0.0.1", SENDQ_PORT) != 0 || listener.listen(1) != 0)
+  {
+    printf("sendq: listen failed, ec=%d\n", xxsocket::get_last_errno());
+    return false;
+  }
+
+  io_hostent eps[] = {{"127.0.0.1", SENDQ_PORT}};
+  io_service service(eps, 1);
+  service.set_option(YOPT_C_SEND_WATERMARKS, 0, HIGH_BYTES, LOW_BYTES, 0, 0);
+  service.set_option(YOPT_C_SEND_QUEUE_POLICY, 0, policy);
+
+  std::atomic<transport_handle_t> transport{nullptr};
+  std::atomic<int> writable{0}, completed{0}, dropped{0};
+  std::atomic<long long> completed_bytes{0};
+  std::atomic<bool> oversized_done{false};
+  service.start([&](event_ptr&& ev) {
+    if (ev->kind() == YEK_ON_OPEN && ev->status() == 0)
+      transport = ev->transport();
+    else if (ev->kind() == YEK_ON_WRITABLE)
+      ++writable;
+  });
+  service.open(0, YCK_TCP_CLIENT);
+  xxsocket peer = listener.accept();
+  for (int i = 0; i < 300 && !transport; ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  if (!transport || !peer.is_open())
+  {
+    printf("sendq: %s connect failed\n", policy_name);
+    return false;
+  }
+
+  auto on_complete = [&](int ec, size_t n) {
+    if (ec == yasio::errc::send_queue_full)
+      ++dropped;
+    else if (!ec)
+    {
+      ++completed;
+      completed_bytes += static_cast<long long>(n);
+    }
+  };
+
+  // a. the idle transport accepts the oversized message
+  int n = service.write(transport, sbyte_buffer(OVERSIZED_SIZE, 'a'), on_complete);
+  SENDQ_CHECK(n == OVERSIZED_SIZE);
+
+  // b. fill the queue without reading
+  int accepted = 0, rejected = 0;
+  for (int i = 0; i < SMALL_COUNT; ++i)
+  {
+    n = service.write(transport, sbyte_buffer(SMALL_SIZE, 'b'), on_complete);
+    accepted += n > 0;
+    rejected += n == yasio::errc::send_queue_full;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  if (policy == YSQP_REJECT)
+    SENDQ_CHECK(rejected > 0 && accepted + rejected == SMALL_COUNT);
+  else
+    SENDQ_CHECK(accepted == SMALL_COUNT && dropped > 0);
+
+  // c. the oversized message into the non-empty queue
+  writable = 0;
+  n        = service.write(transport, sbyte_buffer(OVERSIZED_SIZE, 'c'), [&](int ec, size_t bytes) {
+    on_complete(ec, bytes);
+    oversized_done = !ec;
+  });
+  if (policy == YSQP_REJECT)
+    SENDQ_CHECK(n == yasio::errc::send_queue_full);
+  else
+    SENDQ_CHECK(n == OVERSIZED_SIZE);
+
+  // drain, retry the rejected oversized message once writable
+  std::vector<char> buf(1 << 20);
+  long long received = 0;
+  bool retried       = false;
+  peer.set_nonblocking(true);
+  for (auto start = highp_clock(); highp_clock() - start < 5000000;)
+  {
+    int ret;
+    while ((ret = peer.recv(buf.data(), static_cast<int>(buf.size()))) > 0)
+      received += ret;
+    if (policy == YSQP_REJECT && writable > 0 && !retried)
+    {
+      retried = true;
+      n       = service.write(transport, sbyte_buffer(OVERSIZED_SIZE, 'c'), [&](int ec, size_t bytes) {
+        on_complete(ec, bytes);
+        oversized_done = !ec;
+      });
+      SENDQ_CHECK(n == OVERSIZED_SIZE);
+    }
+    if (oversized_done && received == completed_bytes)
+      break;
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  }
+  SENDQ_CHECK(oversized_done);
+  SENDQ_CHECK(received == completed_bytes);
+  if (policy == YSQP_REJECT)
+    SENDQ_CHECK(writable == 1); // fires once the queue drained, not at each pass below the low watermarks
+  else
+    SENDQ_CHECK(writable >= 1);
+
+  printf("sendq    %-16s accepted=%d rejected=%d dropped=%d completed=%d writable=%d received=%lld\n", policy_name, accepted, rejected,
+         static_cast<int>(dropped), static_cast<int>(completed), static_cast<int>(writable), received);
+  service.stop();
+  return ok;
+}
+
+int main()
+{
+  bool ok = run_policy(YSQP_REJECT);
+  ok      = run_policy(YSQP_DROP_OLDEST) && ok;
+  printf("%s\n", ok ? "sendq test done." : "sendq test failed!");
+  return ok ? 0 : 1;
+}
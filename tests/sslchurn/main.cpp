@@ -0,0 +1,115 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <atomic>
+#include <vector>
+
+#include "yasio/yasio.hpp"
+#if YASIO_SSL_BACKEND == 1
+#  include <openssl/crypto.h>
+#endif
+
+#include "sslcerts.hpp"
+
+using namespace yasio;
+
+/*
+ * TLS connect/disconnect churn: the clients close at open and reconnect at close, the local server
+ * accepts, so each round trip of connection creates and frees one ssl object of both roles.
+ * Compare the connection rate and the OpenSSL allocations of each connection with ssl object pool
+ * and buffer policy.
+ *
+ * usage: sslchurntest [clients(32)] [seconds(3)]
+ */
+
+enum
+{
+  SSLCHURN_PORT = 20233,
+};
+
+#if YASIO_SSL_BACKEND == 1
+static std::atomic<long long> s_ssl_allocs{0};
+static void* churn_malloc(size_t size, const char*, int)
+{
+  ++s_ssl_allocs;
+  return malloc(size);
+}
+static void* churn_realloc(void* ptr, size_t size, const char*, int)
+{
+  ++s_ssl_allocs;
+  return realloc(ptr, size);
+}
+static void churn_free(void* ptr, const char*, int) { free(ptr); }
+#endif
+
+struct churn_result {
+  long long connections = 0;
+  long long allocs      = 0;
+};
+
+static churn_result run_churn(int clients, int seconds, int pool_size, int release_buffers)
+{
+  std::vector<io_hostent> eps(clients + 1, io_hostent{"127.0.0.1", SSLCHURN_PORT});
+  io_service service(eps.data(), static_cast<int>(eps.size()));
+  service.set_option(YOPT_S_SSL_CERT, SSLTEST_CERT, SSLTEST_PKEY);
+  service.set_option(YOPT_S_SSL_SESSION_CACHE, 0, 0); // full handshakes, the session cache not measured
+  service.set_option(YOPT_S_SSL_POOL, pool_size, release_buffers);
+  service.set_option(YOPT_C_MOD_FLAGS, 0, YCF_REUSEADDR, 0);
+
+  std::atomic<long long> connections{0};
+  std::atomic<bool> stopping{false};
+  service.start([&](event_ptr&& ev) {
+    if (ev->cindex() == 0)
+      return;
+    if (ev->kind() == YEK_ON_OPEN && ev->status() == 0)
+    {
+      ++connections;
+      service.close(ev->transport());
+    }
+    else if (!stopping && (ev->kind() == YEK_ON_CLOSE || ev->kind() == YEK_ON_OPEN))
+      service.open(ev->cindex(), YCK_SSL_CLIENT);
+  });
+  service.open(0, YCK_SSL_SERVER);
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  for (int i = 1; i <= clients; ++i)
+    service.open(i, YCK_SSL_CLIENT);
+
+  // warm up the pools before measuring
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+  churn_result result;
+#if YASIO_SSL_BACKEND == 1
+  auto allocs = s_ssl_allocs.load();
+#endif
+  auto start = connections.load();
+  std::this_thread::sleep_for(std::chrono::seconds(seconds));
+  result.connections = connections - start;
+#if YASIO_SSL_BACKEND == 1
+  result.allocs = s_ssl_allocs - allocs;
+#endif
+  stopping = true;
+  service.stop();
+  return result;
+}
+
+int main(int argc, char** argv)
+{
+#if YASIO_SSL_BACKEND == 1
+  CRYPTO_set_mem_functions(churn_malloc, churn_realloc, churn_free);
+#endif
+  int clients = argc > 1 ? atoi(argv[1]) : 32;
+  int seconds = argc > 2 ? atoi(argv[2]) : 3;
+  if (clients <= 0 || seconds <= 0)
+  {
+    printf("usage: sslchurntest [clients(32)] [seconds(3)]\n");
+    return 1;
+  }
+
+  static const int configs[][2] = {{0, 1}, {128, 1}, {0, 0}, {128, 0}}; // pool_size, release_buffers
+  printf("pool  release_buffers  connections/s  allocs/connection\n");
+  for (auto& config : configs)
+  {
+    auto r = run_churn(clients, seconds, config[0], config[1]);
+    printf("%4d  %15d  %13.1f  %17.1f\n", config[0], config[1], static_cast<double>(r.connections) / seconds,
+           r.connections ? static_cast<double>(r.allocs) / r.connections : 0.0);
+  }
+  return 0;
+}
@@ -0,0 +1,180 @@
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <thread>
+#include "yasio/yasio.hpp"
+#include "yasio_ws/WebSocket.h"
+
+using namespace yasio;
+using namespace yasio_ext::network;
+
+static void test_mask()
+{
+  // the vectorized mask must match the bytewise one for any length & offset
+  char mask[4] = {0x12, 0x34, 0x56, 0x78};
+  char src[67], dst[67], expect[67];
+  for (int i = 0; i < (int)sizeof(src); ++i)
+    src[i] = (char)(i * 7);
+  for (uint8_t offset = 0; offset < 4; ++offset)
+  {
+    for (size_t len = 0; len <= sizeof(src); ++len)
+    {
+      for (size_t i = 0; i < len; ++i)
+        expect[i] = src[i] ^ mask[(i + offset) % 4];
+      auto next = WebSocket::applyMask(dst, src, len, mask, offset);
+      if (memcmp(dst, expect, len) != 0 || next != (offset + len) % 4)
+      {
+        printf("applyMask mismatch, len=%d, offset=%d\n", (int)len, (int)offset);
+        exit(1);
+      }
+    }
+  }
+  // the sample of rfc6455 section-1.3
+  if (WebSocket::computeAccept("dGhlIHNhbXBsZSBub25jZQ==") != "s3pPLMBiTxaQ9kYGzzhZRbK+xOo=")
+  {
+    printf("computeAccept mismatch\n");
+    exit(1);
+  }
+}
+
+/*
+ * The close handshake against a raw peer:
+ *   RAW_ECHO: the peer echo the close frame, the client must not send a second one
+ *   RAW_SILENT: the peer never answer, the close timeout closes the transport
+ *   RAW_RESERVED: the peer send the reserved control opcode 0xB, the client fails with 1002
+ */
+enum
+{
+  RAW_ECHO,
+  RAW_SILENT,
+  RAW_RESERVED,
+};
+
+static bool test_raw_peer(int mode)
+{
+  const u_short port = 18090;
+  xxsocket listener;
+  if (!listener.open(AF_INET, SOCK_STREAM) || listener.set_optval(SOL_SOCKET, SO_REUSEADDR, 1) != 0 ||
+      listener.bind("127.0.0.1", port) != 0 || listener.listen(1) != 0)
+  {
+    printf("raw peer: listen failed, ec=%d\n", xxsocket::get_last_errno());
+    return false;
+  }
+
+  std::atomic<int> status{-1};
+  WebSocket ws(1);
+  ws.setCloseTimeout(300);
+  ws.setOnOpen([&](io_transport* transport) {
+    if (mode != RAW_RESERVED)
+      ws.close(transport);
+  });
+  ws.setOnClose([&](int, io_transport*, int st) { status = st; });
+  ws.open(0, "ws://127.0.0.1:18090/");
+
+  xxsocket peer = listener.accept();
+  peer.set_optval(SOL_SOCKET, SO_RCVTIMEO, timeval{3, 0});
+  std::string request;
+  char buf[1024];
+  int n;
+  while (request.find("\r\n\r\n") == std::string::npos && (n = peer.recv(buf, sizeof(buf))) > 0)
+    request.append(buf, n);
+  auto pos = request.find("Sec-WebSocket-Key: ");
+  if (pos == std::string::npos)
+  {
+    printf("raw peer: bad request\n");
+    return false;
+  }
+  pos += 19;
+  std::string response = "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Accept: ";
+  response += WebSocket::computeAccept(cxx17::string_view{request}.substr(pos, request.find("\r\n", pos) - pos));
+  response += "\r\n\r\n";
+  peer.send(response.data(), static_cast<int>(response.size()));
+  if (mode == RAW_RESERVED)
+    peer.send("\x8b\x00", 2);
+
+  // the masked close frame with status code only: 2 bytes header, 4 bytes mask, 2 bytes status
+  std::string frames;
+  auto start = highp_clock();
+  while ((n = peer.recv(buf, sizeof(buf))) > 0)
+  {
+    frames.append(buf, n);
+    if (mode == RAW_ECHO && frames.size() == 8)
+      peer.send("\x88\x02\x03\xe8", 4);
+  }
+  auto elapsed = (highp_clock() - start) / 1000;
+  for (int i = 0; i < 100 && status < 0; ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+  bool ok = frames.size() == 8 && static_cast<uint8_t>(frames[0]) == 0x88;
+  if (mode == RAW_ECHO)
+    ok = ok && status == 1000 && elapsed < 300;
+  else if (mode == RAW_SILENT)
+    ok = ok && status == 1000 && elapsed >= 200;
+  else
+    ok = ok && status == 1002;
+  printf("raw peer mode=%d: frames=%d bytes, status=%d, elapsed=%dms, %s\n", mode, (int)frames.size(), status.load(), (int)elapsed,
+         ok ? "ok" : "failed");
+  return ok;
+}
+
+int main(int, char**)
+{
+  test_mask();
+  if (!test_raw_peer(RAW_ECHO) || !test_raw_peer(RAW_SILENT) || !test_raw_peer(RAW_RESERVED))
+    return 1;
+
+  std::atomic<int> received{0};
+  std::atomic<bool> done{false};
+  std::atomic<bool> lateSendRejected{false};
+  std::string big(100 * 1024, 'x');
+  for (size_t i = 0; i < big.size(); ++i)
+    big[i] = (char)(i % 251);
+
+  WebSocket ws(2);
+  ws.setFragmentSize(16 * 1024);
+  ws.setOnOpen([&](io_transport* transport) {
+    if (transport->cindex() == 1)
+    {
+      printf("client upgraded, sending...\n");
+      ws.sendText(transport, "hello websocket");
+      ws.ping(transport, "ping");
+      ws.send(transport, big.data(), big.size());
+    }
+  });
+  ws.setOnMessage([&](io_transport* transport, int opcode, cxx17::string_view data) {
+    if (transport->cindex() == 0)
+    { // server, echo
+      ws.send(transport, data.data(), data.size(), opcode);
+      return;
+    }
+    ++received;
+    if (opcode == WebSocket::OP_TEXT)
+      printf("client received text: %s\n", std::string(data.data(), data.size()).c_str());
+    else if (opcode == WebSocket::OP_PONG)
+      printf("client received pong: %s\n", std::string(data.data(), data.size()).c_str());
+    else if (opcode == WebSocket::OP_BINARY)
+    {
+      printf("client received binary: %d bytes, %s\n", (int)data.size(), data == cxx17::string_view(big) ? "ok" : "mismatch");
+      ws.close(transport);
+    }
+  });
+  ws.setOnClose([&](int index, io_transport* transport, int status) {
+    printf("transport closed, index=%d, status=%d\n", index, status);
+    if (transport && index == 1)
+    {
+      lateSendRejected = ws.sendText(transport, "late") < 0;
+      done             = true;
+    }
+  });
+
+  ws.listen(0, "127.0.0.1", 18089);
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  ws.open(1, "ws://127.0.0.1:18089/echo");
+
+  for (int i = 0; i < 100 && !done; ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+  bool ok = done && received == 3 && lateSendRejected;
+  printf("wstest %s\n", ok ? "passed" : "failed");
+  return ok ? 0 : 1;
+}
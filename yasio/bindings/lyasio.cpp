@@ -105,7 +105,14 @@ static void register_obstream(sol::table& lib, const char* usertype)
       sol::overload(static_cast<void (_Stream ::*)(size_t)>(&_Stream::template pop<uint8_t>),
                     static_cast<void (_Stream ::*)(size_t, uint8_t)>(&_Stream::template pop<uint8_t>)),
 #  endif
-      "write_ix", &_Stream::template write_ix<int64_t>, "write_bool", &_Stream::template write<bool>, "write_i8", &_Stream::template write<int8_t>, "write_i16",
+      "write_ix", &_Stream::template write_ix<int64_t>, "write_vbyte_array",
+      [](_Stream* obs, sol::table values) {
+        std::vector<uint32_t> arr(values.size());
+        for (size_t i = 0; i < arr.size(); ++i)
+          arr[i] = values.get<uint32_t>(i + 1);
+        obs->write_vbyte_array(arr);
+      },
+      "write_bool", &_Stream::template write<bool>, "write_i8", &_Stream::template write<int8_t>, "write_i16",
       &_Stream::template write<int16_t>, "write_i32", &_Stream::template write<int32_t>, "write_i64", &_Stream::template write<int64_t>, "write_u8",
       &_Stream::template write<uint8_t>, "write_u16", &_Stream::template write<uint16_t>, "write_u32", &_Stream::template write<uint32_t>, "write_u64",
       &_Stream::template write<uint64_t>,
@@ -128,7 +135,13 @@ static void register_ibstream(sol::table& lib, const char* usertype)
 {
   lib.new_usertype<_Stream>(
       usertype, sol::constructors<_Stream(), _Stream(yasio::sbyte_buffer), _Stream(const _OStream*)>(), "load", &_Stream::load, "read_ix",
-      &_Stream::template read_ix<int64_t>, "read_bool", &_Stream::template read<bool>, "read_i8", &_Stream::template read<int8_t>, "read_i16",
+      &_Stream::template read_ix<int64_t>, "read_vbyte_array",
+      [](_Stream* ibs, int count) {
+        std::vector<uint32_t> arr;
+        ibs->read_vbyte_array(arr, static_cast<size_t>(count));
+        return sol::as_table(std::move(arr));
+      },
+      "read_bool", &_Stream::template read<bool>, "read_i8", &_Stream::template read<int8_t>, "read_i16",
       &_Stream::template read<int16_t>, "read_i32", &_Stream::template read<int32_t>, "read_i64", &_Stream::template read<int64_t>, "read_u8",
       &_Stream::template read<uint8_t>, "read_u16", &_Stream::template read<uint16_t>, "read_u32", &_Stream::template read<uint32_t>, "read_u64",
       &_Stream::template read<uint64_t>,
@@ -222,6 +235,9 @@ YASIO_LUA_API int luaopen_yasio(lua_State* L)
           case YOPT_C_REMOTE_PORT:
           case YOPT_C_KCP_CONV:
           case YOPT_C_UNPACK_NO_BSWAP:
+          case YOPT_C_SEND_QUEUE_POLICY:
+          case YOPT_S_SSL_SESSION_CACHE:
+          case YOPT_S_SSL_POOL:
             service->set_option(opt, static_cast<int>(args[0]), static_cast<int>(args[1]));
             break;
           case YOPT_C_ENABLE_MCAST:
@@ -230,12 +246,16 @@ YASIO_LUA_API int luaopen_yasio(lua_State* L)
             service->set_option(opt, static_cast<int>(args[0]), args[1].as<const char*>(), static_cast<int>(args[2]));
             break;
           case YOPT_C_MOD_FLAGS:
+          case YOPT_C_KCP_FLUSH_POLICY:
+          case YOPT_C_KCP_FEC:
             service->set_option(opt, static_cast<int>(args[0]), static_cast<int>(args[1]), static_cast<int>(args[2]));
             break;
           case YOPT_S_TCP_KEEPALIVE:
+          case YOPT_S_EVENT_QUEUE_LIMITS:
             service->set_option(opt, static_cast<int>(args[0]), static_cast<int>(args[1]), static_cast<int>(args[2]));
             break;
           case YOPT_C_UNPACK_PARAMS:
+          case YOPT_C_SEND_WATERMARKS:
             service->set_option(opt, static_cast<int>(args[0]), static_cast<int>(args[1]), static_cast<int>(args[2]), static_cast<int>(args[3]),
                                 static_cast<int>(args[4]));
             break;
@@ -251,7 +271,7 @@ YASIO_LUA_API int luaopen_yasio(lua_State* L)
             service->set_option(opt, static_cast<int>(args[0]));
         }
       },
-      "dispatch", &io_service::dispatch, "open", &io_service::open, "is_open",
+      "dispatch", &io_service::dispatch, "poll", &io_service::poll, "open", &io_service::open, "is_open",
       sol::overload(static_cast<bool (io_service::*)(int) const>(&io_service::is_open),
                     static_cast<bool (io_service::*)(transport_handle_t) const>(&io_service::is_open)),
       "close",
@@ -315,8 +335,14 @@ YASIO_LUA_API int luaopen_yasio(lua_State* L)
   YASIO_EXPORT_ANY(YOPT_S_DNS_CACHE_TIMEOUT);
   YASIO_EXPORT_ANY(YOPT_S_DNS_QUERIES_TIMEOUT);
   YASIO_EXPORT_ANY(YOPT_S_TCP_KEEPALIVE);
+  YASIO_EXPORT_ANY(YOPT_S_TCP_ZEROCOPY);
   YASIO_EXPORT_ANY(YOPT_S_EVENT_CB);
   YASIO_EXPORT_ANY(YOPT_C_UNPACK_PARAMS);
+  YASIO_EXPORT_ANY(YOPT_C_SEND_WATERMARKS);
+  YASIO_EXPORT_ANY(YOPT_C_SEND_QUEUE_POLICY);
+  YASIO_EXPORT_ANY(YOPT_S_EVENT_QUEUE_LIMITS);
+  YASIO_EXPORT_ANY(YSQP_REJECT);
+  YASIO_EXPORT_ANY(YSQP_DROP_OLDEST);
   YASIO_EXPORT_ANY(YOPT_C_UNPACK_STRIP);
   YASIO_EXPORT_ANY(YOPT_C_UNPACK_NO_BSWAP);
   YASIO_EXPORT_ANY(YOPT_C_LFBFD_PARAMS); // alias for YOPT_C_UNPACK_PARAMS
@@ -334,6 +360,15 @@ YASIO_LUA_API int luaopen_yasio(lua_State* L)
   YASIO_EXPORT_ANY(YOPT_C_KCP_WINDOW_SIZE);
   YASIO_EXPORT_ANY(YOPT_C_KCP_MTU);
   YASIO_EXPORT_ANY(YOPT_C_KCP_RTO_MIN);
+  YASIO_EXPORT_ANY(YOPT_C_KCP_FLUSH_POLICY);
+  YASIO_EXPORT_ANY(YOPT_C_KCP_FEC);
+  YASIO_EXPORT_ANY(YOPT_S_SSL_SESSION_CACHE);
+  YASIO_EXPORT_ANY(YOPT_S_SSL_KTLS);
+  YASIO_EXPORT_ANY(YOPT_S_SSL_HANDSHAKE_WORKERS);
+  YASIO_EXPORT_ANY(YOPT_S_SSL_POOL);
+  YASIO_EXPORT_ANY(YKFP_IMMEDIATE);
+  YASIO_EXPORT_ANY(YKFP_END_OF_LOOP);
+  YASIO_EXPORT_ANY(YKFP_DEADLINE);
 #  endif
   YASIO_EXPORT_ANY(YOPT_C_MOD_FLAGS);
 
@@ -343,6 +378,7 @@ YASIO_LUA_API int luaopen_yasio(lua_State* L)
   YASIO_EXPORT_ANY(YEK_ON_OPEN);
   YASIO_EXPORT_ANY(YEK_ON_CLOSE);
   YASIO_EXPORT_ANY(YEK_ON_PACKET);
+  YASIO_EXPORT_ANY(YEK_ON_WRITABLE);
   YASIO_EXPORT_ANY(YEK_CONNECT_RESPONSE);
   YASIO_EXPORT_ANY(YEK_CONNECTION_LOST);
   YASIO_EXPORT_ANY(YEK_PACKET);
@@ -512,6 +548,7 @@ static void register_obstream(kaguya::LuaTable& lib, const char* usertype, const
                                   static_cast<void (_BaseStream ::*)(size_t, uint8_t)>(&_BaseStream::template pop<uint8_t>))
 #  endif
           .addFunction("write_ix", &_BaseStream::template write_ix<int64_t>)
+          .addStaticFunction("write_vbyte_array", [](_BaseStream* obs, const std::vector<uint32_t>& values) { obs->write_vbyte_array(values); })
           .addFunction("write_bool", &_BaseStream::template write<bool>)
           .addFunction("write_i8", &_BaseStream::template write<int8_t>)
           .addFunction("write_i16", &_BaseStream::template write<int16_t>)
@@ -544,6 +581,12 @@ static void register_ibstream(kaguya::LuaTable& lib, const char* usertype, const
                               kaguya::UserdataMetatable<_StreamView>& baseclass)
 {
   lib[basetype].setClass(baseclass.addFunction("read_ix", &_StreamView::template read_ix<int64_t>)
+                             .addStaticFunction("read_vbyte_array",
+                                                [](_StreamView* ibs, int count) {
+                                                  std::vector<uint32_t> values;
+                                                  ibs->read_vbyte_array(values, static_cast<size_t>(count));
+                                                  return values;
+                                                })
                              .addFunction("read_bool", &_StreamView::template read<bool>)
                              .addFunction("read_i8", &_StreamView::template read<int8_t>)
                              .addFunction("read_i16", &_StreamView::template read<int16_t>)
@@ -645,6 +688,7 @@ end
                              })
           .addFunction("stop", &io_service::stop)
           .addFunction("dispatch", &io_service::dispatch)
+          .addFunction("poll", &io_service::poll)
           .addFunction("open", &io_service::open)
           .addOverloadedFunctions("is_open", static_cast<bool (io_service::*)(int) const>(&io_service::is_open),
                                   static_cast<bool (io_service::*)(transport_handle_t) const>(&io_service::is_open))
@@ -678,6 +722,7 @@ end
                                  case YOPT_C_REMOTE_PORT:
                                  case YOPT_C_KCP_CONV:
                                  case YOPT_C_UNPACK_NO_BSWAP:
+                                 case YOPT_C_SEND_QUEUE_POLICY:
                                    service->set_option(opt, static_cast<int>(args[0]), static_cast<int>(args[1]));
                                    break;
                                  case YOPT_C_ENABLE_MCAST:
@@ -689,9 +734,11 @@ end
                                    service->set_option(opt, static_cast<int>(args[0]), static_cast<int>(args[1]), static_cast<int>(args[2]));
                                    break;
                                  case YOPT_S_TCP_KEEPALIVE:
+                                 case YOPT_S_EVENT_QUEUE_LIMITS:
                                    service->set_option(opt, static_cast<int>(args[0]), static_cast<int>(args[1]), static_cast<int>(args[2]));
                                    break;
                                  case YOPT_C_UNPACK_PARAMS:
+                                 case YOPT_C_SEND_WATERMARKS:
                                    service->set_option(opt, static_cast<int>(args[0]), static_cast<int>(args[1]), static_cast<int>(args[2]),
                                                        static_cast<int>(args[3]), static_cast<int>(args[4]));
                                    break;
@@ -758,8 +805,14 @@ end
   YASIO_EXPORT_ANY(YOPT_S_DNS_CACHE_TIMEOUT);
   YASIO_EXPORT_ANY(YOPT_S_DNS_QUERIES_TIMEOUT);
   YASIO_EXPORT_ANY(YOPT_S_TCP_KEEPALIVE);
+  YASIO_EXPORT_ANY(YOPT_S_TCP_ZEROCOPY);
   YASIO_EXPORT_ANY(YOPT_S_EVENT_CB);
   YASIO_EXPORT_ANY(YOPT_C_UNPACK_PARAMS);
+  YASIO_EXPORT_ANY(YOPT_C_SEND_WATERMARKS);
+  YASIO_EXPORT_ANY(YOPT_C_SEND_QUEUE_POLICY);
+  YASIO_EXPORT_ANY(YOPT_S_EVENT_QUEUE_LIMITS);
+  YASIO_EXPORT_ANY(YSQP_REJECT);
+  YASIO_EXPORT_ANY(YSQP_DROP_OLDEST);
   YASIO_EXPORT_ANY(YOPT_C_UNPACK_STRIP);
   YASIO_EXPORT_ANY(YOPT_C_UNPACK_NO_BSWAP);
   YASIO_EXPORT_ANY(YOPT_C_LFBFD_PARAMS); // alias for YOPT_C_UNPACK_PARAMS
@@ -780,6 +833,7 @@ end
   YASIO_EXPORT_ANY(YEK_ON_OPEN);
   YASIO_EXPORT_ANY(YEK_ON_CLOSE);
   YASIO_EXPORT_ANY(YEK_ON_PACKET);
+  YASIO_EXPORT_ANY(YEK_ON_WRITABLE);
   YASIO_EXPORT_ANY(YEK_CONNECT_RESPONSE);
   YASIO_EXPORT_ANY(YEK_CONNECTION_LOST);
   YASIO_EXPORT_ANY(YEK_PACKET);
@@ -1676,9 +1676,11 @@ bool js_yasio_io_service_set_option(JSContext* ctx, uint32_t argc, jsval* vp)
           service->set_option(opt, args[1].toInt32(), args[2].toInt32(), args[3].toInt32());
           break;
         case YOPT_S_TCP_KEEPALIVE:
+        case YOPT_S_EVENT_QUEUE_LIMITS:
           service->set_option(opt, args[1].toInt32(), args[2].toInt32(), args[3].toInt32());
           break;
         case YOPT_C_UNPACK_PARAMS:
+        case YOPT_C_SEND_WATERMARKS:
           service->set_option(opt, args[1].toInt32(), args[2].toInt32(), args[3].toInt32(), args[4].toInt32(), args[5].toInt32());
           break;
         case YOPT_S_EVENT_CB: {
@@ -1698,11 +1700,16 @@ bool js_yasio_io_service_set_option(JSContext* ctx, uint32_t argc, jsval* vp)
           break;
         }
         case YOPT_C_KCP_CONV:
+        case YOPT_C_SEND_QUEUE_POLICY:
         case YOPT_C_KCP_MTU:
         case YOPT_C_KCP_RTO_MIN:
+        case YOPT_S_SSL_SESSION_CACHE:
+        case YOPT_S_SSL_POOL:
           service->set_option(opt, args[1].toInt32(), args[2].toInt32());
           break;
         case YOPT_C_KCP_WINDOW_SIZE:
+        case YOPT_C_KCP_FLUSH_POLICY:
+        case YOPT_C_KCP_FEC:
           service->set_option(opt, args[1].toInt32(), args[2].toInt32(), args[3].toInt32());
           break;
         case YOPT_C_KCP_NODELAY:
@@ -1904,8 +1911,14 @@ void jsb_register_yasio(JSContext* ctx, JS::HandleObject global)
   YASIO_EXPORT_ENUM(YOPT_S_DNS_CACHE_TIMEOUT);
   YASIO_EXPORT_ENUM(YOPT_S_DNS_QUERIES_TIMEOUT);
   YASIO_EXPORT_ENUM(YOPT_S_TCP_KEEPALIVE);
+  YASIO_EXPORT_ENUM(YOPT_S_TCP_ZEROCOPY);
   YASIO_EXPORT_ENUM(YOPT_S_EVENT_CB);
   YASIO_EXPORT_ENUM(YOPT_C_UNPACK_PARAMS);
+  YASIO_EXPORT_ENUM(YOPT_C_SEND_WATERMARKS);
+  YASIO_EXPORT_ENUM(YOPT_C_SEND_QUEUE_POLICY);
+  YASIO_EXPORT_ENUM(YOPT_S_EVENT_QUEUE_LIMITS);
+  YASIO_EXPORT_ENUM(YSQP_REJECT);
+  YASIO_EXPORT_ENUM(YSQP_DROP_OLDEST);
   YASIO_EXPORT_ENUM(YOPT_C_LFBFD_PARAMS); // alias for YOPT_C_UNPACK_PARAMS
   YASIO_EXPORT_ENUM(YOPT_C_LOCAL_HOST);
   YASIO_EXPORT_ENUM(YOPT_C_LOCAL_PORT);
@@ -1921,6 +1934,15 @@ void jsb_register_yasio(JSContext* ctx, JS::HandleObject global)
   YASIO_EXPORT_ENUM(YOPT_C_KCP_WINDOW_SIZE);
   YASIO_EXPORT_ENUM(YOPT_C_KCP_MTU);
   YASIO_EXPORT_ENUM(YOPT_C_KCP_RTO_MIN);
+  YASIO_EXPORT_ENUM(YOPT_C_KCP_FLUSH_POLICY);
+  YASIO_EXPORT_ENUM(YOPT_C_KCP_FEC);
+  YASIO_EXPORT_ENUM(YOPT_S_SSL_SESSION_CACHE);
+  YASIO_EXPORT_ENUM(YOPT_S_SSL_KTLS);
+  YASIO_EXPORT_ENUM(YOPT_S_SSL_HANDSHAKE_WORKERS);
+  YASIO_EXPORT_ENUM(YOPT_S_SSL_POOL);
+  YASIO_EXPORT_ENUM(YKFP_IMMEDIATE);
+  YASIO_EXPORT_ENUM(YKFP_END_OF_LOOP);
+  YASIO_EXPORT_ENUM(YKFP_DEADLINE);
 #endif
   YASIO_EXPORT_ENUM(YOPT_C_MOD_FLAGS);
 
@@ -1930,6 +1952,7 @@ void jsb_register_yasio(JSContext* ctx, JS::HandleObject global)
   YASIO_EXPORT_ENUM(YEK_CONNECT_RESPONSE);
   YASIO_EXPORT_ENUM(YEK_CONNECTION_LOST);
   YASIO_EXPORT_ENUM(YEK_PACKET);
+  YASIO_EXPORT_ENUM(YEK_ON_WRITABLE);
 
   YASIO_EXPORT_ENUM(SEEK_CUR);
   YASIO_EXPORT_ENUM(SEEK_SET);
@@ -147,6 +147,9 @@ YASIO_NI_API void yasio_set_option(void* service_ptr, int opt, const char* pszAr
     case YOPT_S_DNS_CACHE_TIMEOUT:
     case YOPT_S_DNS_QUERIES_TIMEOUT:
     case YOPT_S_DNS_DIRTY:
+    case YOPT_S_TCP_ZEROCOPY:
+    case YOPT_S_SSL_KTLS:
+    case YOPT_S_SSL_HANDSHAKE_WORKERS:
     case YOPT_C_DISABLE_MCAST:
       service->set_option(opt, atoi(pszArgs));
       return;
@@ -188,20 +191,27 @@ YASIO_NI_API void yasio_set_option(void* service_ptr, int opt, const char* pszAr
       service->set_option(opt, svtoi(args[0]), svtoa(args[1]), svtoi(args[2]));
       break;
     case YOPT_C_MOD_FLAGS:
+    case YOPT_S_EVENT_QUEUE_LIMITS:
       service->set_option(opt, svtoi(args[0]), svtoi(args[1]), svtoi(args[2]));
       break;
     case YOPT_S_TCP_KEEPALIVE:
       service->set_option(opt, svtoi(args[0]), svtoi(args[1]), svtoi(args[2]), svtoi(args[3]));
       break;
     case YOPT_C_UNPACK_PARAMS:
+    case YOPT_C_SEND_WATERMARKS:
       service->set_option(opt, svtoi(args[0]), svtoi(args[1]), svtoi(args[2]), svtoi(args[3]), svtoi(args[4]));
       break;
     case YOPT_C_KCP_CONV:
+    case YOPT_C_SEND_QUEUE_POLICY:
     case YOPT_C_KCP_MTU:
     case YOPT_C_KCP_RTO_MIN:
+    case YOPT_S_SSL_SESSION_CACHE:
+    case YOPT_S_SSL_POOL:
       service->set_option(opt, svtoi(args[0]), svtoi(args[1]));
       break;
     case YOPT_C_KCP_WINDOW_SIZE:
+    case YOPT_C_KCP_FLUSH_POLICY:
+    case YOPT_C_KCP_FEC:
       service->set_option(opt, svtoi(args[0]), svtoi(args[1]), svtoi(args[2]));
       break;
     case YOPT_C_KCP_NODELAY:
@@ -271,6 +281,16 @@ YASIO_NI_API void yasio_dispatch(void* service_ptr, int count)
   if (service)
     service->dispatch(count);
 }
+YASIO_NI_API int yasio_poll(void* service_ptr, long long timeout_us)
+{
+  auto service = reinterpret_cast<io_service*>(service_ptr);
+  return service && service->poll(timeout_us) ? 1 : 0;
+}
+YASIO_NI_API int yasio_pollable_fd(void* service_ptr)
+{
+  auto service = reinterpret_cast<io_service*>(service_ptr);
+  return service ? service->pollable_fd() : -1;
+}
 YASIO_NI_API long long yasio_bytes_transferred(void* service_ptr, int cindex)
 {
   auto service = reinterpret_cast<io_service*>(service_ptr);
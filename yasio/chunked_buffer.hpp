@@ -0,0 +1,220 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// A multi-platform support c++11 library with focus on asynchronous socket I/O for any
+// client application.
+//////////////////////////////////////////////////////////////////////////////////////////
+/*
+The MIT License (MIT)
+
+Copyright (c) 2012-2024 HALX99
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef YASIO__CHUNKED_BUFFER_HPP
+#define YASIO__CHUNKED_BUFFER_HPP
+#include <string.h>
+#include <algorithm>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+#include "yasio/compiler/feature_test.hpp"
+#include "yasio/byte_buffer.hpp"
+#include "yasio/impl/object_pool.hpp"
+
+namespace yasio
+{
+/*
+** The thread safe pool of fixed size chunks, chunks are allocated by user thread
+** and returned at network thread after sent.
+*/
+class chunk_pool {
+public:
+  enum : size_t
+  {
+    default_chunk_size = 16384
+  };
+  explicit chunk_pool(size_t chunk_size = default_chunk_size, size_t chunks_per_slab = 16)
+      : chunk_size_(chunk_size), pool_(chunk_size, chunks_per_slab, std::false_type{})
+  {}
+
+  size_t chunk_size() const { return chunk_size_; }
+
+  char* allocate()
+  {
+    std::lock_guard<std::mutex> lck(mtx_);
+    return static_cast<char*>(pool_.get());
+  }
+  void deallocate(char* chunk)
+  {
+    std::lock_guard<std::mutex> lck(mtx_);
+    pool_.release(chunk);
+  }
+
+  static chunk_pool& get_default()
+  {
+    static chunk_pool s_default_pool;
+    return s_default_pool;
+  }
+
+private:
+  const size_t chunk_size_;
+  std::mutex mtx_;
+  detail::object_pool pool_;
+};
+
+/*
+** The buffer made of pooled fixed size chunks, grows without reallocate & copy, and
+** can be sent as a gather write by io_service::write.
+** All chunks except the last one are always full.
+*/
+class chunked_buffer {
+public:
+  struct chunk {
+    char* data;
+    size_t size; // bytes used
+  };
+
+  using implementation_type = chunked_buffer;
+  implementation_type& get_implementation() { return *this; }
+  const implementation_type& get_implementation() const { return *this; }
+
+  explicit chunked_buffer(chunk_pool* pool = &chunk_pool::get_default()) : pool_(pool) {}
+  chunked_buffer(const chunked_buffer&) = delete;
+  chunked_buffer(chunked_buffer&& rhs) YASIO__NOEXCEPT : pool_(rhs.pool_), chunks_(std::move(rhs.chunks_)), size_(rhs.size_)
+  {
+    rhs.chunks_.clear();
+    rhs.size_ = 0;
+  }
+  ~chunked_buffer() { clear(); }
+
+  chunked_buffer& operator=(const chunked_buffer&) = delete;
+  chunked_buffer& operator=(chunked_buffer&& rhs) YASIO__NOEXCEPT
+  {
+    if (this != &rhs)
+    {
+      clear();
+      pool_   = rhs.pool_;
+      chunks_ = std::move(rhs.chunks_);
+      size_   = rhs.size_;
+      rhs.chunks_.clear();
+      rhs.size_ = 0;
+    }
+    return *this;
+  }
+
+  void write_byte(uint8_t value)
+  {
+    size_t avail;
+    *prepare(avail) = static_cast<char>(value);
+    commit(1);
+  }
+  void write_bytes(const void* d, int n)
+  {
+    auto ptr = static_cast<const char*>(d);
+    while (n > 0)
+    {
+      size_t avail;
+      auto dst = prepare(avail);
+      auto m   = (std::min)(static_cast<size_t>(n), avail);
+      ::memcpy(dst, ptr, m);
+      commit(m);
+      ptr += m;
+      n -= static_cast<int>(m);
+    }
+  }
+  // overwrite at offset, the range may cross chunks
+  void write_bytes(size_t offset, const void* d, int n)
+  {
+    if (yasio__unlikely((offset + n) > size_))
+      YASIO__THROW0(std::out_of_range("chunked_buffer: out of range"));
+    auto ptr        = static_cast<const char*>(d);
+    auto chunk_size = pool_->chunk_size();
+    auto index      = offset / chunk_size;
+    auto pos        = offset % chunk_size;
+    while (n > 0)
+    {
+      auto m = (std::min)(static_cast<size_t>(n), chunk_size - pos);
+      ::memcpy(chunks_[index].data + pos, ptr, m);
+      ptr += m;
+      n -= static_cast<int>(m);
+      ++index;
+      pos = 0;
+    }
+  }
+  void fill_bytes(size_t count, uint8_t val)
+  {
+    while (count > 0)
+    {
+      size_t avail;
+      auto dst = prepare(avail);
+      auto m   = (std::min)(count, avail);
+      ::memset(dst, val, m);
+      commit(m);
+      count -= m;
+    }
+  }
+
+  // Gets the writable space of tail chunk, a new chunk allocated when the tail is full
+  char* prepare(size_t& avail)
+  {
+    auto chunk_size = pool_->chunk_size();
+    if (chunks_.empty() || chunks_.back().size == chunk_size)
+      chunks_.push_back(chunk{pool_->allocate(), 0});
+    auto& tail = chunks_.back();
+    avail      = chunk_size - tail.size;
+    return tail.data + tail.size;
+  }
+  void commit(size_t n)
+  {
+    chunks_.back().size += n;
+    size_ += n;
+  }
+
+  void reserve(size_t /*capacity*/) {}
+  void shrink_to_fit() {}
+  void clear()
+  {
+    for (auto& c : chunks_)
+      pool_->deallocate(c.data);
+    chunks_.clear();
+    size_ = 0;
+  }
+
+  size_t length() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  const std::vector<chunk>& chunks() const { return chunks_; }
+
+  // Copy to a contiguous buffer, for transports don't support gather write
+  sbyte_buffer flatten() const
+  {
+    sbyte_buffer ret;
+    ret.reserve(size_);
+    for (auto& c : chunks_)
+      ret.insert(ret.end(), c.data, c.data + c.size);
+    return ret;
+  }
+
+private:
+  chunk_pool* pool_;
+  std::vector<chunk> chunks_;
+  size_t size_ = 0;
+};
+} // namespace yasio
+#endif
@@ -44,6 +44,7 @@ SOFTWARE.
 #  include <arpa/inet.h>
 #endif
 #include "yasio/impl/fp16.hpp"
+#include "yasio/impl/bswap_array.hpp"
 
 #ifdef _WIN32
 // Assuming windows is always little-endian.
@@ -223,6 +224,29 @@ struct convert_traits<network_convert_tag> {
   }
   static int toint(int value, int size) { return host_to_network(value, size); }
   static int fromint(int value, int size) { return network_to_host(value, size); }
+
+  // Bulk conversion of arithmetic arrays, the swap is vectorized where available
+  template <typename _Ty>
+  static inline void to_array(void* dst, const _Ty* src, size_t count)
+  {
+    convert_array(dst, src, count * sizeof(_Ty), sizeof(_Ty));
+  }
+  template <typename _Ty>
+  static inline void from_array(_Ty* dst, const void* src, size_t count)
+  {
+    convert_array(dst, src, count * sizeof(_Ty), sizeof(_Ty));
+  }
+
+private:
+  static inline void convert_array(void* dst, const void* src, size_t bytes, size_t elem_size)
+  {
+#if defined(YASIO_LITTLE_ENDIAN)
+    yasio::detail::bswap_array(dst, src, bytes / elem_size, elem_size);
+#else
+    (void)elem_size;
+    ::memcpy(dst, src, bytes);
+#endif
+  }
 };
 
 template <>
@@ -239,6 +263,17 @@ struct convert_traits<host_convert_tag> {
   }
   static int toint(int value, int) { return value; }
   static int fromint(int value, int) { return value; }
+
+  template <typename _Ty>
+  static inline void to_array(void* dst, const _Ty* src, size_t count)
+  {
+    ::memcpy(dst, src, count * sizeof(_Ty));
+  }
+  template <typename _Ty>
+  static inline void from_array(_Ty* dst, const void* src, size_t count)
+  {
+    ::memcpy(dst, src, count * sizeof(_Ty));
+  }
 };
 } // namespace endian
 #if !YASIO__HAS_CXX11
@@ -33,6 +33,7 @@ namespace errc
 enum
 {
   no_error              = 0,   // No error.
+  send_queue_full       = -29, // The send queue exceeds the high watermark.
   read_timeout          = -28, // The remote host did not respond after a period of time.
   invalid_packet        = -27, // Invalid packet.
   resolve_host_failed   = -26, // Resolve host failed.
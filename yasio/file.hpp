@@ -39,13 +39,13 @@ inline yasio::string read_text_file(cxx17::string_view file_path)
   std::ifstream fin(file_path.data(), std::ios_base::binary);
   if (fin.is_open())
   {
-    fin.seekg(std::ios_base::end);
+    fin.seekg(0, std::ios_base::end);
     auto n = static_cast<size_t>(fin.tellg());
     if (n > 0)
     {
       yasio::string ret;
       ret.resize_and_overwrite(n, [&fin](char* out, size_t outlen) {
-        fin.seekg(std::ios_base::beg);
+        fin.seekg(0, std::ios_base::beg);
         fin.read(out, outlen);
         return outlen;
       });
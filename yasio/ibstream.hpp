@@ -35,10 +35,48 @@ namespace detail
 template <typename _Stream, typename _Intty>
 struct read_ix_helper {};
 
+// Decode from memory with at least _MaxBytes available, returns bytes consumed, 0 if malformed
+template <typename _Uty, int _MaxBytes, unsigned int _LastMax>
+inline int decode_ix_unchecked(const uint8_t* p, _Uty& result)
+{
+  result = 0;
+  for (int i = 0; i < _MaxBytes - 1; ++i)
+  {
+    _Uty b = p[i];
+    result |= (b & 0x7Fu) << (i * 7);
+    if (b <= 0x7Fu)
+      return i + 1;
+  }
+  _Uty b = p[_MaxBytes - 1];
+  if (b <= _LastMax)
+  {
+    result |= b << ((_MaxBytes - 1) * 7);
+    return _MaxBytes;
+  }
+  return 0;
+}
+
+template <typename _Stream, typename _Uty, int _MaxBytes, unsigned int _LastMax>
+inline bool read_ix_fast(_Stream* stream, _Uty& result)
+{
+  auto offset = stream->tell();
+  if (static_cast<ptrdiff_t>(stream->length()) - offset < _MaxBytes)
+    return false;
+  int n = decode_ix_unchecked<_Uty, _MaxBytes, _LastMax>(reinterpret_cast<const uint8_t*>(stream->data() + offset), result);
+  if (n == 0)
+    return false; // let the slow path report the error
+  stream->advance(n);
+  return true;
+}
+
 template <typename _Stream>
 struct read_ix_helper<_Stream, int32_t> {
   static int32_t read_ix(_Stream* stream)
   {
+    uint32_t fast_result;
+    if (read_ix_fast<_Stream, uint32_t, 5, 0x0fu>(stream, fast_result))
+      return (int32_t)fast_result;
+
     // Unlike writing, we can't delegate to the 64-bit read on
     // 64-bit platforms. The reason for this is that we want to
     // stop consuming bytes if we encounter an integer overflow.
@@ -81,6 +119,10 @@ template <typename _Stream>
 struct read_ix_helper<_Stream, int64_t> {
   static int64_t read_ix(_Stream* stream)
   {
+    uint64_t fast_result;
+    if (read_ix_fast<_Stream, uint64_t, 10, 1u>(stream, fast_result))
+      return (int64_t)fast_result;
+
     uint64_t result = 0;
     uint8_t byteReadJustNow;
 
@@ -248,6 +290,82 @@ public:
     return convert_traits_type::template from<_Nty>(value);
   }
 
+  /* read uint32 array written by write_vbyte_array */
+  void read_vbyte_array(uint32_t* values, size_t count)
+  {
+    if (count)
+    {
+      auto n = detail::svb_decode(reinterpret_cast<const uint8_t*>(ptr_), static_cast<size_t>(last_ - ptr_), values, count);
+      if (yasio__unlikely(n == 0))
+        YASIO__THROW0(std::out_of_range("ibstream_view::read_vbyte_array out of range!"));
+      ptr_ += n;
+    }
+  }
+  template <typename _Alloc>
+  void read_vbyte_array(std::vector<uint32_t, _Alloc>& values, size_t count)
+  {
+    if (yasio__unlikely(count > static_cast<size_t>(last_ - ptr_))) // at least 1 byte per value
+      YASIO__THROW0(std::out_of_range("ibstream_view::read_vbyte_array out of range!"));
+    values.resize(count);
+    read_vbyte_array(values.data(), count);
+  }
+
+  /* read float array written by write_half_array */
+  void read_half_array(float* values, size_t count)
+  {
+    auto ptr = consume_array<uint16_t>(count);
+    if (ptr)
+      detail::decode_half_array<convert_traits_type>(values, ptr, count);
+  }
+  template <typename _Alloc>
+  void read_half_array(std::vector<float, _Alloc>& values, size_t count)
+  {
+    auto ptr = consume_array<uint16_t>(count);
+    if (ptr)
+    {
+      values.resize(count);
+      detail::decode_half_array<convert_traits_type>(values.data(), ptr, count);
+    }
+  }
+
+  /* read arithmetic array without length field, all elements are converted in bulk */
+  template <typename _Nty>
+  void read_array(_Nty* values, size_t count)
+  {
+    static_assert(std::is_arithmetic<_Nty>::value, "yasio: read_array requires arithmetic type!");
+    auto ptr = consume_array<_Nty>(count);
+    if (ptr)
+      convert_traits_type::template from_array<_Nty>(values, ptr, count);
+  }
+  template <typename _Nty, typename _Alloc>
+  void read_array(std::vector<_Nty, _Alloc>& values, size_t count)
+  {
+    static_assert(std::is_arithmetic<_Nty>::value, "yasio: read_array requires arithmetic type!");
+    auto ptr = consume_array<_Nty>(count);
+    if (ptr)
+    {
+      values.resize(count);
+      convert_traits_type::template from_array<_Nty>(values.data(), ptr, count);
+    }
+  }
+  template <typename _Nty, size_t _Size>
+  void read_array(std::array<_Nty, _Size>& values)
+  {
+    read_array(values.data(), _Size);
+  }
+  template <typename _Nty, size_t _Size>
+  void read_array(_Nty (&values)[_Size])
+  {
+    read_array(&values[0], _Size);
+  }
+#if YASIO__HAS_CXX20
+  template <typename _Nty, size_t _Extent>
+  void read_array(std::span<_Nty, _Extent> values)
+  {
+    read_array(values.data(), values.size());
+  }
+#endif
+
   template <typename _LenT>
   inline cxx17::string_view read_v_fx()
   {
@@ -267,6 +385,15 @@ public:
   bool eof() const { return ptr_ == last_; }
 
 protected:
+  // will throw std::out_of_range, the count is checked before multiply to avoid overflow
+  template <typename _Nty>
+  const char* consume_array(size_t count)
+  {
+    if (count <= static_cast<size_t>(last_ - ptr_) / sizeof(_Nty))
+      return consume(count * sizeof(_Nty));
+    YASIO__THROW(std::out_of_range("ibstream_view::consume out of range!"), nullptr);
+  }
+
   // will throw std::out_of_range
   const char* consume(size_t size)
   {
@@ -0,0 +1,158 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// A multi-platform support c++11 library with focus on asynchronous socket I/O for any
+// client application.
+//////////////////////////////////////////////////////////////////////////////////////////
+/*
+The MIT License (MIT)
+
+Copyright (c) 2012-2024 HALX99
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef YASIO__BSWAP_ARRAY_HPP
+#define YASIO__BSWAP_ARRAY_HPP
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__AVX2__)
+#  include <immintrin.h>
+#  define YASIO__BSWAP_AVX2 1
+#elif defined(__SSSE3__) || defined(__AVX__)
+#  include <tmmintrin.h>
+#  define YASIO__BSWAP_SSSE3 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define YASIO__BSWAP_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#  include <arm_neon.h>
+#  define YASIO__BSWAP_NEON 1
+#endif
+
+/*
+** Reverse the bytes of each element in an array, the dst & src may be same but not
+** partially overlapped, the alignment is not required.
+*/
+namespace yasio
+{
+namespace detail
+{
+inline uint16_t bswap16(uint16_t v) { return static_cast<uint16_t>((v >> 8) | (v << 8)); }
+inline uint32_t bswap32(uint32_t v) { return ((v >> 24) & 0xffu) | ((v >> 8) & 0xff00u) | ((v << 8) & 0xff0000u) | (v << 24); }
+inline uint64_t bswap64(uint64_t v) { return (static_cast<uint64_t>(bswap32(static_cast<uint32_t>(v))) << 32) | bswap32(static_cast<uint32_t>(v >> 32)); }
+
+template <typename _Uty>
+inline void bswap_array_tail(char* dst, const char* src, size_t count, _Uty (*op)(_Uty))
+{
+  for (size_t i = 0; i < count; ++i)
+  {
+    _Uty v;
+    ::memcpy(&v, src + i * sizeof(_Uty), sizeof(v));
+    v = op(v);
+    ::memcpy(dst + i * sizeof(_Uty), &v, sizeof(v));
+  }
+}
+
+#if defined(YASIO__BSWAP_AVX2) || defined(YASIO__BSWAP_SSSE3)
+// The pshufb masks of 16/32/64 bits elements
+inline const char* bswap_shuffle_mask(size_t elem_size)
+{
+  alignas(32) static const char masks[3][32] = {
+      {1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14, 1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14},
+      {3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12, 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12},
+      {7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8}};
+  return masks[elem_size == 2 ? 0 : (elem_size == 4 ? 1 : 2)];
+}
+#endif
+
+// Swaps the whole 16 bytes blocks, returns the bytes processed
+inline size_t bswap_array_blocks(char* dst, const char* src, size_t bytes, size_t elem_size)
+{
+  size_t i = 0;
+#if defined(YASIO__BSWAP_AVX2)
+  const __m256i mask = _mm256_load_si256(reinterpret_cast<const __m256i*>(bswap_shuffle_mask(elem_size)));
+  for (; i + 32 <= bytes; i += 32)
+  {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_shuffle_epi8(v, mask));
+  }
+#elif defined(YASIO__BSWAP_SSSE3)
+  const __m128i mask = _mm_load_si128(reinterpret_cast<const __m128i*>(bswap_shuffle_mask(elem_size)));
+  for (; i + 16 <= bytes; i += 16)
+  {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_shuffle_epi8(v, mask));
+  }
+#elif defined(YASIO__BSWAP_SSE2)
+  for (; i + 16 <= bytes; i += 16)
+  {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    v         = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8)); // swap bytes of 16 bits lanes
+    if (elem_size >= 4)
+    { // swap 16 bits lanes of 32 bits lanes
+      v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+      v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+    }
+    if (elem_size == 8) // swap 32 bits lanes of 64 bits lanes
+      v = _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), v);
+  }
+#elif defined(YASIO__BSWAP_NEON)
+  for (; i + 16 <= bytes; i += 16)
+  {
+    uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t*>(src + i));
+    v            = elem_size == 2 ? vrev16q_u8(v) : (elem_size == 4 ? vrev32q_u8(v) : vrev64q_u8(v));
+    vst1q_u8(reinterpret_cast<uint8_t*>(dst + i), v);
+  }
+#else
+  (void)dst;
+  (void)src;
+  (void)bytes;
+  (void)elem_size;
+#endif
+  return i;
+}
+
+inline void bswap_array(void* dst, const void* src, size_t count, size_t elem_size)
+{
+  auto d = static_cast<char*>(dst);
+  auto s = static_cast<const char*>(src);
+  switch (elem_size)
+  {
+    case 2:
+    case 4:
+    case 8: {
+      auto done = bswap_array_blocks(d, s, count * elem_size, elem_size);
+      d += done;
+      s += done;
+      count -= done / elem_size;
+      if (elem_size == 2)
+        bswap_array_tail<uint16_t>(d, s, count, bswap16);
+      else if (elem_size == 4)
+        bswap_array_tail<uint32_t>(d, s, count, bswap32);
+      else
+        bswap_array_tail<uint64_t>(d, s, count, bswap64);
+      break;
+    }
+    default:
+      if (d != s)
+        ::memcpy(d, s, count * elem_size);
+  }
+}
+} // namespace detail
+} // namespace yasio
+#endif
@@ -0,0 +1,93 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// A multi-platform support c++11 library with focus on asynchronous socket I/O for any
+// client application.
+//////////////////////////////////////////////////////////////////////////////////////////
+/*
+The MIT License (MIT)
+
+Copyright (c) 2012-2024 HALX99
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef YASIO__CPUID_HPP
+#define YASIO__CPUID_HPP
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#  define YASIO__HAS_X86_CPUID 1
+#  if defined(__GNUC__) || defined(__clang__)
+#    include <cpuid.h>
+// The kernels compiled for the instruction set not enabled by compiler flags, select them by cpu_features at runtime
+#    define YASIO__TARGET(isa) __attribute__((target(isa)))
+#  else
+#    include <intrin.h>
+#    define YASIO__TARGET(isa)
+#  endif
+
+namespace yasio
+{
+namespace detail
+{
+struct cpu_features {
+  bool ssse3 = false;
+  bool avx2  = false;
+  bool f16c  = false;
+
+  cpu_features()
+  {
+    unsigned int leaf1[4] = {0}, leaf7[4] = {0};
+    cpuid(0, leaf1);
+    unsigned int max_leaf = leaf1[0];
+    cpuid(1, leaf1);
+    if (max_leaf >= 7)
+      cpuid(7, leaf7);
+    ssse3 = !!(leaf1[2] & (1u << 9));
+    // the ymm states must be saved by OS: OSXSAVE & AVX, then XCR0 has SSE & AVX state bits
+    bool avx = (leaf1[2] & (1u << 27)) && (leaf1[2] & (1u << 28)) && (xgetbv0() & 6) == 6;
+    f16c     = avx && (leaf1[2] & (1u << 29));
+    avx2     = avx && (leaf7[1] & (1u << 5));
+  }
+
+private:
+  static void cpuid(unsigned int leaf, unsigned int regs[4])
+  {
+#  if defined(__GNUC__) || defined(__clang__)
+    __cpuid_count(leaf, 0, regs[0], regs[1], regs[2], regs[3]);
+#  else
+    __cpuidex(reinterpret_cast<int*>(regs), static_cast<int>(leaf), 0);
+#  endif
+  }
+  static unsigned long long xgetbv0()
+  {
+#  if defined(__GNUC__) || defined(__clang__)
+    unsigned int eax, edx;
+    __asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (static_cast<unsigned long long>(edx) << 32) | eax;
+#  else
+    return _xgetbv(0);
+#  endif
+  }
+};
+
+inline const cpu_features& get_cpu_features()
+{
+  static const cpu_features features;
+  return features;
+}
+} // namespace detail
+} // namespace yasio
+#endif
+#endif
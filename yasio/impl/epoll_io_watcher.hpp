@@ -118,6 +118,13 @@ public:
 
   int max_descriptor() const { return -1; }
 
+  // The epoll descriptor is readable when any registered event ready, -1: wepoll handle isn't pollable
+#if !defined(_WIN32)
+  int pollable_descriptor() const { return epoll_handle_; }
+#else
+  int pollable_descriptor() const { return -1; }
+#endif
+
 protected:
   int to_underlying_events(int events)
   {
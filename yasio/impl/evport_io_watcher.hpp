@@ -121,6 +121,9 @@ public:
 
   int max_descriptor() const { return -1; }
 
+  // The event port is pollable when any associated event ready
+  int pollable_descriptor() const { return port_handle_; }
+
 protected:
   int to_underlying_events(int events)
   {
@@ -0,0 +1,477 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// A multi-platform support c++11 library with focus on asynchronous socket I/O for any
+// client application.
+//////////////////////////////////////////////////////////////////////////////////////////
+/*
+The MIT License (MIT)
+
+Copyright (c) 2012-2024 HALX99
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef YASIO__FEC_HPP
+#define YASIO__FEC_HPP
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+#include "yasio/compiler/feature_test.hpp"
+
+#if defined(__AVX2__)
+#  include <immintrin.h>
+#  define YASIO__GF256_AVX2 1
+#  define YASIO__GF256_SSSE3 1
+#elif defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+// not enabled by compiler flags, the kernels are compiled for target avx2 & ssse3 and selected by cpuid at runtime
+#  include <immintrin.h>
+#  include "yasio/impl/cpuid.hpp"
+#  define YASIO__GF256_AVX2 1
+#  define YASIO__GF256_SSSE3 1
+#  define YASIO__GF256_DISPATCH 1
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#  include <arm_neon.h>
+#  define YASIO__GF256_NEON 1
+#endif
+
+#if defined(YASIO__GF256_DISPATCH)
+#  define YASIO__GF256_TARGET(isa) YASIO__TARGET(isa)
+#else
+#  define YASIO__GF256_TARGET(isa)
+#endif
+
+/*
+** The forward error correction codec for datagram transports, systematic Reed-Solomon
+** over GF(2^8) with a Cauchy encode matrix, any data_shards of the data_shards + parity_shards
+** shards of a group can recover the group.
+**
+** The wire format of shard: [seqid:u32][flag:u16][payload], little endian,
+**   + data shard payload: [size:u16][data], the size include itself
+**   + parity shard payload: the parity of data shard payloads, zero padded to the longest one
+** The data shards are sent and delivered at once, so FEC never delays a datagram, the parity
+** shards are sent when a group filled.
+*/
+namespace yasio
+{
+namespace detail
+{
+struct gf256_tables {
+  uint8_t exp[512];
+  uint8_t log[256];
+  // the products of 4bit split, a * c = mul_lo[c][a & 0xf] ^ mul_hi[c][a >> 4]
+  uint8_t mul_lo[256][16];
+  uint8_t mul_hi[256][16];
+
+  gf256_tables()
+  {
+    int x = 1;
+    for (int i = 0; i < 255; ++i)
+    {
+      exp[i] = static_cast<uint8_t>(x);
+      log[x] = static_cast<uint8_t>(i);
+      x <<= 1;
+      if (x & 0x100)
+        x ^= 0x11d; // x^8 + x^4 + x^3 + x^2 + 1
+    }
+    for (int i = 255; i < 512; ++i)
+      exp[i] = exp[i - 255];
+    log[0] = 0;
+    for (int c = 0; c < 256; ++c)
+      for (int i = 0; i < 16; ++i)
+      {
+        mul_lo[c][i] = mul(static_cast<uint8_t>(c), static_cast<uint8_t>(i));
+        mul_hi[c][i] = mul(static_cast<uint8_t>(c), static_cast<uint8_t>(i << 4));
+      }
+  }
+  uint8_t mul(uint8_t a, uint8_t b) const { return (a && b) ? exp[log[a] + log[b]] : 0; }
+  uint8_t inv(uint8_t a) const { return exp[255 - log[a]]; }
+};
+inline const gf256_tables& gf256()
+{
+  static gf256_tables tables;
+  return tables;
+}
+
+#if defined(YASIO__GF256_SSSE3)
+// The kernels of dst ^= c * src by the 4bit split tables of c, return the bytes processed from the offset i
+YASIO__GF256_TARGET("avx2") inline size_t gf256_mul_add_avx2(uint8_t* dst, const uint8_t* src, const uint8_t* lo, const uint8_t* hi, size_t i,
+                                                              size_t len)
+{
+  const __m256i lo32   = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(lo)));
+  const __m256i hi32   = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(hi)));
+  const __m256i mask32 = _mm256_set1_epi8(0x0f);
+  for (; i + 32 <= len; i += 32)
+  {
+    __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+    __m256i p = _mm256_xor_si256(_mm256_shuffle_epi8(lo32, _mm256_and_si256(s, mask32)),
+                                 _mm256_shuffle_epi8(hi32, _mm256_and_si256(_mm256_srli_epi64(s, 4), mask32)));
+    __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_xor_si256(d, p));
+  }
+  return i;
+}
+YASIO__GF256_TARGET("ssse3") inline size_t gf256_mul_add_ssse3(uint8_t* dst, const uint8_t* src, const uint8_t* lo, const uint8_t* hi, size_t i,
+                                                                size_t len)
+{
+  const __m128i lo16   = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lo));
+  const __m128i hi16   = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hi));
+  const __m128i mask16 = _mm_set1_epi8(0x0f);
+  for (; i + 16 <= len; i += 16)
+  {
+    __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    __m128i p = _mm_xor_si128(_mm_shuffle_epi8(lo16, _mm_and_si128(s, mask16)), _mm_shuffle_epi8(hi16, _mm_and_si128(_mm_srli_epi64(s, 4), mask16)));
+    __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_xor_si128(d, p));
+  }
+  return i;
+}
+#endif
+
+// dst ^= c * src
+inline void gf256_mul_add(uint8_t* dst, const uint8_t* src, uint8_t c, size_t len)
+{
+  if (c == 0)
+    return;
+  auto& tables      = gf256();
+  const uint8_t* lo = tables.mul_lo[c];
+  const uint8_t* hi = tables.mul_hi[c];
+  size_t i          = 0;
+#if defined(YASIO__GF256_SSSE3)
+#  if defined(YASIO__GF256_DISPATCH)
+  auto& features = get_cpu_features();
+  if (features.avx2)
+#  endif
+    i = gf256_mul_add_avx2(dst, src, lo, hi, i, len);
+#  if defined(YASIO__GF256_DISPATCH)
+  if (features.ssse3)
+#  endif
+    i = gf256_mul_add_ssse3(dst, src, lo, hi, i, len);
+#elif defined(YASIO__GF256_NEON)
+  const uint8x16_t lo16   = vld1q_u8(lo);
+  const uint8x16_t hi16   = vld1q_u8(hi);
+  const uint8x16_t mask16 = vdupq_n_u8(0x0f);
+  for (; i + 16 <= len; i += 16)
+  {
+    uint8x16_t s = vld1q_u8(src + i);
+    uint8x16_t p = veorq_u8(vqtbl1q_u8(lo16, vandq_u8(s, mask16)), vqtbl1q_u8(hi16, vshrq_n_u8(s, 4)));
+    vst1q_u8(dst + i, veorq_u8(vld1q_u8(dst + i), p));
+  }
+#endif
+  for (; i < len; ++i)
+    dst[i] ^= lo[src[i] & 0x0f] ^ hi[src[i] >> 4];
+}
+
+// Gauss-Jordan elimination, the inv should be identity matrix at input
+inline bool gf256_invert_matrix(uint8_t* m, uint8_t* inv, int n)
+{
+  auto& tables = gf256();
+  for (int col = 0; col < n; ++col)
+  {
+    int pivot = col;
+    while (pivot < n && m[pivot * n + col] == 0)
+      ++pivot;
+    if (pivot == n)
+      return false; // singular
+    if (pivot != col)
+      for (int k = 0; k < n; ++k)
+      {
+        uint8_t t = m[pivot * n + k];
+        m[pivot * n + k] = m[col * n + k];
+        m[col * n + k]   = t;
+        t                  = inv[pivot * n + k];
+        inv[pivot * n + k] = inv[col * n + k];
+        inv[col * n + k]   = t;
+      }
+    uint8_t scale = tables.inv(m[col * n + col]);
+    for (int k = 0; k < n; ++k)
+    {
+      m[col * n + k]   = tables.mul(m[col * n + k], scale);
+      inv[col * n + k] = tables.mul(inv[col * n + k], scale);
+    }
+    for (int r = 0; r < n; ++r)
+    {
+      uint8_t factor = m[r * n + col];
+      if (r != col && factor)
+      {
+        gf256_mul_add(m + r * n, m + col * n, factor, n);
+        gf256_mul_add(inv + r * n, inv + col * n, factor, n);
+      }
+    }
+  }
+  return true;
+}
+inline void fec_write_u16(uint8_t* p, unsigned int v)
+{
+  p[0] = static_cast<uint8_t>(v);
+  p[1] = static_cast<uint8_t>(v >> 8);
+}
+inline void fec_write_u32(uint8_t* p, uint32_t v)
+{
+  fec_write_u16(p, v & 0xffff);
+  fec_write_u16(p + 2, v >> 16);
+}
+inline unsigned int fec_read_u16(const uint8_t* p) { return p[0] | (p[1] << 8); }
+inline uint32_t fec_read_u32(const uint8_t* p) { return fec_read_u16(p) | (static_cast<uint32_t>(fec_read_u16(p + 2)) << 16); }
+} // namespace detail
+
+class fec_codec {
+public:
+  enum
+  {
+    header_size = 6, // seqid:u32, flag:u16
+    overhead    = 8, // header + size:u16 of data shard
+    flag_data   = 0xf1,
+    flag_parity = 0xf2,
+    max_groups  = 3, // the recent groups kept by decoder
+  };
+
+  /*
+  ** @params:
+  **   data_shards + parity_shards: must <= 256
+  **   mtu: the max size of shard on wire, the input datagram should <= mtu - overhead
+  */
+  // requires data_shards > 0, parity_shards > 0 and data_shards + parity_shards <= 256, see: YOPT_C_KCP_FEC
+  fec_codec(int data_shards, int parity_shards, int mtu)
+      : data_shards_(data_shards), parity_shards_(parity_shards), total_shards_(data_shards + parity_shards), stride_(mtu),
+        max_group_id_(0xffffffffu / static_cast<uint32_t>(data_shards + parity_shards))
+  {
+    auto& tables = detail::gf256();
+    // Cauchy matrix: 1 / (x_i + y_j), x_i = data_shards + i, y_j = j, every square sub matrix is invertible
+    coefs_.resize(parity_shards_ * data_shards_);
+    for (int i = 0; i < parity_shards_; ++i)
+      for (int j = 0; j < data_shards_; ++j)
+        coefs_[i * data_shards_ + j] = tables.inv(static_cast<uint8_t>((data_shards_ + i) ^ j));
+    enc_buf_.resize(total_shards_ * stride_);
+    enc_lens_.resize(data_shards_);
+    for (auto& g : groups_)
+    {
+      g.buf.resize(total_shards_ * stride_);
+      g.lens.resize(total_shards_);
+      g.flags.resize(total_shards_);
+    }
+    matrix_.resize(data_shards_ * data_shards_);
+    inverse_.resize(data_shards_ * data_shards_);
+    rows_.resize(data_shards_);
+  }
+
+  int data_shards() const { return data_shards_; }
+  int parity_shards() const { return parity_shards_; }
+
+  // The count of data shards recovered from parity
+  unsigned long long recovered() const { return recovered_; }
+
+  /*
+  ** Encode a datagram to data shard, and parity shards when group filled
+  ** output: int(const void* shard, int len), the return value of data shard output is returned
+  */
+  template <typename _Fty>
+  int encode(const void* data, int len, _Fty&& output)
+  {
+    const int size = len + 2;
+    if (yasio__unlikely(size > stride_ - header_size))
+      return -1;
+    uint8_t* shard = shard_at(enc_buf_, enc_index_);
+    detail::fec_write_u32(shard, enc_group_ * total_shards_ + enc_index_);
+    detail::fec_write_u16(shard + 4, flag_data);
+    detail::fec_write_u16(shard + header_size, size);
+    ::memcpy(shard + header_size + 2, data, len);
+    enc_lens_[enc_index_] = size;
+    if (enc_max_len_ < size)
+      enc_max_len_ = size;
+    int ret = output(shard, header_size + size);
+    if (++enc_index_ == data_shards_)
+    {
+      encode_parity(output);
+      enc_index_   = 0;
+      enc_max_len_ = 0;
+      if (++enc_group_ == max_group_id_)
+        enc_group_ = 0;
+    }
+    return ret;
+  }
+
+  /*
+  ** Decode a shard, the data of received or recovered data shards are passed to input
+  ** input: int(const char* data, int len), < 0 for error
+  ** @returns: 0: succeed, -1: malformed shard or the input failed
+  */
+  template <typename _Fty>
+  int decode(const void* shard, int len, _Fty&& input)
+  {
+    if (len < overhead || len > stride_)
+      return -1;
+    auto p         = static_cast<const uint8_t*>(shard);
+    uint32_t seqid = detail::fec_read_u32(p);
+    unsigned flag  = detail::fec_read_u16(p + 4);
+    uint32_t gid   = seqid / total_shards_;
+    int index      = static_cast<int>(seqid % total_shards_);
+    if (gid >= max_group_id_)
+      return -1;
+    p += header_size;
+    len -= header_size;
+    if (flag == flag_data)
+    {
+      int size = static_cast<int>(detail::fec_read_u16(p));
+      if (index >= data_shards_ || size < 2 || size > len)
+        return -1;
+      int ret = input(reinterpret_cast<const char*>(p + 2), size - 2);
+      if (ret < 0)
+        return ret;
+      return store(gid, index, p, size, input);
+    }
+    if (flag != flag_parity || index < data_shards_)
+      return -1;
+    return store(gid, index, p, len, input);
+  }
+
+private:
+  struct group {
+    uint32_t gid = 0xffffffffu; // invalid
+    int count    = 0;           // received shards
+    int ndata    = 0;           // received or recovered data shards
+    int max_len  = 0;           // the parity length
+    std::vector<uint8_t> buf;
+    std::vector<int> lens;
+    std::vector<uint8_t> flags;
+  };
+
+  uint8_t* shard_at(std::vector<uint8_t>& buf, int index) { return buf.data() + index * stride_; }
+
+  template <typename _Fty>
+  void encode_parity(_Fty&& output)
+  {
+    const int len = enc_max_len_;
+    for (int j = 0; j < data_shards_; ++j)
+      ::memset(shard_at(enc_buf_, j) + header_size + enc_lens_[j], 0, len - enc_lens_[j]);
+    for (int i = 0; i < parity_shards_; ++i)
+    {
+      uint8_t* shard  = shard_at(enc_buf_, data_shards_ + i);
+      uint8_t* parity = shard + header_size;
+      ::memset(parity, 0, len);
+      for (int j = 0; j < data_shards_; ++j)
+        detail::gf256_mul_add(parity, shard_at(enc_buf_, j) + header_size, coefs_[i * data_shards_ + j], len);
+      detail::fec_write_u32(shard, enc_group_ * total_shards_ + data_shards_ + i);
+      detail::fec_write_u16(shard + 4, flag_parity);
+      output(shard, header_size + len);
+    }
+  }
+
+  template <typename _Fty>
+  int store(uint32_t gid, int index, const uint8_t* payload, int len, _Fty&& input)
+  {
+    auto& g = groups_[gid % max_groups];
+    if (g.gid != gid)
+    {
+      // the slot hold a newer group, the shard is too late to help
+      if (g.gid != 0xffffffffu && ((gid + max_group_id_ - g.gid) % max_group_id_) > max_group_id_ / 2)
+        return 0;
+      g.gid     = gid;
+      g.count   = 0;
+      g.ndata   = 0;
+      g.max_len = 0;
+      std::fill(g.flags.begin(), g.flags.end(), 0);
+    }
+    if (g.ndata == data_shards_ || g.flags[index])
+      return 0; // complete or duplicated
+    g.flags[index] = 1;
+    g.lens[index]  = len;
+    ::memcpy(shard_at(g.buf, index), payload, len);
+    ++g.count;
+    if (index < data_shards_)
+      ++g.ndata;
+    else
+      g.max_len = len;
+    return (g.count >= data_shards_ && g.ndata < data_shards_) ? recover(g, input) : 0;
+  }
+
+  template <typename _Fty>
+  int recover(group& g, _Fty&& input)
+  {
+    const int n   = data_shards_;
+    const int len = g.max_len;
+    int k         = 0;
+    for (int i = 0; i < total_shards_ && k < n; ++i)
+    {
+      if (!g.flags[i])
+        continue;
+      if (g.lens[i] > len)
+        return -1; // data shard longer than parity
+      ::memset(shard_at(g.buf, i) + g.lens[i], 0, len - g.lens[i]);
+      rows_[k++] = i;
+    }
+
+    // the rows of encode matrix for received shards, data shard is an identity row
+    ::memset(matrix_.data(), 0, matrix_.size());
+    ::memset(inverse_.data(), 0, inverse_.size());
+    for (int r = 0; r < n; ++r)
+    {
+      if (rows_[r] < n)
+        matrix_[r * n + rows_[r]] = 1;
+      else
+        ::memcpy(&matrix_[r * n], &coefs_[(rows_[r] - n) * n], n);
+      inverse_[r * n + r] = 1;
+    }
+    if (!detail::gf256_invert_matrix(matrix_.data(), inverse_.data(), n))
+      return -1;
+
+    int ret = 0;
+    for (int m = 0; m < n; ++m)
+    {
+      if (g.flags[m])
+        continue;
+      uint8_t* out = shard_at(g.buf, m);
+      ::memset(out, 0, len);
+      for (int c = 0; c < n; ++c)
+        detail::gf256_mul_add(out, shard_at(g.buf, rows_[c]), inverse_[m * n + c], len);
+      g.flags[m] = 1;
+      int size   = static_cast<int>(detail::fec_read_u16(out));
+      if (size >= 2 && size <= len)
+      {
+        ++recovered_;
+        if (input(reinterpret_cast<const char*>(out + 2), size - 2) < 0)
+          ret = -1;
+      }
+    }
+    g.ndata = n;
+    return ret;
+  }
+
+  int data_shards_;
+  int parity_shards_;
+  int total_shards_;
+  int stride_;
+  uint32_t max_group_id_;
+  std::vector<uint8_t> coefs_; // parity_shards x data_shards
+
+  // encoder
+  std::vector<uint8_t> enc_buf_; // shards of current group with header
+  std::vector<int> enc_lens_;
+  uint32_t enc_group_ = 0;
+  int enc_index_      = 0;
+  int enc_max_len_    = 0;
+
+  // decoder
+  group groups_[max_groups];
+  std::vector<uint8_t> matrix_;
+  std::vector<uint8_t> inverse_;
+  std::vector<int> rows_;
+  unsigned long long recovered_ = 0;
+};
+} // namespace yasio
+#endif
@@ -0,0 +1,220 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// A multi-platform support c++11 library with focus on asynchronous socket I/O for any
+// client application.
+//////////////////////////////////////////////////////////////////////////////////////////
+/*
+The MIT License (MIT)
+
+Copyright (c) 2012-2024 HALX99
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef YASIO__HALF_ARRAY_HPP
+#define YASIO__HALF_ARRAY_HPP
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__F16C__) || (defined(_MSC_VER) && defined(__AVX2__))
+#  include <immintrin.h>
+#  define YASIO__HALF_F16C 1
+#elif defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+// not enabled by compiler flags, the kernels are compiled for target f16c and selected by cpuid at runtime
+#  include <immintrin.h>
+#  include "yasio/impl/cpuid.hpp"
+#  define YASIO__HALF_F16C 1
+#  define YASIO__HALF_DISPATCH 1
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#  include <arm_neon.h>
+#  define YASIO__HALF_NEON 1
+#endif
+
+#if defined(YASIO__HALF_DISPATCH)
+#  define YASIO__HALF_TARGET(isa) YASIO__TARGET(isa)
+#else
+#  define YASIO__HALF_TARGET(isa)
+#endif
+
+/*
+** Convert float array to/from IEEE 754 half-precision in bulk, with round to nearest even,
+** F16C on x86, NEON on arm64, the scalar fallback gives the same result except NaN payload.
+** The halfs stored with host byte order, the alignment is not required.
+*/
+namespace yasio
+{
+namespace detail
+{
+inline uint16_t float_to_half(float value)
+{
+  const uint32_t f16max       = (127 + 16) << 23; // 65536.0f, the result is inf or nan
+  const uint32_t f32infty     = 255 << 23;
+  const uint32_t denorm_magic = ((127 - 15) + (23 - 10) + 1) << 23;
+
+  uint32_t u;
+  ::memcpy(&u, &value, sizeof(u));
+  uint32_t sign = u & 0x80000000u;
+  u ^= sign;
+
+  uint16_t h;
+  if (u >= f16max)
+    h = (u > f32infty) ? 0x7e00 : 0x7c00;
+  else if (u < (113u << 23))
+  { // subnormal or zero, align the mantissa by float add with the magic, the fpu rounds to nearest even
+    float f, magic;
+    ::memcpy(&f, &u, sizeof(f));
+    ::memcpy(&magic, &denorm_magic, sizeof(magic));
+    f += magic;
+    ::memcpy(&u, &f, sizeof(u));
+    h = static_cast<uint16_t>(u - denorm_magic);
+  }
+  else
+  {
+    uint32_t mant_odd = (u >> 13) & 1;
+    u += ((15u - 127u) << 23) + 0xfff + mant_odd; // rebias exponent and round
+    h = static_cast<uint16_t>(u >> 13);
+  }
+  return static_cast<uint16_t>(h | (sign >> 16));
+}
+
+inline float half_to_float(uint16_t value)
+{
+  const uint32_t shifted_exp = 0x7c00u << 13;
+  const uint32_t magic_bits  = 113u << 23;
+
+  uint32_t u   = (value & 0x7fffu) << 13;
+  uint32_t exp = shifted_exp & u;
+  u += (127u - 15u) << 23;
+  if (exp == shifted_exp) // inf or nan
+    u += (128u - 16u) << 23;
+  else if (exp == 0)
+  { // zero or subnormal, renormalize
+    u += 1u << 23;
+    float f, magic;
+    ::memcpy(&f, &u, sizeof(f));
+    ::memcpy(&magic, &magic_bits, sizeof(magic));
+    f -= magic;
+    ::memcpy(&u, &f, sizeof(u));
+  }
+  u |= static_cast<uint32_t>(value & 0x8000u) << 16;
+  float ret;
+  ::memcpy(&ret, &u, sizeof(ret));
+  return ret;
+}
+
+#if defined(YASIO__HALF_F16C)
+// The F16C kernels, convert 8 per loop, return the count converted
+YASIO__HALF_TARGET("avx,f16c") inline size_t float_to_half_f16c(char* out, const float* src, size_t count)
+{
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8)
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 2), _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT));
+  return i;
+}
+YASIO__HALF_TARGET("avx,f16c") inline size_t half_to_float_f16c(float* dst, const char* in, size_t count)
+{
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8)
+    _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i * 2))));
+  return i;
+}
+#endif
+
+inline void float_to_half_array(void* dst, const float* src, size_t count)
+{
+  auto out = static_cast<char*>(dst);
+  size_t i = 0;
+#if defined(YASIO__HALF_F16C)
+#  if defined(YASIO__HALF_DISPATCH)
+  if (get_cpu_features().f16c)
+#  endif
+    i = float_to_half_f16c(out, src, count);
+#elif defined(YASIO__HALF_NEON)
+  for (; i + 8 <= count; i += 8)
+  {
+    float16x8_t h = vcombine_f16(vcvt_f16_f32(vld1q_f32(src + i)), vcvt_f16_f32(vld1q_f32(src + i + 4)));
+    vst1q_u8(reinterpret_cast<uint8_t*>(out + i * 2), vreinterpretq_u8_f16(h));
+  }
+#endif
+  for (; i < count; ++i)
+  {
+    uint16_t h = float_to_half(src[i]);
+    ::memcpy(out + i * 2, &h, sizeof(h));
+  }
+}
+
+inline void half_to_float_array(float* dst, const void* src, size_t count)
+{
+  auto in  = static_cast<const char*>(src);
+  size_t i = 0;
+#if defined(YASIO__HALF_F16C)
+#  if defined(YASIO__HALF_DISPATCH)
+  if (get_cpu_features().f16c)
+#  endif
+    i = half_to_float_f16c(dst, in, count);
+#elif defined(YASIO__HALF_NEON)
+  for (; i + 8 <= count; i += 8)
+  {
+    float16x8_t h = vreinterpretq_f16_u8(vld1q_u8(reinterpret_cast<const uint8_t*>(in + i * 2)));
+    vst1q_f32(dst + i, vcvt_f32_f16(vget_low_f16(h)));
+    vst1q_f32(dst + i + 4, vcvt_f32_f16(vget_high_f16(h)));
+  }
+#endif
+  for (; i < count; ++i)
+  {
+    uint16_t h;
+    ::memcpy(&h, in + i * 2, sizeof(h));
+    dst[i] = half_to_float(h);
+  }
+}
+
+enum : size_t
+{
+  half_array_block = 256 // the halfs converted per block, then reorder bytes by convert traits while in L1 cache
+};
+
+template <typename _ConvertTraits>
+inline void encode_half_array(char* dst, const float* src, size_t count)
+{
+  uint16_t block[half_array_block];
+  while (count)
+  {
+    size_t n = count < half_array_block ? count : half_array_block;
+    float_to_half_array(block, src, n);
+    _ConvertTraits::template to_array<uint16_t>(dst, block, n);
+    dst += n * sizeof(uint16_t);
+    src += n;
+    count -= n;
+  }
+}
+
+template <typename _ConvertTraits>
+inline void decode_half_array(float* dst, const char* src, size_t count)
+{
+  uint16_t block[half_array_block];
+  while (count)
+  {
+    size_t n = count < half_array_block ? count : half_array_block;
+    _ConvertTraits::template from_array<uint16_t>(block, src, n);
+    half_to_float_array(dst, block, n);
+    dst += n;
+    src += n * sizeof(uint16_t);
+    count -= n;
+  }
+}
+} // namespace detail
+} // namespace yasio
+#endif
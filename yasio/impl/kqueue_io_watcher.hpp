@@ -97,6 +97,9 @@ public:
 
   int max_descriptor() const { return -1; }
 
+  // The kqueue descriptor is readable when any registered event ready
+  int pollable_descriptor() const { return kqueue_fd_; }
+
 protected:
   void register_event(socket_native_type fd, int events)
   {
@@ -33,9 +33,25 @@ SOFTWARE.
 
 #  include "yasio/split.hpp"
 
+YASIO__DECL void yssl_session_free(yssl_session_st* session)
+{
+  ::mbedtls_ssl_session_free(session);
+  delete session;
+}
+YASIO__DECL void yssl_save_session(yssl_st* ssl)
+{
+  auto session = new yssl_session_st();
+  ::mbedtls_ssl_session_init(session);
+  if (::mbedtls_ssl_get_session(ssl, session) == 0)
+    ssl->sessions->put(ssl->key, session);
+  else
+    yssl_session_free(session);
+}
+
 YASIO__DECL yssl_ctx_st* yssl_ctx_new(const yssl_options& opts)
 {
-  auto ctx = new yssl_ctx_st();
+  auto ctx       = new yssl_ctx_st();
+  ctx->pool_size = opts.pool_size_;
   ::mbedtls_ctr_drbg_init(&ctx->ctr_drbg);
   ::mbedtls_entropy_init(&ctx->entropy);
   ::mbedtls_ssl_config_init(&ctx->conf);
@@ -83,6 +99,18 @@ YASIO__DECL yssl_ctx_st* yssl_ctx_new(const yssl_options& opts)
     {
       ::mbedtls_ssl_conf_authmode(&ctx->conf, authmode);
       ::mbedtls_ssl_conf_ca_chain(&ctx->conf, &ctx->cert, nullptr);
+      // the early data(0-RTT) not implemented yet, only resume sessions
+      if (opts.session_cache_size_ > 0)
+      {
+#  if defined(MBEDTLS_SSL_SESSION_TICKETS)
+        ::mbedtls_ssl_conf_session_tickets(&ctx->conf, MBEDTLS_SSL_SESSION_TICKETS_ENABLED);
+#  endif
+#  if defined(MBEDTLS_SSL_PROTO_TLS1_3) && defined(MBEDTLS_SSL_SESSION_TICKETS) && defined(MBEDTLS_SSL_TLS1_3_SIGNAL_NEW_SESSION_TICKETS_ENABLED)
+        // since 3.6.1 the TLS 1.3 tickets are ignored by default, 3.6.0 always signals them by yssl_read
+        ::mbedtls_ssl_conf_tls13_enable_signal_new_session_tickets(&ctx->conf, MBEDTLS_SSL_TLS1_3_SIGNAL_NEW_SESSION_TICKETS_ENABLED);
+#  endif
+        ctx->sessions = new yssl_session_cache(opts.session_cache_size_, false);
+      }
     }
     else
     {
@@ -121,6 +149,12 @@ YASIO__DECL void yssl_ctx_free(yssl_ctx_st*& ctx)
   ::mbedtls_ssl_config_free(&ctx->conf);
   ::mbedtls_entropy_free(&ctx->entropy);
   ::mbedtls_ctr_drbg_free(&ctx->ctr_drbg);
+  delete ctx->sessions;
+  for (auto ssl : ctx->pool)
+  {
+    ::mbedtls_ssl_free(ssl);
+    delete ssl;
+  }
 
   delete ctx;
   ctx = nullptr;
@@ -164,17 +198,40 @@ YASIO__DECL int yssl_mbedtls_send(void* ctx, const unsigned char* buf, size_t le
   return ret;
 }
 
-YASIO__DECL yssl_st* yssl_new(yssl_ctx_st* ctx, int fd, const char* hostname, bool client)
+YASIO__DECL yssl_st* yssl_new(yssl_ctx_st* ctx, int fd, const char* hostname, unsigned short port, bool client)
 {
-  auto ssl = new yssl_st();
-  ::mbedtls_ssl_init(ssl);
-  ::mbedtls_ssl_setup(ssl, &ctx->conf);
+  yssl_st* ssl;
+  if (!ctx->pool.empty())
+  { // the pooled ssl was reset by mbedtls_ssl_session_reset, the setup and bio retained
+    ssl = ctx->pool.back();
+    ctx->pool.pop_back();
+  }
+  else
+  {
+    ssl = new yssl_st();
+    ::mbedtls_ssl_init(ssl);
+    ::mbedtls_ssl_setup(ssl, &ctx->conf);
+    ssl->owner = ctx;
+    ::mbedtls_ssl_set_bio(ssl, &ssl->bio, ::yssl_mbedtls_send, ::mbedtls_net_recv, nullptr /*  rev_timeout() */);
+  }
 
   // ssl_set_fd
   ssl->bio.fd = fd;
-  ::mbedtls_ssl_set_bio(ssl, &ssl->bio, ::yssl_mbedtls_send, ::mbedtls_net_recv, nullptr /*  rev_timeout() */);
   if (client)
+  {
     ::mbedtls_ssl_set_hostname(ssl, hostname);
+    if (ctx->sessions)
+    {
+      ssl->sessions = ctx->sessions;
+      ssl->key.append(hostname).push_back(':');
+      ssl->key.append(std::to_string(port));
+      // mbedtls copies the session, keep it cached for TLS 1.2 session ids
+      auto session = ctx->sessions->take(ssl->key, false);
+      ssl->offered = session && ::mbedtls_ssl_set_session(ssl, session) == 0;
+      if (ssl->offered)
+        ssl->offered_id.assign(reinterpret_cast<const char*>(session->id), session->id_len);
+    }
+  }
   return ssl;
 }
 YASIO__DECL void yssl_shutdown(yssl_st*& ssl, bool writable)
@@ -184,10 +241,47 @@ YASIO__DECL void yssl_shutdown(yssl_st*& ssl, bool writable)
   // to socket.send to avoid SIGPIPE, see also: yssl_mbedtls_send
   if (writable)
     ::mbedtls_ssl_close_notify(ssl);
+  auto ctx = ssl->owner;
+  if (static_cast<int>(ctx->pool.size()) < ctx->pool_size && ::mbedtls_ssl_session_reset(ssl) == 0)
+  {
+    ssl->key.clear();
+    ssl->offered_id.clear();
+    ssl->offered = false;
+    ssl->resumed = 0;
+    ctx->pool.push_back(ssl);
+  }
+  else
+  {
+    ::mbedtls_ssl_free(ssl);
+    delete ssl;
+  }
+  ssl = nullptr;
+}
+YASIO__DECL void yssl_free(yssl_st*& ssl)
+{
   ::mbedtls_ssl_free(ssl);
   delete ssl;
   ssl = nullptr;
 }
+/*
+** Detects resumption by the negotiated session, the handshake params are private to mbedtls:
+**   TLS 1.2: the server echoes the offered session id only when resuming
+**   TLS 1.3: the legacy session id is always echoed, a server fallback to full handshake can't be
+**            told apart from the psk accepted, so reported as unknown(-1)
+*/
+YASIO__DECL int yssl_resumed_session(yssl_st* ssl)
+{
+  if (!ssl->offered)
+    return 0;
+#  if defined(MBEDTLS_SSL_PROTO_TLS1_3)
+  if (ssl->session->tls_version == MBEDTLS_SSL_VERSION_TLS1_3)
+    return -1;
+#  endif
+  return !ssl->offered_id.empty() && ssl->session->id_len == ssl->offered_id.size() &&
+                 ::memcmp(ssl->session->id, ssl->offered_id.data(), ssl->offered_id.size()) == 0
+             ? 1
+             : 0;
+}
 YASIO__DECL int yssl_do_handshake(yssl_st* ssl, int& err)
 {
   int ret = ::mbedtls_ssl_handshake_step(ssl);
@@ -195,7 +289,12 @@ YASIO__DECL int yssl_do_handshake(yssl_st* ssl, int& err)
   {
     case 0:
       if (ssl->state == MBEDTLS_SSL_HANDSHAKE_OVER)
+      {
+        ssl->resumed = yssl_resumed_session(ssl);
+        if (ssl->sessions)
+          yssl_save_session(ssl);
         return 0;
+      }
       err = EWOULDBLOCK;
       ret = -1;
       break;
@@ -210,6 +309,8 @@ YASIO__DECL int yssl_do_handshake(yssl_st* ssl, int& err)
   }
   return ret;
 }
+// the handshake step returns MBEDTLS_ERR_SSL_WANT_WRITE when the flight not flushed
+YASIO__DECL bool yssl_want_write(yssl_st* ssl) { return ssl->out_left > 0; }
 const char* yssl_strerror(yssl_st* ssl, int sslerr, char* buf, size_t buflen)
 {
   int n = snprintf(buf, buflen, "error:%d:", sslerr);
@@ -245,6 +346,14 @@ YASIO__DECL int yssl_read(yssl_st* ssl, void* data, size_t len, int& err)
       err = yasio::xxsocket::get_last_errno();
       ::mbedtls_ssl_close_notify(ssl);
       break;
+#  if defined(MBEDTLS_ERR_SSL_RECEIVED_NEW_SESSION_TICKET)
+    case MBEDTLS_ERR_SSL_RECEIVED_NEW_SESSION_TICKET: // TLS 1.3 ticket arrives after handshake
+      if (ssl->sessions)
+        yssl_save_session(ssl);
+      n = -1;
+      err = EWOULDBLOCK;
+      break;
+#  endif
     case MBEDTLS_ERR_SSL_WANT_READ:
     case MBEDTLS_ERR_SSL_WANT_WRITE:
       err = EWOULDBLOCK;
@@ -254,6 +363,11 @@ YASIO__DECL int yssl_read(yssl_st* ssl, void* data, size_t len, int& err)
   }
   return n;
 }
+YASIO__DECL int yssl_session_reused(yssl_st* ssl) { return ssl->resumed; }
+YASIO__DECL bool yssl_early_writable(yssl_st* /*ssl*/) { return false; }
+YASIO__DECL bool yssl_early_data_accepted(yssl_st* /*ssl*/) { return false; }
+YASIO__DECL bool yssl_ktls_send(yssl_st* /*ssl*/) { return false; }
+YASIO__DECL bool yssl_ktls_recv(yssl_st* /*ssl*/) { return false; }
 
 #endif
 
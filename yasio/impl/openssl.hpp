@@ -36,17 +36,74 @@ SOFTWARE.
 // The ssl error mask (1 << 31), a little hack, but works
 #  define YSSL_ERR_MASK 0x80000000
 
+#  if OPENSSL_VERSION_NUMBER >= 0x10101000L
+#    define YSSL_HAVE_EARLY_DATA 1
+#  else
+#    define YSSL_HAVE_EARLY_DATA 0
+#  endif
+
+#  if defined(SSL_OP_ENABLE_KTLS) && !defined(OPENSSL_NO_KTLS)
+#    define YSSL_HAVE_KTLS 1
+#  else
+#    define YSSL_HAVE_KTLS 0
+#  endif
+
+// The socket BIO of kTLS doesn't send with MSG_NOSIGNAL, the SIGPIPE raised by ssl calls is discarded,
+// BSDs needn't it since the socket was set SO_NOSIGPIPE
+#  if YSSL_HAVE_KTLS && defined(__linux__)
+#    define YSSL_SIGPIPE_GUARD(ssl) yasio::inet::sigpipe_guard sigpipe_guard_((ssl)->sock_bio)
+#  else
+#    define YSSL_SIGPIPE_GUARD(ssl) (void)0
+#  endif
+
+// The early data(0-RTT) states of client
+#  define YSSL_EARLY_NONE 0    // not allowed, or handshake started without early data
+#  define YSSL_EARLY_READY 1   // the resumed session allows early data, handshake not started yet
+#  define YSSL_EARLY_WRITTEN 2 // early data sent, wait handshake finished
+#  define YSSL_EARLY_REPLAY 3  // early data rejected by server, needs replay
+
+// The data of context, stored as app data of SSL_CTX
+struct yssl_ctx_data {
+  yssl_session_cache* sessions; // client only, nullptr: session resumption disabled
+  BIO_METHOD* bmth;             // the BIO method shared by all ssl of context
+  std::vector<yssl_st*> pool;   // the closed ssl objects for reuse, all ssl of one context created & freed at io thread
+  size_t pool_size;
+};
+#  define yssl_ctx_data_of(ctx) static_cast<yssl_ctx_data*>(SSL_CTX_get_app_data(ctx))
+
+YASIO__DECL void yssl_session_free(yssl_session_st* session) { ::SSL_SESSION_free(session); }
+YASIO__DECL int yssl_new_session_cb(SSL* ssl, SSL_SESSION* session)
+{ // with TLS 1.3, the tickets arrive after handshake finished
+  auto yssl     = static_cast<yssl_st*>(SSL_get_app_data(ssl));
+  auto sessions = yssl_ctx_data_of(::SSL_get_SSL_CTX(ssl))->sessions;
+  if (!yssl || !sessions)
+    return 0;
+  sessions->put(yssl->key, session);
+  return 1; // we take the reference of session
+}
+YASIO__DECL BIO_METHOD* yssl_bio_method_create(void);
+
 YASIO__DECL yssl_ctx_st* yssl_ctx_new(const yssl_options& opts)
 {
   auto ctx = ::SSL_CTX_new(opts.client ? ::SSLv23_client_method() : SSLv23_server_method());
 
+  auto data = new yssl_ctx_data{nullptr, yssl_bio_method_create(), {}, static_cast<size_t>((std::max)(opts.pool_size_, 0))};
+  SSL_CTX_set_app_data(ctx, data);
+
   auto mode = SSL_CTX_get_mode(ctx);
 #  if defined(SSL_MODE_RELEASE_BUFFERS)
-  mode |= SSL_MODE_RELEASE_BUFFERS;
+  // the idle connections hold no record buffers, but each read and write allocates them again
+  if (opts.release_buffers_)
+    mode |= SSL_MODE_RELEASE_BUFFERS;
 #  endif
 
   ::SSL_CTX_set_mode(ctx, SSL_MODE_ENABLE_PARTIAL_WRITE | mode);
 
+#  if YSSL_HAVE_KTLS
+  if (opts.ktls_) // fallback to user space crypto silently if kernel or cipher unsupported
+    ::SSL_CTX_set_options(ctx, SSL_OP_ENABLE_KTLS);
+#  endif
+
   if (opts.client)
   {
     int fail_count = -1;
@@ -90,6 +147,13 @@ YASIO__DECL yssl_ctx_st* yssl_ctx_new(const yssl_options& opts)
     }
     else
       ::SSL_CTX_set_verify(ctx, SSL_VERIFY_NONE, nullptr);
+
+    if (opts.session_cache_size_ > 0)
+    { // the internal store is server only, the client sessions are cached by host:port
+      ::SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+      ::SSL_CTX_sess_set_new_cb(ctx, yssl_new_session_cb);
+      data->sessions = new yssl_session_cache(opts.session_cache_size_, opts.early_data_);
+    }
   }
   else
   {
@@ -113,6 +177,17 @@ YASIO__DECL yssl_ctx_st* yssl_ctx_new(const yssl_options& opts)
 
 YASIO__DECL void yssl_ctx_free(yssl_ctx_st*& ctx)
 {
+  if (!ctx)
+    return;
+  auto data = yssl_ctx_data_of(ctx);
+  for (auto yssl : data->pool)
+  {
+    ::SSL_free(yssl_unwrap(yssl));
+    delete yssl;
+  }
+  delete data->sessions;
+  ::BIO_meth_free(data->bmth);
+  delete data;
   ::SSL_CTX_free((SSL_CTX*)ctx);
   ctx = nullptr;
 }
@@ -204,36 +279,136 @@ YASIO__DECL BIO_METHOD* yssl_bio_method_create(void)
   }
   return m;
 }
-YASIO__DECL yssl_st* yssl_new(yssl_ctx_st* ctx, int fd, const char* hostname, bool client)
+YASIO__DECL void yssl_resume_session(yssl_st* yssl, yssl_session_cache* sessions)
 {
-  auto ssl  = ::SSL_new(ctx);
-  auto yssl = new yssl_st{ssl, fd, yssl_bio_method_create()};
-  auto bio  = ::BIO_new(yssl->bmth);
-  ::BIO_set_data(bio, yssl);
-  ::SSL_set_bio(ssl, bio, bio);
+  auto session = sessions->take(yssl->key, false);
+  if (!session)
+    return;
+  ::SSL_set_session(yssl_unwrap(yssl), session);
+#  if YSSL_HAVE_EARLY_DATA
+  if (sessions->early_data_ && ::SSL_SESSION_get_max_early_data(session) > 0)
+    yssl->early_state = YSSL_EARLY_READY;
+  // The TLS 1.3 tickets should be used once, the server will send new ones
+  if (::SSL_SESSION_get_protocol_version(session) >= TLS1_3_VERSION)
+  {
+    sessions->take(yssl->key, true);
+    ::SSL_SESSION_free(session);
+  }
+#  endif
+}
+YASIO__DECL yssl_st* yssl_new(yssl_ctx_st* ctx, int fd, const char* hostname, unsigned short port, bool client)
+{
+  auto data = yssl_ctx_data_of(ctx);
+  yssl_st* yssl;
+  SSL* ssl;
+  if (!data->pool.empty())
+  { // the pooled ssl keeps its BIO which refers to the yssl_st
+    yssl = data->pool.back();
+    data->pool.pop_back();
+    ssl               = yssl_unwrap(yssl);
+    yssl->fd          = fd;
+    yssl->early_state = YSSL_EARLY_NONE;
+  }
+  else
+  {
+    ssl  = ::SSL_new(ctx);
+    yssl = new yssl_st{ssl, fd, false, {}, YSSL_EARLY_NONE, {}};
+#  if YSSL_HAVE_KTLS
+    if (::SSL_get_options(ssl) & SSL_OP_ENABLE_KTLS)
+    {
+      yssl->sock_bio = true;
+      ::SSL_set_fd(ssl, fd); // the kTLS only works with socket BIO, note: the ssl calls need YSSL_SIGPIPE_GUARD
+    }
+    else
+#  endif
+    {
+      auto bio = ::BIO_new(data->bmth);
+      ::BIO_set_data(bio, yssl);
+      ::SSL_set_bio(ssl, bio, bio);
+    }
+  }
   if (client)
   {
     ::SSL_set_connect_state(ssl);
     ::SSL_set_tlsext_host_name(ssl, hostname);
+
+    auto sessions = data->sessions;
+    if (sessions)
+    {
+      yssl->key.append(hostname).push_back(':');
+      yssl->key.append(std::to_string(port));
+      SSL_set_app_data(ssl, yssl);
+      yssl_resume_session(yssl, sessions);
+    }
   }
   else
     ::SSL_set_accept_state(ssl);
   return yssl;
 }
+YASIO__DECL bool yssl_reusable(yssl_st* ssl)
+{
+  if (ssl->sock_bio) // the socket BIO bound to closed fd, and the kTLS state can't be reset
+    return false;
+#  if YSSL_HAVE_EARLY_DATA
+  // SSL_clear doesn't reset the record layer state of early data
+  if (::SSL_get_early_data_status(yssl_unwrap(ssl)) != SSL_EARLY_DATA_NOT_SENT)
+    return false;
+#  endif
+  return true;
+}
 YASIO__DECL void yssl_shutdown(yssl_st*& ssl, bool /*writable*/)
 {
-  ::SSL_shutdown(yssl_unwrap(ssl));
+  auto s    = yssl_unwrap(ssl);
+  auto data = yssl_ctx_data_of(::SSL_get_SSL_CTX(s));
+  {
+    YSSL_SIGPIPE_GUARD(ssl);
+    ::SSL_shutdown(s);
+  }
+  if (data->pool.size() < data->pool_size && yssl_reusable(ssl) && ::SSL_clear(s) == 1)
+  {
+    ::SSL_set_session(s, nullptr); // SSL_clear keeps the session of last peer
+    ssl->key.clear();
+    ssl->early_data.clear();
+    data->pool.push_back(ssl);
+  }
+  else
+  {
+    ::SSL_free(s);
+    delete ssl;
+  }
+  ssl = nullptr;
+}
+YASIO__DECL void yssl_free(yssl_st*& ssl)
+{
   ::SSL_free(yssl_unwrap(ssl));
-  if (ssl->bmth)
-    ::BIO_meth_free(ssl->bmth);
   delete ssl;
+  ssl = nullptr;
 }
 YASIO__DECL int yssl_do_handshake(yssl_st* ssl, int& err)
 {
   ERR_clear_error();
+#  if YSSL_HAVE_EARLY_DATA
+  if (ssl->early_state == YSSL_EARLY_READY) // no more early data once handshake continued
+    ssl->early_state = ssl->early_data.empty() ? YSSL_EARLY_NONE : YSSL_EARLY_WRITTEN;
+#  endif
+  YSSL_SIGPIPE_GUARD(ssl);
   int ret = ::SSL_do_handshake(yssl_unwrap(ssl));
-  if (ret == 1) // handshake succeed
+  if (ret == 1)
+  { // handshake succeed
+#  if YSSL_HAVE_EARLY_DATA
+    if (ssl->early_state == YSSL_EARLY_WRITTEN)
+    {
+      if (::SSL_get_early_data_status(yssl_unwrap(ssl)) == SSL_EARLY_DATA_ACCEPTED)
+      {
+        ssl->early_state = YSSL_EARLY_NONE;
+        ssl->early_data.clear();
+      }
+      else
+        ssl->early_state = YSSL_EARLY_REPLAY;
+    }
+#  endif
     return 0;
+  }
 
   int sslerr = ::SSL_get_error(yssl_unwrap(ssl), ret);
   /*
@@ -250,6 +425,7 @@ YASIO__DECL int yssl_do_handshake(yssl_st* ssl, int& err)
   err = yasio::errc::ssl_handshake_failed; // emit ssl handshake failed, continue handle close flow
   return (sslerr != SSL_ERROR_SYSCALL) ? static_cast<int>(ERR_get_error() | YSSL_ERR_MASK) : yasio::xxsocket::get_last_errno();
 }
+YASIO__DECL bool yssl_want_write(yssl_st* ssl) { return SSL_want_write(yssl_unwrap(ssl)); }
 YASIO__DECL const char* yssl_strerror(yssl_st* /*ssl*/, int sslerr, char* buf, size_t buflen)
 {
   if (yasio__testbits(sslerr, YSSL_ERR_MASK))
@@ -258,9 +434,73 @@ YASIO__DECL const char* yssl_strerror(yssl_st* /*ssl*/, int sslerr, char* buf, s
     yasio::xxsocket::strerror_r(sslerr, buf, buflen);
   return buf;
 }
+#  if YSSL_HAVE_EARLY_DATA
+YASIO__DECL int yssl_write_error(yssl_st* ssl, int n, int& err)
+{
+  switch (::SSL_get_error(yssl_unwrap(ssl), n))
+  {
+    case SSL_ERROR_WANT_READ:
+    case SSL_ERROR_WANT_WRITE:
+      err = EWOULDBLOCK;
+      break;
+    default:
+      err = yasio::errc::ssl_write_failed;
+  }
+  return -1;
+}
+/*
+** Write early data before handshake finished, or replay the early data rejected by server,
+** returns 0 when the normal write can go on.
+*/
+YASIO__DECL int yssl_write_early(yssl_st* ssl, const void* data, size_t len, int& err)
+{
+  auto s = yssl_unwrap(ssl);
+  switch (ssl->early_state)
+  {
+    case YSSL_EARLY_READY: {
+      size_t room    = ::SSL_SESSION_get_max_early_data(::SSL_get0_session(s)) - ssl->early_data.size();
+      size_t written = 0;
+      if (!room || !len)
+      {
+        err = EWOULDBLOCK;
+        return -1;
+      }
+      if (::SSL_write_early_data(s, data, (std::min)(len, room), &written) != 1)
+        return yssl_write_error(ssl, 0, err);
+      ssl->early_data.append(static_cast<const char*>(data), written);
+      return static_cast<int>(written);
+    }
+    case YSSL_EARLY_WRITTEN:
+      err = EWOULDBLOCK;
+      return -1;
+    case YSSL_EARLY_REPLAY:
+      while (!ssl->early_data.empty())
+      {
+        int n = ::SSL_write(s, ssl->early_data.data(), static_cast<int>(ssl->early_data.size()));
+        if (n <= 0)
+          return yssl_write_error(ssl, n, err);
+        ssl->early_data.erase(0, n);
+      }
+      ssl->early_state = YSSL_EARLY_NONE;
+      break;
+  }
+  return 0;
+}
+#  endif
 YASIO__DECL int yssl_write(yssl_st* ssl, const void* data, size_t len, int& err)
 {
   ERR_clear_error();
+  YSSL_SIGPIPE_GUARD(ssl);
+#  if YSSL_HAVE_EARLY_DATA
+  if (yasio__unlikely(ssl->early_state != YSSL_EARLY_NONE))
+  {
+    int n = yssl_write_early(ssl, data, len, err);
+    if (n != 0)
+      return n;
+  }
+#  endif
+  if (!len)
+    return 0;
   int n = ::SSL_write(yssl_unwrap(ssl), data, static_cast<int>(len));
   if (n > 0)
     return n;
@@ -285,6 +525,7 @@ YASIO__DECL int yssl_write(yssl_st* ssl, const void* data, size_t len, int& err)
 YASIO__DECL int yssl_read(yssl_st* ssl, void* data, size_t len, int& err)
 {
   ERR_clear_error();
+  YSSL_SIGPIPE_GUARD(ssl); // the ssl may send alerts or key update while reading
   int n = ::SSL_read(yssl_unwrap(ssl), data, static_cast<int>(len));
   if (n > 0)
     return n;
@@ -305,6 +546,39 @@ YASIO__DECL int yssl_read(yssl_st* ssl, void* data, size_t len, int& err)
   }
   return -1;
 }
+YASIO__DECL int yssl_session_reused(yssl_st* ssl) { return ::SSL_session_reused(yssl_unwrap(ssl)) == 1 ? 1 : 0; }
+YASIO__DECL bool yssl_early_writable(yssl_st* ssl)
+{
+#  if YSSL_HAVE_EARLY_DATA
+  return ssl->early_state == YSSL_EARLY_READY && ssl->early_data.size() < ::SSL_SESSION_get_max_early_data(::SSL_get0_session(yssl_unwrap(ssl)));
+#  else
+  return false;
+#  endif
+}
+YASIO__DECL bool yssl_early_data_accepted(yssl_st* ssl)
+{
+#  if YSSL_HAVE_EARLY_DATA
+  return ::SSL_get_early_data_status(yssl_unwrap(ssl)) == SSL_EARLY_DATA_ACCEPTED;
+#  else
+  return false;
+#  endif
+}
+YASIO__DECL bool yssl_ktls_send(yssl_st* ssl)
+{
+#  if YSSL_HAVE_KTLS
+  return ssl->sock_bio && BIO_get_ktls_send(::SSL_get_wbio(yssl_unwrap(ssl)));
+#  else
+  return false;
+#  endif
+}
+YASIO__DECL bool yssl_ktls_recv(yssl_st* ssl)
+{
+#  if YSSL_HAVE_KTLS
+  return ssl->sock_bio && BIO_get_ktls_recv(::SSL_get_rbio(yssl_unwrap(ssl)));
+#  else
+  return false;
+#  endif
+}
 #endif
 
 #endif
@@ -60,6 +60,8 @@ public:
 
   int max_descriptor() const { return -1; }
 
+  int pollable_descriptor() const { return -1; }
+
 protected:
   int to_underlying_events(int events)
   {
@@ -86,6 +86,8 @@ public:
 
   int max_descriptor() const { return max_descriptor_; }
 
+  int pollable_descriptor() const { return -1; }
+
 protected:
   enum
   {
@@ -0,0 +1,202 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// A multi-platform support c++11 library with focus on asynchronous socket I/O for any
+// client application.
+//////////////////////////////////////////////////////////////////////////////////////////
+/*
+The MIT License (MIT)
+
+Copyright (c) 2012-2024 HALX99
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef YASIO__STREAM_VBYTE_HPP
+#define YASIO__STREAM_VBYTE_HPP
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "yasio/endian_portable.hpp"
+
+#if defined(YASIO_LITTLE_ENDIAN)
+#  if defined(__SSSE3__) || defined(__AVX__)
+#    include <tmmintrin.h>
+#    define YASIO__SVB_SSSE3 1
+#  elif defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+// not enabled by compiler flags, the ssse3 kernel is compiled for target ssse3 and selected by cpuid at runtime
+#    include <tmmintrin.h>
+#    include "yasio/impl/cpuid.hpp"
+#    define YASIO__SVB_SSSE3 1
+#    define YASIO__SVB_DISPATCH 1
+#  elif defined(__aarch64__) || defined(_M_ARM64)
+#    include <arm_neon.h>
+#    define YASIO__SVB_NEON 1
+#  endif
+#endif
+
+#if defined(YASIO__SVB_DISPATCH)
+#  define YASIO__SVB_TARGET YASIO__TARGET("ssse3")
+#else
+#  define YASIO__SVB_TARGET
+#endif
+
+/*
+** Stream VByte codec of uint32 arrays, see: https://arxiv.org/abs/1709.08990
+** layout: control bytes with 2 bits (length - 1) per value, then 1~4 data bytes per value in little endian.
+*/
+namespace yasio
+{
+namespace detail
+{
+inline size_t svb_control_size(size_t count) { return (count + 3) / 4; }
+
+inline int svb_value_len(uint32_t v) { return v < (1u << 8) ? 1 : (v < (1u << 16) ? 2 : (v < (1u << 24) ? 3 : 4)); }
+
+inline size_t svb_encoded_size(const uint32_t* in, size_t count)
+{
+  size_t size = svb_control_size(count);
+  for (size_t i = 0; i < count; ++i)
+    size += svb_value_len(in[i]);
+  return size;
+}
+
+// The out must have svb_encoded_size bytes
+inline void svb_encode(const uint32_t* in, size_t count, uint8_t* out)
+{
+  uint8_t* ctrl = out;
+  uint8_t* data = out + svb_control_size(count);
+  uint8_t key   = 0;
+  int shift     = 0;
+  for (size_t i = 0; i < count; ++i)
+  {
+    auto v   = in[i];
+    auto len = svb_value_len(v);
+    data[0]  = static_cast<uint8_t>(v);
+    if (len > 1)
+    {
+      data[1] = static_cast<uint8_t>(v >> 8);
+      if (len > 2)
+      {
+        data[2] = static_cast<uint8_t>(v >> 16);
+        if (len > 3)
+          data[3] = static_cast<uint8_t>(v >> 24);
+      }
+    }
+    data += len;
+    key |= static_cast<uint8_t>((len - 1) << shift);
+    if ((shift += 2) == 8)
+    {
+      *ctrl++ = key;
+      key     = 0;
+      shift   = 0;
+    }
+  }
+  if (shift)
+    *ctrl = key;
+}
+
+#if defined(YASIO__SVB_SSSE3) || defined(YASIO__SVB_NEON)
+struct svb_tables {
+  uint8_t lengths[256];
+  alignas(16) uint8_t shuffles[256][16];
+
+  svb_tables()
+  {
+    for (int key = 0; key < 256; ++key)
+    {
+      uint8_t offset = 0;
+      for (int k = 0; k < 4; ++k)
+      {
+        int len = ((key >> (k * 2)) & 3) + 1;
+        for (int b = 0; b < 4; ++b)
+          shuffles[key][k * 4 + b] = b < len ? static_cast<uint8_t>(offset + b) : 0xff; // 0xff: zero the lane byte
+        offset = static_cast<uint8_t>(offset + len);
+      }
+      lengths[key] = offset;
+    }
+  }
+};
+inline const svb_tables& svb_get_tables()
+{
+  static const svb_tables tables;
+  return tables;
+}
+
+// Decodes 4 values per step while a full 16 bytes load is in range, returns the count decoded
+YASIO__SVB_TARGET inline size_t svb_decode_quads(const uint8_t* ctrl, const uint8_t*& data, const uint8_t* end, uint32_t* out,
+                                                 size_t count)
+{
+  auto& tables = svb_get_tables();
+  size_t i     = 0;
+  for (; i + 4 <= count && (end - data) >= 16; i += 4)
+  {
+    uint8_t key = ctrl[i / 4];
+#  if defined(YASIO__SVB_SSSE3)
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+    v         = _mm_shuffle_epi8(v, _mm_load_si128(reinterpret_cast<const __m128i*>(tables.shuffles[key])));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), v);
+#  else
+    uint8x16_t v = vqtbl1q_u8(vld1q_u8(data), vld1q_u8(tables.shuffles[key]));
+    vst1q_u8(reinterpret_cast<uint8_t*>(out + i), v);
+#  endif
+    data += tables.lengths[key];
+  }
+  return i;
+}
+#endif
+
+// Returns consumed bytes, 0 if input truncated
+inline size_t svb_decode(const uint8_t* in, size_t avail, uint32_t* out, size_t count)
+{
+  auto ctrl_size = svb_control_size(count);
+  if (avail < ctrl_size)
+    return 0;
+  const uint8_t* ctrl = in;
+  const uint8_t* data = in + ctrl_size;
+  const uint8_t* end  = in + avail;
+  size_t i            = 0;
+#if defined(YASIO__SVB_SSSE3) || defined(YASIO__SVB_NEON)
+#  if defined(YASIO__SVB_DISPATCH)
+  if (get_cpu_features().ssse3)
+#  endif
+    i = svb_decode_quads(ctrl, data, end, out, count);
+#endif
+  for (; i < count; ++i)
+  {
+    int len = ((ctrl[i / 4] >> ((i % 4) * 2)) & 3) + 1;
+    if ((end - data) < len)
+      return 0;
+    uint32_t v = 0;
+#if defined(YASIO_LITTLE_ENDIAN)
+    if ((end - data) >= 4)
+    { // load 4 bytes and mask out the bytes of next value
+      static const uint32_t masks[4] = {0xffu, 0xffffu, 0xffffffu, 0xffffffffu};
+      ::memcpy(&v, data, sizeof(v));
+      v &= masks[len - 1];
+    }
+    else
+#endif
+    {
+      for (int k = 0; k < len; ++k)
+        v |= static_cast<uint32_t>(data[k]) << (k * 8);
+    }
+    out[i] = v;
+    data += len;
+  }
+  return static_cast<size_t>(data - in);
+}
+} // namespace detail
+} // namespace yasio
+#endif
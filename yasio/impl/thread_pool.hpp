@@ -0,0 +1,105 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// A multi-platform support c++11 library with focus on asynchronous socket I/O for any
+// client application.
+//////////////////////////////////////////////////////////////////////////////////////////
+/*
+The MIT License (MIT)
+
+Copyright (c) 2012-2024 HALX99
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef YASIO__THREAD_POOL_HPP
+#define YASIO__THREAD_POOL_HPP
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "yasio/thread_name.hpp"
+
+namespace yasio
+{
+/*
+** The fixed size worker pool, jobs are run in post order by any idle worker,
+** the queued jobs not started are discarded at stop.
+*/
+class thread_pool {
+public:
+  ~thread_pool() { stop(); }
+
+  void start(int count, const char* name)
+  {
+    stop_flag_ = false;
+    for (int i = 0; i < count; ++i)
+      workers_.emplace_back([this, name] {
+        yasio::set_thread_name(name);
+        run();
+      });
+  }
+  void stop()
+  {
+    {
+      std::lock_guard<std::mutex> lck(mtx_);
+      stop_flag_ = true;
+      jobs_.clear();
+    }
+    cv_.notify_all();
+    for (auto& worker : workers_)
+      worker.join();
+    workers_.clear();
+  }
+  bool running() const { return !workers_.empty(); }
+
+  void post(std::function<void()> job)
+  {
+    {
+      std::lock_guard<std::mutex> lck(mtx_);
+      jobs_.push_back(std::move(job));
+    }
+    cv_.notify_one();
+  }
+
+private:
+  void run()
+  {
+    for (;;)
+    {
+      std::function<void()> job;
+      {
+        std::unique_lock<std::mutex> lck(mtx_);
+        cv_.wait(lck, [this] { return stop_flag_ || !jobs_.empty(); });
+        if (stop_flag_)
+          return;
+        job = std::move(jobs_.front());
+        jobs_.pop_front();
+      }
+      job();
+    }
+  }
+
+  std::vector<std::thread> workers_;
+  std::deque<std::function<void()>> jobs_;
+  std::mutex mtx_;
+  std::condition_variable cv_;
+  bool stop_flag_ = false;
+};
+} // namespace yasio
+#endif
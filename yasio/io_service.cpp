@@ -38,14 +38,34 @@ SOFTWARE.
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#if defined(__linux__)
+#  include <sys/sendfile.h>
+#  if defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY)
+#    include <linux/errqueue.h>
+#    define YASIO__HAS_ZEROCOPY 1
+#  endif
+#elif defined(__APPLE__)
+#  include <sys/uio.h>
+#elif defined(_WIN32)
+#  include <io.h>
+#endif
 #include "yasio/thread_name.hpp"
 
+#if !defined(YASIO__HAS_ZEROCOPY)
+#  define YASIO__HAS_ZEROCOPY 0
+#endif
+
 #if defined(YASIO_SSL_BACKEND)
 #  include "yasio/ssl.hpp"
+#  include "yasio/impl/thread_pool.hpp"
 #endif
 
 #include "yasio/wtimer_hres.hpp"
 
+#if defined(YASIO_ENABLE_KCP)
+#  include "yasio/impl/fec.hpp"
+#endif
+
 #if defined(YASIO_ENABLE_KCP)
 struct yasio_kcp_options {
   int kcp_conv_ = 0;
@@ -61,6 +81,13 @@ struct yasio_kcp_options {
   int kcp_mtu_ = 1400;
   // kcp fast model the RTO min is 30.
   int kcp_minrto_ = 30;
+
+  int kcp_flush_policy_ = 0; // YKFP_IMMEDIATE
+  int kcp_flush_delay_  = 10; // only for YKFP_DEADLINE
+
+  // fec disabled when any of shards is 0
+  int kcp_fec_data_shards_   = 0;
+  int kcp_fec_parity_shards_ = 0;
 };
 #endif
 
@@ -214,6 +241,226 @@ std::chrono::microseconds highp_timer::wait_duration() const
 /// io_send_op
 int io_send_op::perform(io_transport* transport, const void* buf, int n, int& error) { return transport->write_cb_(buf, n, nullptr, error); }
 
+int io_send_op::write_some(io_transport* transport, int& error)
+{
+  if (transport->zerocopy_threshold_ > 0 && buffer_.size() - offset_ >= static_cast<size_t>(transport->zerocopy_threshold_))
+    return transport->write_zerocopy(this, error);
+  return this->perform(transport, buffer_.data() + offset_, static_cast<int>(buffer_.size() - offset_), error);
+}
+
+/// io_send_chain_op
+int io_send_chain_op::write_some(io_transport* transport, int& error)
+{
+  enum
+  {
+    max_gather_count = 64
+  };
+  auto& chunks = chain_.chunks();
+  int n;
+  if (transport->writev_cb_)
+  {
+    cxx17::string_view bufs[max_gather_count];
+    int count = 0;
+    for (auto index = chunk_index_; index < chunks.size() && count < max_gather_count; ++index, ++count)
+      bufs[count] = cxx17::string_view{chunks[index].data, chunks[index].size};
+    bufs[0].remove_prefix(chunk_offset_);
+    n = transport->writev_cb_(bufs, count, error);
+  }
+  else
+  {
+    auto& c = chunks[chunk_index_];
+    n       = this->perform(transport, c.data + chunk_offset_, static_cast<int>(c.size - chunk_offset_), error);
+  }
+  if (n > 0)
+  { // advance the chunk cursor
+    size_t remain = static_cast<size_t>(n);
+    while (remain > 0)
+    {
+      auto avail = chunks[chunk_index_].size - chunk_offset_;
+      if (remain < avail)
+      {
+        chunk_offset_ += remain;
+        break;
+      }
+      remain -= avail;
+      ++chunk_index_;
+      chunk_offset_ = 0;
+    }
+  }
+  return n;
+}
+
+/// io_send_spans_op
+int io_send_spans_op::write_some(io_transport* transport, int& error)
+{
+  enum
+  {
+    max_gather_count = 64
+  };
+  int n;
+  if (transport->writev_cb_)
+  {
+    cxx17::string_view bufs[max_gather_count];
+    int count = 0;
+    for (auto index = span_index_; index < spans_.size() && count < max_gather_count; ++index, ++count)
+      bufs[count] = spans_[index];
+    bufs[0].remove_prefix(span_offset_);
+    n = transport->writev_cb_(bufs, count, error);
+  }
+  else
+  {
+    auto& span = spans_[span_index_];
+    n          = this->perform(transport, span.data() + span_offset_, static_cast<int>(span.size() - span_offset_), error);
+  }
+  if (n > 0)
+  { // advance the span cursor
+    size_t remain = static_cast<size_t>(n);
+    while (remain > 0)
+    {
+      auto avail = spans_[span_index_].size() - span_offset_;
+      if (remain < avail)
+      {
+        span_offset_ += remain;
+        break;
+      }
+      remain -= avail;
+      ++span_index_;
+      span_offset_ = 0;
+    }
+  }
+  return n;
+}
+
+/// io_send_file_op
+enum send_file_mode
+{
+  SFM_UNDETERMINED,
+  SFM_SENDFILE, // regular file to socket
+  SFM_SPLICE,   // pipe to socket
+  SFM_READ,     // read to user space, then write by transport primitive
+  SFM_READ_PIPE,
+};
+int io_send_file_op::write_some(io_transport* transport, int& error)
+{
+  enum
+  {
+    max_io_size = 0x7ffff000, // the max bytes of one sendfile on Linux
+  };
+  if (yasio__unlikely(mode_ == SFM_UNDETERMINED))
+  {
+    bool pipe = false;
+#if !defined(_WIN32)
+    struct stat st;
+    pipe = ::fstat(fd_, &st) == 0 && S_ISFIFO(st.st_mode);
+#endif
+    mode_ = pipe ? SFM_READ_PIPE : SFM_READ;
+    // the gather write primitive present only when the socket written directly, i.e. tcp or kernel tls
+    if (transport->writev_cb_)
+    {
+#if defined(__linux__)
+      mode_ = pipe ? SFM_SPLICE : SFM_SENDFILE;
+#elif defined(__APPLE__)
+      if (!pipe)
+        mode_ = SFM_SENDFILE;
+#endif
+    }
+  }
+
+  auto remain = (std::min)(length_ - offset_, static_cast<size_t>(max_io_size));
+  auto sockfd = transport->socket_->native_handle();
+  int n       = -1;
+  switch (mode_)
+  {
+#if defined(__linux__)
+    case SFM_SENDFILE: { // sendfile and splice can't send with MSG_NOSIGNAL
+      sigpipe_guard guard;
+      off_t off = static_cast<off_t>(file_offset_);
+      n         = static_cast<int>(::sendfile(sockfd, fd_, &off, remain));
+      break;
+    }
+    case SFM_SPLICE: {
+      sigpipe_guard guard;
+      n = static_cast<int>(::splice(fd_, nullptr, sockfd, nullptr, remain, SPLICE_F_MOVE | SPLICE_F_NONBLOCK));
+      break;
+    }
+#elif defined(__APPLE__)
+    case SFM_SENDFILE: {
+      off_t len = static_cast<off_t>(remain);
+      // the partial sent of non-blocking socket fails with EAGAIN, and the bytes sent stored at len
+      if (::sendfile(fd_, sockfd, static_cast<off_t>(file_offset_), &len, nullptr, 0) == 0 || len > 0)
+        n = static_cast<int>(len);
+      break;
+    }
+#endif
+    default:
+      if (chunk_offset_ == chunk_.size() && read_chunk(error) < 0)
+      {
+        if (mode_ == SFM_READ_PIPE && (error == EAGAIN || error == EWOULDBLOCK))
+          transport->watch_source(fd_);
+        return -1;
+      }
+      transport->unwatch_source();
+      n = this->perform(transport, chunk_.data() + chunk_offset_, static_cast<int>(chunk_.size() - chunk_offset_), error);
+      if (n > 0)
+        chunk_offset_ += n;
+      return n;
+  }
+  if (n > 0)
+  {
+    file_offset_ += n;
+    if (mode_ == SFM_SPLICE)
+      transport->unwatch_source();
+  }
+  else if (n == 0)
+  { // the file is shorter than the range, or the write end of pipe closed
+    error = yasio::errc::eof;
+    n     = -1;
+  }
+  else
+  {
+    error = xxsocket::get_last_errno();
+    if ((error == EINVAL || error == ENOSYS) && mode_ == SFM_SENDFILE)
+    { // the file doesn't support sendfile, e.g. some special files
+      mode_ = SFM_READ;
+      return this->write_some(transport, error);
+    }
+#if defined(__linux__)
+    int avail = 0;
+    if (error == EAGAIN && mode_ == SFM_SPLICE && ::ioctl(fd_, FIONREAD, &avail) == 0 && avail == 0)
+      transport->watch_source(fd_); // the pipe is empty rather than the socket full
+#endif
+  }
+  return n;
+}
+int io_send_file_op::read_chunk(int& error)
+{
+  enum
+  {
+    max_chunk_size = YASIO_SZ(64, k),
+  };
+  chunk_.resize((std::min)(length_ - offset_, static_cast<size_t>(max_chunk_size)));
+  chunk_offset_ = 0;
+  int n         = -1;
+#if defined(_WIN32)
+  if (::_lseeki64(fd_, file_offset_, SEEK_SET) != -1)
+    n = ::_read(fd_, chunk_.data(), static_cast<unsigned int>(chunk_.size()));
+#else
+  if (mode_ == SFM_READ_PIPE)
+    n = static_cast<int>(::read(fd_, chunk_.data(), chunk_.size()));
+  else
+    n = static_cast<int>(::pread(fd_, chunk_.data(), chunk_.size(), static_cast<off_t>(file_offset_)));
+#endif
+  if (n > 0)
+  {
+    chunk_.resize(n);
+    file_offset_ += n;
+    return n;
+  }
+  chunk_.clear();
+  error = n == 0 ? yasio::errc::eof : xxsocket::get_last_errno();
+  return -1;
+}
+
 /// io_sendto_op
 int io_sendto_op::perform(io_transport* transport, const void* buf, int n, int& error)
 {
@@ -371,10 +618,75 @@ io_transport::io_transport(io_channel* ctx, xxsocket_ptr&& s) : ctx_(ctx)
 const print_fn2_t& io_transport::__get_cprint() const { return ctx_->get_service().options_.print_; }
 int io_transport::write(io_send_buffer&& buffer, completion_cb_t&& handler)
 {
-  int n = static_cast<int>(buffer.size());
-  send_queue_.emplace(cxx14::make_unique<io_send_op>(std::move(buffer), std::move(handler)));
-  get_service().wakeup();
-  return n;
+  return enqueue(cxx14::make_unique<io_send_op>(std::move(buffer), std::move(handler)));
+}
+int io_transport::write_chain(chunked_buffer&& chain, completion_cb_t&& handler)
+{
+  return enqueue(cxx14::make_unique<io_send_chain_op>(std::move(chain), std::move(handler)));
+}
+int io_transport::write_spans(const cxx17::string_view* spans, int count, completion_cb_t&& handler)
+{
+  return enqueue(cxx14::make_unique<io_send_spans_op>(spans, count, std::move(handler)));
+}
+int io_transport::write_file(int fd, long long offset, size_t length, completion_cb_t&& handler)
+{
+  return enqueue(cxx14::make_unique<io_send_file_op>(fd, offset, length, std::move(handler)));
+}
+int io_transport::enqueue(send_op_ptr&& op)
+{
+  auto& limits = ctx_->sqparams_;
+  size_t bytes = op->size();
+  // the empty queue always accepts, otherwise an op exceeds the high watermark alone never sent
+  if (queued_ops_ > 0 && ((limits.high_bytes > 0 && queued_bytes_ + bytes > static_cast<size_t>(limits.high_bytes)) ||
+                          (limits.high_ops > 0 && queued_ops_ + 1 > limits.high_ops)))
+  {
+    if (limits.high_bytes > 0 && bytes > static_cast<size_t>(limits.high_bytes) && limits.policy == YSQP_REJECT)
+      blocked_ = blocked_drain; // the oversized op only fits the empty queue, so writable until drained
+    else
+    {
+      uint8_t expected = 0;
+      blocked_.compare_exchange_strong(expected, blocked_low);
+    }
+    if (limits.policy == YSQP_REJECT)
+      return yasio::errc::send_queue_full;
+  }
+  queued_bytes_ += bytes;
+  ++queued_ops_;
+  send_queue_.emplace(std::move(op));
+  return static_cast<int>((std::min)(bytes, static_cast<size_t>((std::numeric_limits<int>::max)())));
+}
+void io_transport::release_op(io_send_op* op)
+{
+  queued_bytes_ -= op->size();
+  --queued_ops_;
+}
+void io_transport::check_watermarks()
+{
+  auto& limits = ctx_->sqparams_;
+  if (limits.policy == YSQP_DROP_OLDEST)
+  { // the op partial sent can't be dropped, otherwise the stream corrupted
+    // the last queued op is the one just accepted, never drop it
+    while (queued_ops_ > 1 && ((limits.high_bytes > 0 && queued_bytes_ > static_cast<size_t>(limits.high_bytes)) ||
+                               (limits.high_ops > 0 && queued_ops_ > limits.high_ops)))
+    {
+      auto wrap = send_queue_.peek();
+      if (!wrap || (*wrap)->offset_ != 0)
+        break;
+      auto& op = *wrap;
+      release_op(op.get());
+      if (op->handler_)
+        op->handler_(yasio::errc::send_queue_full, 0);
+      send_queue_.pop();
+    }
+  }
+  auto blocked = blocked_.load();
+  if (blocked == blocked_drain ? queued_ops_ == 0
+                               : blocked == blocked_low && (limits.high_bytes <= 0 || queued_bytes_ <= static_cast<size_t>(limits.low_bytes)) &&
+                                     (limits.high_ops <= 0 || queued_ops_ <= limits.low_ops))
+  {
+    blocked_ = 0;
+    get_service().fire_event(this->cindex(), YEK_ON_WRITABLE, 0, this);
+  }
 }
 int io_transport::do_read(int revent, int& error, highp_time_t&)
 {
@@ -388,6 +700,11 @@ bool io_transport::do_write(highp_time_t& wait_duration)
     if (!socket_->is_open())
       break;
 
+    if (!zerocopy_ops_.empty())
+      harvest_zerocopy();
+    if (blocked_)
+      check_watermarks();
+
     int error = 0;
     auto wrap = send_queue_.peek();
     if (wrap)
@@ -398,6 +715,8 @@ bool io_transport::do_write(highp_time_t& wait_duration)
         this->set_last_errno(error, yasio::io_base::error_stage::WRITE);
         break;
       }
+      if (blocked_) // the op completed may drain the queue to low watermarks
+        check_watermarks();
     }
 
     bool no_wevent = send_queue_.empty();
@@ -405,8 +724,10 @@ bool io_transport::do_write(highp_time_t& wait_duration)
     { // still have work to do
       no_wevent = (error != EWOULDBLOCK && error != EAGAIN && error != ENOBUFS);
       if (!no_wevent)
-      { // system kernel buffer full
-        if (!pollout_registerred_)
+      { // system kernel buffer full, or the pipe of send file op drained which is watched for readable
+        if (source_fd_ != -1)
+          no_wevent = true;
+        else if (!pollout_registerred_)
         {
           get_service().io_watcher_.mod_event(socket_->native_handle(), socket_event::write, 0);
           pollout_registerred_ = true;
@@ -425,6 +746,20 @@ bool io_transport::do_write(highp_time_t& wait_duration)
 
   return ret;
 }
+void io_transport::watch_source(int fd)
+{
+  if (source_fd_ == fd)
+    return;
+  get_service().io_watcher_.mod_event(fd, socket_event::read, 0);
+  source_fd_ = fd;
+}
+void io_transport::unwatch_source()
+{
+  if (source_fd_ == -1)
+    return;
+  get_service().io_watcher_.mod_event(source_fd_, 0, socket_event::read);
+  source_fd_ = -1;
+}
 int io_transport::call_read(void* data, int size, int revent, int& error)
 {
   int n = read_cb_(data, size, revent, error);
@@ -448,12 +783,12 @@ int io_transport::call_read(void* data, int size, int revent, int& error)
 }
 int io_transport::call_write(io_send_op* op, int& error)
 {
-  int n = op->perform(this, op->buffer_.data() + op->offset_, static_cast<int>(op->buffer_.size() - op->offset_), error);
+  int n = op->write_some(this, error);
   if (n > 0)
   {
     // #performance: change offset only, remain data will be send at next frame.
     op->offset_ += n;
-    if (op->offset_ == op->buffer_.size())
+    if (op->offset_ == op->size())
       this->complete_op(op, 0);
   }
   else if (n < 0)
@@ -471,11 +806,76 @@ int io_transport::call_write(io_send_op* op, int& error)
 }
 void io_transport::complete_op(io_send_op* op, int error)
 {
-  YASIO_KLOGV("[index: %d] write complete, bytes transferred: %d/%d", this->cindex(), static_cast<int>(op->offset_), static_cast<int>(op->buffer_.size()));
+  YASIO_KLOGV("[index: %d] write complete, bytes transferred: %d/%d", this->cindex(), static_cast<int>(op->offset_), static_cast<int>(op->size()));
+  release_op(op);
+  if (op->zerocopy_ && !error)
+  { // the kernel still references the buffer, complete it when notified
+    zerocopy_ops_.push_back(std::move(*send_queue_.peek()));
+    send_queue_.pop();
+    return;
+  }
   if (op->handler_)
     op->handler_(error, op->offset_);
   send_queue_.pop();
 }
+int io_transport::write_zerocopy(io_send_op* op, int& error)
+{
+  auto data = op->buffer_.data() + op->offset_;
+  int len   = static_cast<int>(op->buffer_.size() - op->offset_);
+#if YASIO__HAS_ZEROCOPY
+  int n = static_cast<int>(::send(socket_->native_handle(), data, len, YASIO_MSG_FLAG | MSG_ZEROCOPY));
+  if (n >= 0)
+  { // the kernel counts each zerocopy send which returns without error
+    op->zerocopy_     = true;
+    op->zerocopy_end_ = ++zerocopy_next_;
+    return n;
+  }
+  error = xxsocket::get_last_errno();
+  if (error != ENOBUFS) // ENOBUFS: exceeds optmem limit, fallback to copy
+    return n;
+#endif
+  return op->perform(this, data, len, error);
+}
+void io_transport::harvest_zerocopy()
+{
+#if YASIO__HAS_ZEROCOPY
+  char control[128];
+  for (;;)
+  {
+    msghdr msg{};
+    msg.msg_control    = control;
+    msg.msg_controllen = sizeof(control);
+    if (::recvmsg(socket_->native_handle(), &msg, MSG_ERRQUEUE) < 0)
+      break;
+    for (auto cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm))
+    {
+      if (!(cm->cmsg_level == SOL_IP && cm->cmsg_type == IP_RECVERR) && !(cm->cmsg_level == SOL_IPV6 && cm->cmsg_type == IPV6_RECVERR))
+        continue;
+      auto serr = reinterpret_cast<const sock_extended_err*>(CMSG_DATA(cm));
+      if (serr->ee_errno != 0 || serr->ee_origin != SO_EE_ORIGIN_ZEROCOPY)
+        continue;
+      // the range [ee_info, ee_data] of sends completed, tcp always notify in order
+      zerocopy_done_ = serr->ee_data + 1;
+      if (serr->ee_code & SO_EE_CODE_ZEROCOPY_COPIED)
+      { // the kernel fallback to copy, i.e. loopback or nic without scatter-gather
+        YASIO_KLOGD("[index: %d] zerocopy disabled, the kernel copied", this->cindex());
+        zerocopy_threshold_ = 0;
+      }
+    }
+  }
+#endif
+  size_t count = 0;
+  for (; count < zerocopy_ops_.size(); ++count)
+  {
+    auto& op = zerocopy_ops_[count];
+    if (static_cast<int32_t>(op->zerocopy_end_ - zerocopy_done_) > 0)
+      break;
+    if (op->handler_)
+      op->handler_(0, op->offset_);
+  }
+  if (count > 0)
+    zerocopy_ops_.erase(zerocopy_ops_.begin(), zerocopy_ops_.begin() + count);
+}
 void io_transport::set_primitives()
 {
   if (yasio__testbits(ctx_->properties_, YCM_TCP))
@@ -486,6 +886,12 @@ void io_transport::set_primitives()
         error = xxsocket::get_last_errno();
       return n;
     };
+    this->writev_cb_ = [this](const cxx17::string_view* bufs, int count, int& error) {
+      int n = socket_->sendv(bufs, count, YASIO_MSG_FLAG);
+      if (n < 0)
+        error = xxsocket::get_last_errno();
+      return n;
+    };
   }
   else // UDP
   {
@@ -513,38 +919,147 @@ void io_transport::set_primitives()
 inline io_transport_tcp::io_transport_tcp(io_channel* ctx, xxsocket_ptr&& s) : io_transport(ctx, std::forward<xxsocket_ptr>(s)) {}
 // ----------------------- io_transport_ssl ----------------
 #if defined(YASIO_SSL_BACKEND)
+struct ssl_handshake_job {
+  enum
+  {
+    idle,
+    queued,
+    running,
+    done,
+    cancelled, // shutdown while running, the step frees the ssl and socket when done
+  };
+  std::atomic<int> state{idle};
+  int ret         = 0;
+  int error       = 0;
+  bool want_write = false; // the step blocked on writing, the next step waits writable
+  xxsocket_ptr socket;     // the socket handed over to the step cancelled
+};
 io_transport_ssl::io_transport_ssl(io_channel* ctx, xxsocket_ptr&& sock) : io_transport_tcp(ctx, std::forward<xxsocket_ptr>(sock))
 {
   this->state_ = io_base::state::CONNECTING; // for ssl, inital state shoud be connecing for ssl handshake
   bool client  = yasio__testbits(ctx->properties_, YCM_CLIENT);
-  this->ssl_   = yssl_new(ctx->get_ssl_context(client), static_cast<int>(this->socket_->native_handle()), ctx->remote_host_.c_str(), client);
+  this->ssl_   = yssl_new(ctx->get_ssl_context(client), static_cast<int>(this->socket_->native_handle()), ctx->remote_host_.c_str(),
+                          ctx->remote_port_, client);
+  if (!client && ctx->get_service().ssl_workers_)
+    this->hs_job_ = std::make_shared<ssl_handshake_job>();
 }
-int io_transport_ssl::do_ssl_handshake(int& error)
+int io_transport_ssl::do_ssl_handshake(int revent, int& error)
 {
-  int ret = yssl_do_handshake(ssl_, error);
+  if (yasio__unlikely(this->early_state_ < 2 && yssl_early_writable(ssl_)))
+  { // the resumed session allows early data, open before handshake, the data written at open event sent with handshake
+    if (this->early_state_ == 0)
+    {
+      this->state_    = io_base::state::OPENED;
+      this->write_cb_ = [this](const void* data, int len, const ip::endpoint*, int& error) { return yssl_write(ssl_, data, len, error); };
+      get_service().notify_connect_succeed(this);
+    }
+    ++this->early_state_; // the open event dispatched at end of loop, continue handshake after next write pass
+    get_service().wakeup();
+    error = EWOULDBLOCK;
+    return -1;
+  }
+  int ret = 0;
+  if (this->hs_job_)
+  { // one handshake step in flight, the worker wakeup io thread when done, the result consumed at next read
+    auto& job = *this->hs_job_;
+    if (job.state.load(std::memory_order_acquire) != ssl_handshake_job::done)
+    {
+      // the step blocked on reading waits readable, the step blocked on writing waits writable
+      auto& service = get_service();
+      auto fd       = socket_->native_handle();
+      if (job.state.load(std::memory_order_relaxed) == ssl_handshake_job::idle &&
+          (job.want_write ? service.io_watcher_.is_ready(fd, socket_event::write) : revent))
+      {
+        if (job.want_write && !pollout_registerred_)
+          service.io_watcher_.mod_event(fd, 0, socket_event::write);
+        job.state.store(ssl_handshake_job::queued, std::memory_order_relaxed);
+        auto job = this->hs_job_;
+        auto ssl = this->ssl_;
+        service.ssl_workers_->post([&service, job, ssl] {
+          int expected = ssl_handshake_job::queued;
+          if (!job->state.compare_exchange_strong(expected, ssl_handshake_job::running))
+            return; // cancelled by shutdown
+          job->error      = 0;
+          job->ret        = yssl_do_handshake(ssl, job->error);
+          job->want_write = job->error == EWOULDBLOCK && yssl_want_write(ssl);
+          expected        = ssl_handshake_job::running;
+          if (job->state.compare_exchange_strong(expected, ssl_handshake_job::done, std::memory_order_acq_rel))
+            service.wakeup();
+          else
+          { // cancelled by shutdown while running, the transport already gone
+            auto cancelled = ssl;
+            yssl_free(cancelled);
+            job->socket.reset();
+          }
+        });
+      }
+      error = EWOULDBLOCK;
+      return -1;
+    }
+    ret   = job.ret;
+    error = job.error;
+    job.state.store(ssl_handshake_job::idle, std::memory_order_relaxed);
+    if (job.want_write && error == EWOULDBLOCK && !pollout_registerred_)
+      get_service().io_watcher_.mod_event(socket_->native_handle(), socket_event::write, 0);
+  }
+  else
+    ret = yssl_do_handshake(ssl_, error);
   // handshake succeed, because we invoke handshake in call_read, so we emit EWOULDBLOCK to mark ssl transport status `ok`
   if (ret == 0 && !error)
   {
-    this->state_   = io_base::state::OPENED;
     this->read_cb_ = [this](void* data, int len, int revent, int& error) {
       if (revent)
         return yssl_read(ssl_, data, len, error);
       error = EWOULDBLOCK;
       return -1;
     };
-    this->write_cb_ = [this](const void* data, int len, const ip::endpoint*, int& error) { return yssl_write(ssl_, data, len, error); };
-    get_service().notify_connect_succeed(this);
+    if (yssl_ktls_send(ssl_))
+    { // the kernel encrypts the records, send plain data to socket directly, the received records still read by ssl,
+      // since plain recv fails with EIO on non-data records, i.e. TLS 1.3 session tickets and alerts
+      auto read_cb = std::move(this->read_cb_);
+      io_transport::set_primitives();
+      this->read_cb_ = std::move(read_cb);
+    }
+    else
+      this->write_cb_ = [this](const void* data, int len, const ip::endpoint*, int& error) { return yssl_write(ssl_, data, len, error); };
+
+    auto& service = get_service();
+    int resumed   = yssl_session_reused(ssl_);
+    bool accepted = this->early_state_ && yssl_early_data_accepted(ssl_);
+    if (yasio__testbits(ctx_->properties_, YCM_CLIENT))
+    {
+      ++service.ssl_handshakes_;
+      if (resumed >= 0)
+        service.ssl_resumed_ += resumed;
+      else
+        ++service.ssl_resumed_unknown_;
+      service.ssl_early_data_accepted_ += accepted;
+    }
+    else
+      service.count_ssl_server_handshake();
+    YASIO_KLOGD("[index: %d] the ssl handshake of connection #%u succeed, resumed=%d, early_data_accepted=%d, ktls=%d/%d", ctx_->index_,
+                this->id_, resumed, (int)accepted, (int)yssl_ktls_send(ssl_), (int)yssl_ktls_recv(ssl_));
+    if (this->early_state_)
+      this->early_state_ = accepted ? 0 : 3;
+    else
+    {
+      this->state_ = io_base::state::OPENED;
+      service.notify_connect_succeed(this);
+    }
     error = EWOULDBLOCK;
   }
   else
   {
     if (error == EWOULDBLOCK)
-      get_service().wakeup();
+    {
+      if (!this->hs_job_)
+        get_service().wakeup();
+    }
     else
     { // handshake failed, print reason
       char buf[256] = {0};
       YASIO_KLOGE("[index: %d] do_ssl_handshake fail with: %s", ctx_->index_, yssl_strerror(ssl_, ret, buf, sizeof(buf)));
-      if (yasio__testbits(ctx_->properties_, YCM_CLIENT))
+      if (yasio__testbits(ctx_->properties_, YCM_CLIENT) && !this->early_state_)
       {
         YASIO_KLOGE("[index: %d] connect server %s failed, ec=%d, detail:%s", ctx_->index_, ctx_->format_destination().c_str(), error,
                     io_service::strerror(error));
@@ -554,14 +1069,60 @@ int io_transport_ssl::do_ssl_handshake(int& error)
   }
   return -1;
 }
+bool io_transport_ssl::do_write(highp_time_t& wait_duration)
+{
+  if (yasio__unlikely(this->early_state_ == 1 || this->early_state_ == 2))
+  { // handshaking, only early data can be sent
+    if (!yssl_early_writable(ssl_))
+      return true;
+  }
+  else if (yasio__unlikely(this->early_state_ == 3))
+  { // replay the early data rejected by server, before any queued data
+    int error = 0;
+    if (yssl_write(ssl_, nullptr, 0, error) < 0)
+    {
+      if (error != EWOULDBLOCK)
+      {
+        this->set_last_errno(error, yasio::io_base::error_stage::WRITE);
+        return false;
+      }
+      if (!pollout_registerred_)
+      {
+        get_service().io_watcher_.mod_event(socket_->native_handle(), socket_event::write, 0);
+        pollout_registerred_ = true;
+      }
+      return true;
+    }
+    this->early_state_ = 0;
+  }
+  return io_transport_tcp::do_write(wait_duration);
+}
 void io_transport_ssl::do_ssl_shutdown()
 {
+  if (this->hs_job_)
+  {
+    auto& job    = *this->hs_job_;
+    int expected = ssl_handshake_job::queued;
+    if (!job.state.compare_exchange_strong(expected, ssl_handshake_job::idle) && expected == ssl_handshake_job::running)
+    { // the ssl and socket can't be touched until the step on worker finished, hand over them to the step
+      auto fd = socket_->native_handle();
+      get_service().io_watcher_.mod_event(fd, 0, socket_event::readwrite);
+      job.socket = this->socket_;
+      if (job.state.compare_exchange_strong(expected, ssl_handshake_job::cancelled, std::memory_order_acq_rel))
+      {
+        this->socket_ = std::make_shared<xxsocket>();
+        this->ssl_    = nullptr;
+        return;
+      }
+      job.socket.reset(); // the step just finished
+    }
+  }
   if (ssl_)
     yssl_shutdown(ssl_, this->error_ == yasio::errc::shutdown_by_localhost);
 }
 void io_transport_ssl::set_primitives()
 {
-  this->read_cb_ = [this](void* /*data*/, int /*len*/, int /*revent*/, int& error) { return do_ssl_handshake(error); };
+  this->read_cb_ = [this](void* /*data*/, int /*len*/, int revent, int& error) { return do_ssl_handshake(revent, error); };
 }
 #endif
 // ----------------------- io_transport_udp ----------------
@@ -622,10 +1183,7 @@ int io_transport_udp::write(io_send_buffer&& buffer, completion_cb_t&& handler)
 }
 int io_transport_udp::write_to(io_send_buffer&& buffer, const ip::endpoint& to, completion_cb_t&& handler)
 {
-  int n = static_cast<int>(buffer.size());
-  send_queue_.emplace(cxx14::make_unique<io_sendto_op>(std::move(buffer), std::move(handler), to));
-  get_service().wakeup();
-  return n;
+  return enqueue(cxx14::make_unique<io_sendto_op>(std::move(buffer), std::move(handler), to));
 }
 void io_transport_udp::set_primitives()
 {
@@ -663,10 +1221,10 @@ void io_transport_udp::set_primitives()
 int io_transport_udp::handle_input(char* data, int bytes_transferred, int& /*error*/, highp_time_t&)
 { // pure udp, dispatch to upper layer directly
   auto& service = get_service();
-  if (!service.options_.forward_packet_)
+  if (!service.options_.forward_packet_ && !service.options_.on_packet_)
     service.fire_event(this->cindex(), io_packet{data, data + bytes_transferred}, this);
   else
-    service.forward_packet(this->cindex(), io_packet_view{data, bytes_transferred}, this);
+    service.forward_packet(this, data, bytes_transferred);
   return bytes_transferred;
 }
 
@@ -679,17 +1237,33 @@ io_transport_kcp::io_transport_kcp(io_channel* ctx, xxsocket_ptr&& s) : io_trans
   ::ikcp_nodelay(this->kcp_, kopts.kcp_nodelay_, kopts.kcp_interval_, kopts.kcp_resend_, kopts.kcp_ncwnd_);
   ::ikcp_wndsize(this->kcp_, kopts.kcp_sndwnd_, kopts.kcp_rcvwnd_);
   ::ikcp_setmtu(this->kcp_, kopts.kcp_mtu_);
+  if (kopts.kcp_fec_data_shards_ > 0 && kopts.kcp_fec_parity_shards_ > 0)
+  { // reserve the fec header, so the shards fit the mtu
+    this->fec_.reset(new fec_codec(kopts.kcp_fec_data_shards_, kopts.kcp_fec_parity_shards_, kopts.kcp_mtu_));
+    ::ikcp_setmtu(this->kcp_, kopts.kcp_mtu_ - fec_codec::overhead);
+  }
   // Because of nodelaying config will change the value. so setting RTO min after call ikcp_nodely.
   this->kcp_->rx_minrto = kopts.kcp_minrto_;
+  this->flush_policy_   = kopts.kcp_flush_policy_;
+  this->flush_delay_    = kopts.kcp_flush_delay_;
 
   this->rawbuf_.resize(yasio__max_rcvbuf);
   ::ikcp_setoutput(this->kcp_, [](const char* buf, int len, ::ikcpcb* /*kcp*/, void* user) {
-    auto t         = (io_transport_kcp*)user;
+    auto t = (io_transport_kcp*)user;
+    if (t->fec_)
+      return t->fec_->encode(buf, len, [t](const void* shard, int n) {
+        int ignored_ec = 0;
+        return t->underlaying_write_cb_(shard, n, std::addressof(t->ensure_destination()), ignored_ec);
+      });
     int ignored_ec = 0;
     return t->underlaying_write_cb_(buf, len, std::addressof(t->ensure_destination()), ignored_ec);
   });
 }
-io_transport_kcp::~io_transport_kcp() { ::ikcp_release(this->kcp_); }
+io_transport_kcp::~io_transport_kcp()
+{
+  get_service().unschedule_kcp(this);
+  ::ikcp_release(this->kcp_);
+}
 
 void io_transport_kcp::set_primitives()
 {
@@ -698,27 +1272,74 @@ void io_transport_kcp::set_primitives()
   write_cb_             = [this](const void* data, int len, const ip::endpoint*, int& error) {
     int nsent = ::ikcp_send(kcp_, static_cast<const char*>(data), len /*(std::min)(static_cast<int>(kcp_->mss), len)*/);
     if (nsent > 0)
-    {
-      ::ikcp_flush(kcp_);
-      expire_time_ = 0;
-    }
+      schedule_flush();
     else
       error = EMSGSIZE; // emit message too long
     return nsent;
   };
 }
+void io_transport_kcp::schedule_now()
+{
+  auto& service = get_service();
+  service.schedule_kcp(this, service.kcp_clock());
+}
+void io_transport_kcp::schedule_flush()
+{
+  auto& service = get_service();
+  switch (flush_policy_)
+  {
+    case YKFP_END_OF_LOOP:
+      flush_pending_ = true;
+      service.schedule_kcp(this, service.kcp_clock());
+      break;
+    case YKFP_DEADLINE:
+      if (!flush_pending_)
+      { // the first segment after last flush decides the deadline
+        flush_pending_ = true;
+        auto deadline  = service.kcp_clock() + static_cast<IUINT32>(flush_delay_);
+        if (sched_index_ < 0 || ((IINT32)(deadline - expire_time_)) < 0)
+          service.schedule_kcp(this, deadline);
+      }
+      break;
+    default: // YKFP_IMMEDIATE
+      ::ikcp_flush(kcp_);
+      service.schedule_kcp(this, service.kcp_clock());
+  }
+}
 bool io_transport_kcp::do_write(highp_time_t& wait_duration)
 {
-  bool ret = io_transport_udp::do_write(wait_duration);
+  if (!socket_->is_open())
+    return false;
+
+  if (blocked_)
+    check_watermarks();
 
-  const auto current = static_cast<IUINT32>(std::chrono::duration_cast<std::chrono::milliseconds>(get_service().current_time_.time_since_epoch()).count());
-  if (((IINT32)(current - expire_time_)) >= 0)
+  // ikcp_send only queue the data, so drain the queued ops at once instead one op per pass,
+  // stop when the kcp send queue reach the send window, the rest will be sent at next pass.
+  bool sent = false;
+  while (kcp_->nsnd_que < kcp_->snd_wnd)
   {
-    ::ikcp_update(kcp_, current);
-    expire_time_ = ::ikcp_check(kcp_, current);
+    auto wrap = send_queue_.peek();
+    if (!wrap)
+      break;
+    auto& v   = *wrap;
+    int error = 0;
+    int n     = call_write(v.get(), error);
+    if (n < 0)
+    {
+      this->set_last_errno(error, yasio::io_base::error_stage::WRITE);
+      return false;
+    }
+    if (n == 0) // dropped or nothing sent, try next pass
+      break;
+    sent = true;
   }
-
-  return ret;
+  if (blocked_)
+    check_watermarks();
+  // the full window is opened by acks, the input of them drives next pass, don't spin until then
+  if (sent && !send_queue_.empty())
+    wait_duration = 0;
+  return true;
 }
 int io_transport_kcp::do_read(int revent, int& error, highp_time_t& wait_duration)
 {
@@ -728,6 +1349,7 @@ int io_transport_kcp::do_read(int revent, int& error, highp_time_t& wait_duratio
   if (!error)
   { // !important, should always try to call ikcp_recv when no error occured.
     auto kdata_size = ::ikcp_peeksize(kcp_);
+    n               = 0; // the datagram consumed by kcp may carry no message, i.e. ack or fec parity
     if (kdata_size > 0)
     {
       auto need_size = static_cast<size_t>(kdata_size + offset_);
@@ -745,9 +1367,10 @@ int io_transport_kcp::do_read(int revent, int& error, highp_time_t& wait_duratio
 int io_transport_kcp::handle_input(char* buf, int len, int& error, highp_time_t& wait_duration)
 {
   // ikcp in event always in service thread, so no need to lock
-  if (0 == ::ikcp_input(kcp_, buf, len))
+  int ret = !fec_ ? ::ikcp_input(kcp_, buf, len) : fec_->decode(buf, len, [this](const char* data, int n) { return ::ikcp_input(kcp_, data, n); });
+  if (0 == ret)
   {
-    expire_time_ = 0;
+    schedule_now();
     return len;
   }
   // simply regards -1,-2,-3 as error and trigger connection lost event.
@@ -759,6 +1382,28 @@ int io_transport_kcp::handle_input(char* buf, int len, int& error, highp_time_t&
 void io_service::init_globals(const yasio::inet::print_fn2_t& prt) { yasio__shared_globals(prt).cprint_ = prt; }
 void io_service::cleanup_globals() { yasio__shared_globals().cprint_ = nullptr; }
 unsigned int io_service::tcp_rtt(transport_handle_t transport) { return transport->is_open() ? transport->socket_->tcp_rtt() : 0; }
+#if defined(YASIO_SSL_BACKEND)
+ssl_stats io_service::get_ssl_stats() const
+{
+  // the last second count is stale when no handshake since
+  unsigned int rate = yasio::highp_clock() - ssl_rate_start_.load() < std::micro::den * 2 ? ssl_rate_last_.load() : 0;
+  return ssl_stats{ssl_handshakes_.load(), ssl_resumed_.load(), ssl_resumed_unknown_.load(), ssl_early_data_accepted_.load(),
+                   ssl_server_handshakes_.load(), rate};
+}
+void io_service::count_ssl_server_handshake()
+{
+  ++ssl_server_handshakes_;
+  auto now     = yasio::highp_clock();
+  auto elapsed = now - ssl_rate_start_.load(std::memory_order_relaxed);
+  if (elapsed >= std::micro::den)
+  {
+    ssl_rate_last_  = elapsed < std::micro::den * 2 ? ssl_rate_count_.load() : 0;
+    ssl_rate_count_ = 0;
+    ssl_rate_start_ = now;
+  }
+  ++ssl_rate_count_;
+}
+#endif
 io_service::io_service() { this->initialize(nullptr, 1); }
 io_service::io_service(int channel_count) { this->initialize(nullptr, channel_count); }
 io_service::io_service(const io_hostent& channel_ep) { this->initialize(&channel_ep, 1); }
@@ -791,11 +1436,30 @@ void io_service::start(event_cb_t cb)
     else
     {
       this->worker_id_ = std::this_thread::get_id();
+      if (options_.no_new_thread_ == 2)
+      { // driven by io_service::poll
+        prepare_loop();
+        return;
+      }
       run();
       handle_stop();
     }
   }
 }
+bool io_service::poll(highp_time_t timeout_us)
+{
+  if (this->state_ != io_service::state::RUNNING || options_.no_new_thread_ != 2 || this->polling_)
+    return false;
+  this->polling_ = true;
+  bool alive     = run_once((std::max)(timeout_us, (highp_time_t)0)) && (!this->stop_flag_ || !this->transports_.empty());
+  this->polling_ = false;
+  if (!alive)
+  {
+    handle_worker_exit();
+    handle_stop();
+  }
+  return alive;
+}
 void io_service::stop() { do_stop(YSTF_STOP); }
 void io_service::do_stop(uint8_t flags)
 {
@@ -817,6 +1481,13 @@ void io_service::do_stop(uint8_t flags)
 }
 void io_service::handle_stop()
 {
+  if (options_.no_new_thread_ == 2 && this->state_ == io_service::state::RUNNING)
+  { // stopped outside poll, drive the remaining iterations, otherwise the poll finish it
+    if (!this->polling_)
+      while (this->poll(this->sched_freq_))
+        ;
+    return;
+  }
   if (this->worker_.joinable())
   {
     if (std::this_thread::get_id() == this->worker_id_)
@@ -835,6 +1506,9 @@ void io_service::handle_stop()
       YASIO_KLOGW("[core] the worker thread terminated unexpectedly");
       handle_worker_exit();
       this->events_.clear();
+      this->queued_events_      = 0;
+      this->queued_event_bytes_ = 0;
+      this->released_event_bytes_.clear();
     }
   }
 
@@ -918,18 +1592,115 @@ void io_service::clear_transports()
   transport_map_.clear();
   for (auto transport : transports_)
   {
+    transport->unwatch_source();
     cleanup_io(transport);
     yasio::invoke_dtor(transport);
     this->tpool_.push_back(transport);
   }
   transports_.clear();
+  paused_transports_.clear();
+  released_event_bytes_.clear();
+  reads_paused_ = false;
+#if defined(YASIO_ENABLE_KCP)
+  kcp_sched_.clear();
+#endif
 }
 size_t io_service::dispatch(int max_count)
 {
   if (options_.on_event_)
-    this->events_.consume(max_count, options_.on_event_);
+  {
+    if (!options_.event_queue_limits_.enabled)
+      this->events_.consume(max_count, options_.on_event_);
+    else
+    {
+      std::pair<unsigned int, size_t> released{0, 0};
+      this->events_.consume(max_count, [this, &released](event_ptr&& event) {
+        untrack_event(event.get(), released);
+        options_.on_event_(std::move(event));
+      });
+      if (released.second > 0)
+        released_event_bytes_.emplace(released);
+      if (reads_paused_ && !is_event_queue_full(nullptr, 1))
+        this->wakeup();
+    }
+  }
   return this->events_.count();
 }
+void io_service::track_event(io_event* event)
+{
+  size_t bytes = event->kind() == YEK_ON_PACKET ? packet_len(event->packet()) : 0;
+  ++queued_events_;
+  queued_event_bytes_ += bytes;
+  if (bytes > 0)
+    event->transport()->queued_event_bytes_ += bytes;
+}
+void io_service::untrack_event(io_event* event, std::pair<unsigned int, size_t>& released)
+{
+  size_t bytes = event->kind() == YEK_ON_PACKET ? packet_len(event->packet()) : 0;
+  --queued_events_;
+  if (bytes == 0)
+    return;
+  queued_event_bytes_ -= bytes;
+  // the transport may be closed and the memory reused by new one, so only the id is recorded,
+  // and the consecutive packets of the same transport are merged
+  if (released.first != event->source_id())
+  {
+    if (released.second > 0)
+      released_event_bytes_.emplace(released);
+    released = std::make_pair(event->source_id(), static_cast<size_t>(0));
+  }
+  released.second += bytes;
+}
+void io_service::release_event_bytes()
+{
+  if (released_event_bytes_.empty())
+    return;
+  auto& released = this->released_bytes_;
+  released_event_bytes_.consume((std::numeric_limits<int>::max)(), [&released](std::pair<unsigned int, size_t>&& item) { released.push_back(item); });
+  std::sort(released.begin(), released.end());
+  // the transport closed is absent, nothing to release
+  for (auto transport : transports_)
+  {
+    auto it = std::lower_bound(released.begin(), released.end(), std::make_pair(transport->id_, static_cast<size_t>(0)));
+    for (; it != released.end() && it->first == transport->id_; ++it)
+      transport->queued_event_bytes_ -= (std::min)(transport->queued_event_bytes_, it->second);
+  }
+  released.clear();
+}
+bool io_service::is_event_queue_full(transport_handle_t transport, int shift) const
+{
+  auto& limits = options_.event_queue_limits_;
+  return (limits.max_events > 0 && queued_events_ > (limits.max_events >> shift)) ||
+         (limits.max_bytes > 0 && queued_event_bytes_ > static_cast<size_t>(limits.max_bytes >> shift)) ||
+         (transport && limits.transport_max_bytes > 0 && transport->queued_event_bytes_ > static_cast<size_t>(limits.transport_max_bytes >> shift));
+}
+void io_service::pause_read(transport_handle_t transport)
+{
+  YASIO_KLOGV("[index: %d] the event queue is full, pause reading the connection #%u", transport->cindex(), transport->id_);
+  io_watcher_.mod_event(transport->socket_->native_handle(), 0, socket_event::read);
+  transport->read_paused_ = true;
+  paused_transports_.push_back(transport);
+  reads_paused_ = true;
+}
+void io_service::resume_reads()
+{
+  if (is_event_queue_full(nullptr, 1))
+    return;
+  for (auto iter = paused_transports_.begin(); iter != paused_transports_.end();)
+  {
+    auto transport = *iter;
+    if (!is_event_queue_full(transport, 1))
+    {
+      YASIO_KLOGV("[index: %d] resume reading the connection #%u", transport->cindex(), transport->id_);
+      io_watcher_.mod_event(transport->socket_->native_handle(), socket_event::read, 0);
+      transport->read_paused_ = false;
+      iter                    = paused_transports_.erase(iter);
+    }
+    else
+      ++iter;
+  }
+  reads_paused_ = !paused_transports_.empty();
+}
 
 #if defined(_WIN32)
 template <typename _Ty>
@@ -962,65 +1733,84 @@ void io_service::run()
     __timer_hres_man.emplace();
 #endif
 
+  prepare_loop();
+
+  do
+  {
+    if (!run_once(-1))
+      break;
+  } while (!this->stop_flag_ || !this->transports_.empty());
+
+  handle_worker_exit();
+}
+void io_service::prepare_loop()
+{
 #if defined(YASIO_SSL_BACKEND)
   init_ssl_context(YSSL_CLIENT); // by default, init ssl client context
 #endif
 #if defined(YASIO_USE_CARES)
   recreate_ares_channel();
-  ares_socket_t ares_socks[ARES_GETSOCK_MAXNUM] = {0};
 #endif
+}
+bool io_service::run_once(highp_time_t max_wait_us)
+{
+  this->current_time_ = yasio::steady_clock_t::now();
 
-  do
-  {
-    this->current_time_ = yasio::steady_clock_t::now();
+  auto waitd_usec  = get_timeout(this->wait_duration_); // Gets current wait duration
+  bool should_poll = waitd_usec > 0;
+  if (max_wait_us >= 0)
+  { // the external loop always polls, the timeout is negative when timers overdue
+    waitd_usec  = yasio::clamp(waitd_usec, (highp_time_t)0, max_wait_us);
+    should_poll = true;
+  }
 
-    auto waitd_usec = get_timeout(this->wait_duration_); // Gets current wait duration
 #if defined(YASIO_USE_CARES)
-    /**
-     * retrieves the set of file descriptors which the calling application should poll io,
-     * after poll_io, for ares invoke flow, refer to:
-     * https://c-ares.org/ares_fds.html
-     * https://c-ares.org/ares_timeout.html
-     * https://c-ares.org/ares_process_fd.html
-     */
-    auto ares_nfds = ares_get_fds(ares_socks, waitd_usec);
+  /**
+   * retrieves the set of file descriptors which the calling application should poll io,
+   * after poll_io, for ares invoke flow, refer to:
+   * https://c-ares.org/ares_fds.html
+   * https://c-ares.org/ares_timeout.html
+   * https://c-ares.org/ares_process_fd.html
+   */
+  ares_socket_t ares_socks[ARES_GETSOCK_MAXNUM] = {0};
+  auto ares_nfds                                = ares_get_fds(ares_socks, waitd_usec);
 #endif
 
-    if (waitd_usec > 0)
+  if (should_poll)
+  {
+    YASIO_KLOGV("[core] poll_io max_nfds=%d, waiting... %.3f milliseconds", io_watcher_.max_descriptor(), waitd_usec / static_cast<float>(std::milli::den));
+    int retval = io_watcher_.poll_io(waitd_usec);
+    YASIO_KLOGV("[core] poll_io waked up, retval=%d", retval);
+    if (retval < 0)
     {
-      YASIO_KLOGV("[core] poll_io max_nfds=%d, waiting... %.3f milliseconds", io_watcher_.max_descriptor(), waitd_usec / static_cast<float>(std::milli::den));
-      int retval = io_watcher_.poll_io(waitd_usec);
-      YASIO_KLOGV("[core] poll_io waked up, retval=%d", retval);
-      if (retval < 0)
-      {
-        int ec = xxsocket::get_last_errno();
-        YASIO_KLOGI("[core] poll_io failed, max_fd=%d ec=%d, detail:%s\n", io_watcher_.max_descriptor(), ec, io_service::strerror(ec));
-        if (ec != EBADF)
-          continue; // Try again.
-        break;
-      }
+      int ec = xxsocket::get_last_errno();
+      YASIO_KLOGI("[core] poll_io failed, max_fd=%d ec=%d, detail:%s\n", io_watcher_.max_descriptor(), ec, io_service::strerror(ec));
+      return ec != EBADF; // Try again if not EBADF
     }
+  }
 
 #if defined(YASIO_USE_CARES)
-    // process events for name resolution.
-    do_ares_process_fds(ares_socks, ares_nfds);
+  // process events for name resolution.
+  do_ares_process_fds(ares_socks, ares_nfds);
 #endif
 
-    // process active transports
-    process_transports();
+  // process active transports
+  process_transports();
 
-    // process active channels
-    process_channels();
+#if defined(YASIO_ENABLE_KCP)
+  // update due kcp transports
+  process_kcp_transports();
+#endif
 
-    // process timeout timers
-    process_timers();
+  // process active channels
+  process_channels();
 
-    // process deferred events if auto dispatch enabled
-    process_deferred_events();
+  // process timeout timers
+  process_timers();
 
-  } while (!this->stop_flag_ || !this->transports_.empty());
-
-  handle_worker_exit();
+  // process deferred events if auto dispatch enabled
+  process_deferred_events();
+  return true;
 }
 void io_service::handle_worker_exit()
 {
@@ -1028,6 +1818,8 @@ void io_service::handle_worker_exit()
   destroy_ares_channel();
 #endif
 #if defined(YASIO_SSL_BACKEND)
+  if (ssl_workers_)
+    ssl_workers_.reset();
   cleanup_ssl_context(YSSL_CLIENT);
   cleanup_ssl_context(YSSL_SERVER);
 #endif
@@ -1035,6 +1827,11 @@ void io_service::handle_worker_exit()
 }
 void io_service::process_transports()
 {
+  if (options_.event_queue_limits_.enabled)
+    release_event_bytes();
+  if (!paused_transports_.empty())
+    resume_reads();
+
   // preform transports
   for (auto iter = transports_.begin(); iter != transports_.end();)
   {
@@ -1056,6 +1853,102 @@ void io_service::process_transports()
     iter = transports_.erase(iter);
   }
 }
+#if defined(YASIO_ENABLE_KCP)
+void io_service::schedule_kcp(io_transport_kcp* t, IUINT32 expire_time)
+{
+  t->expire_time_ = expire_time;
+  if (t->sched_index_ < 0)
+  {
+    t->sched_index_ = static_cast<int>(kcp_sched_.size());
+    kcp_sched_.push_back(t);
+    kcp_sift_up(t->sched_index_);
+  }
+  else
+  { // the key may move toward either side
+    kcp_sift_up(t->sched_index_);
+    kcp_sift_down(t->sched_index_);
+  }
+}
+void io_service::unschedule_kcp(io_transport_kcp* t)
+{
+  int index = t->sched_index_;
+  if (index < 0)
+    return;
+  t->sched_index_ = -1;
+  auto last       = kcp_sched_.back();
+  kcp_sched_.pop_back();
+  if (last != t)
+  {
+    kcp_sched_[index] = last;
+    last->sched_index_ = index;
+    kcp_sift_up(index);
+    kcp_sift_down(last->sched_index_);
+  }
+}
+void io_service::kcp_sift_up(int index)
+{
+  auto t = kcp_sched_[index];
+  while (index > 0)
+  {
+    int parent = (index - 1) >> 1;
+    auto p     = kcp_sched_[parent];
+    if (((IINT32)(t->expire_time_ - p->expire_time_)) >= 0)
+      break;
+    kcp_sched_[index] = p;
+    p->sched_index_   = index;
+    index             = parent;
+  }
+  kcp_sched_[index] = t;
+  t->sched_index_   = index;
+}
+void io_service::kcp_sift_down(int index)
+{
+  const int count = static_cast<int>(kcp_sched_.size());
+  auto t          = kcp_sched_[index];
+  for (;;)
+  {
+    int child = (index << 1) + 1;
+    if (child >= count)
+      break;
+    if (child + 1 < count && ((IINT32)(kcp_sched_[child + 1]->expire_time_ - kcp_sched_[child]->expire_time_)) < 0)
+      ++child;
+    auto c = kcp_sched_[child];
+    if (((IINT32)(c->expire_time_ - t->expire_time_)) >= 0)
+      break;
+    kcp_sched_[index] = c;
+    c->sched_index_   = index;
+    index             = child;
+  }
+  kcp_sched_[index] = t;
+  t->sched_index_   = index;
+}
+void io_service::process_kcp_transports()
+{
+  const auto current = kcp_clock();
+  while (!kcp_sched_.empty())
+  {
+    auto t = kcp_sched_.front();
+    if (((IINT32)(current - t->expire_time_)) < 0)
+      break;
+    auto kcp = t->kcp_;
+    ::ikcp_update(kcp, current);
+    if (t->flush_pending_)
+    { // merge the segments queued by deferred flush policy into MTU sized datagrams
+      t->flush_pending_ = false;
+      ::ikcp_flush(kcp);
+    }
+    if (kcp->nsnd_que == 0 && kcp->nsnd_buf == 0 && kcp->ackcount == 0 && kcp->probe == 0 && kcp->rmt_wnd != 0)
+    { // nothing to send, ack or probe, park until next send or input
+      unschedule_kcp(t);
+      continue;
+    }
+    auto expire_time = ::ikcp_check(kcp, current);
+    if (expire_time == current) // always advance, so each transport updated once per loop at most
+      ++expire_time;
+    schedule_kcp(t, expire_time);
+  }
+}
+#endif
 void io_service::process_channels()
 {
   if (!this->channel_ops_.empty())
@@ -1163,11 +2056,12 @@ void io_service::handle_close(transport_handle_t thandle)
   if (yasio__testbits(ctx->properties_, YCM_UDP))
     transport_map_.erase(thandle->remote_endpoint());
 
+#if defined(YASIO_ENABLE_KCP)
   if (yasio__testbits(ctx->properties_, YCM_KCP))
-  {
-    if (--nsched_ <= 0) // if no sched transport, reset sched_freq to max wait 5mins
-      sched_freq_ = yasio__max_wait_usec;
-  }
+    unschedule_kcp(static_cast<io_transport_kcp*>(thandle));
+#endif
+  if (thandle->read_paused_)
+    paused_transports_.erase(std::find(paused_transports_.begin(), paused_transports_.end(), thandle));
   if (thandle->state_ == io_base::state::OPENED)
   { // @Because we can't retrive peer endpoint when connect reset by peer, so use id to trace.
     YASIO_KLOGD("[index: %d] the connection #%u is lost, ec=%d, where=%d, detail:%s", ctx->index_, thandle->id_, error, (int)thandle->error_stage_,
@@ -1180,6 +2074,7 @@ void io_service::handle_close(transport_handle_t thandle)
 #endif
   if (yasio__testbits(ctx->properties_, YCM_TCP) && error == yasio::errc::shutdown_by_localhost)
     thandle->socket_->shutdown();
+  thandle->unwatch_source();
   cleanup_io(thandle);
   deallocate_transport(thandle);
   if (client)
@@ -1191,7 +2086,7 @@ void io_service::handle_close(transport_handle_t thandle)
 int io_service::write(transport_handle_t transport, sbyte_buffer buffer, completion_cb_t handler)
 {
   if (transport && transport->is_open())
-    return !buffer.empty() ? transport->write(io_send_buffer{std::move(buffer)}, std::move(handler)) : 0;
+    return !buffer.empty() ? post_write(transport->write(io_send_buffer{std::move(buffer)}, std::move(handler))) : 0;
   else
   {
     YASIO_KLOGE("write failed, the connection not ok!");
@@ -1201,17 +2096,135 @@ int io_service::write(transport_handle_t transport, sbyte_buffer buffer, complet
 int io_service::forward(transport_handle_t transport, const void* buf, size_t len, completion_cb_t handler)
 {
   if (transport && transport->is_open())
-    return len != 0 ? transport->write(io_send_buffer{(const char*)buf, len}, std::move(handler)) : 0;
+    return len != 0 ? post_write(transport->write(io_send_buffer{(const char*)buf, len}, std::move(handler))) : 0;
+  else
+  {
+    YASIO_KLOGE("write failed, the connection not ok!");
+    return -1;
+  }
+}
+int io_service::write(transport_handle_t transport, shared_buffer_ptr buffer, completion_cb_t handler)
+{
+  if (transport && transport->is_open())
+    return buffer && !buffer->empty() ? post_write(transport->write(io_send_buffer{std::move(buffer)}, std::move(handler))) : 0;
+  else
+  {
+    YASIO_KLOGE("write failed, the connection not ok!");
+    return -1;
+  }
+}
+int io_service::broadcast(const transport_handle_t* transports, size_t count, const shared_buffer_ptr& buffer)
+{
+  if (!buffer || buffer->empty())
+    return 0;
+  int n = 0;
+  for (size_t i = 0; i < count; ++i)
+  {
+    auto transport = transports[i];
+    if (transport && transport->is_open() && transport->write(io_send_buffer{buffer}, nullptr) >= 0)
+      ++n;
+  }
+  if (n > 0)
+    this->wakeup();
+  return n;
+}
+int io_service::write(transport_handle_t transport, chunked_buffer&& buffer, completion_cb_t handler)
+{
+  if (transport && transport->is_open())
+  {
+    if (buffer.empty())
+      return 0;
+    if (yasio__testbits(transport->ctx_->properties_, YCM_TCP))
+      return post_write(transport->write_chain(std::move(buffer), std::move(handler)));
+    return post_write(transport->write(io_send_buffer{buffer.flatten()}, std::move(handler)));
+  }
   else
   {
     YASIO_KLOGE("write failed, the connection not ok!");
     return -1;
   }
 }
+int io_service::forward(transport_handle_t transport, const cxx17::string_view* spans, int count, completion_cb_t handler)
+{
+  if (transport && transport->is_open())
+  {
+    size_t len = 0;
+    for (int i = 0; i < count; ++i)
+      len += spans[i].size();
+    if (len == 0)
+      return 0;
+    if (yasio__testbits(transport->ctx_->properties_, YCM_TCP))
+      return post_write(transport->write_spans(spans, count, std::move(handler)));
+    sbyte_buffer buffer;
+    buffer.reserve(len);
+    for (int i = 0; i < count; ++i)
+      buffer.insert(buffer.end(), spans[i].data(), spans[i].data() + spans[i].size());
+    return post_write(transport->write(io_send_buffer{std::move(buffer)}, std::move(handler)));
+  }
+  else
+  {
+    YASIO_KLOGE("write failed, the connection not ok!");
+    return -1;
+  }
+}
+int io_service::write_file(transport_handle_t transport, int fd, long long offset, long long length, completion_cb_t handler)
+{
+  if (!transport || !transport->is_open() || !yasio__testbits(transport->ctx_->properties_, YCM_TCP))
+  {
+    YASIO_KLOGE("write_file failed, the connection not ok or not tcp!");
+    return -1;
+  }
+  if (length < 0)
+  { // to the end of regular file
+#if defined(_WIN32)
+    struct _stat64 st;
+    if (::_fstat64(fd, &st) != 0 || !(st.st_mode & _S_IFREG))
+#else
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode))
+#endif
+    {
+      YASIO_KLOGE("write_file failed, the length of fd=%d is unknown!", fd);
+      return -1;
+    }
+    length = (std::max)(static_cast<long long>(st.st_size) - offset, 0LL);
+  }
+  if (offset < 0)
+  {
+    YASIO_KLOGE("write_file failed, invalid offset: %lld", offset);
+    return -1;
+  }
+  if (length == 0)
+    return 0;
+#if !defined(_WIN32)
+  // the pipe drained is watched for readable, a blocking read must not stall the io thread
+  struct stat st;
+  if (::fstat(fd, &st) == 0 && S_ISFIFO(st.st_mode))
+  {
+    int flags = ::fcntl(fd, F_GETFL, 0);
+    if (flags == -1 || (!(flags & O_NONBLOCK) && ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) == -1))
+    {
+      YASIO_KLOGE("write_file failed, can't set the pipe fd=%d non-blocking, ec=%d", fd, xxsocket::get_last_errno());
+      return -1;
+    }
+  }
+#endif
+  return post_write(transport->write_file(fd, offset, static_cast<size_t>(length), std::move(handler)));
+}
 int io_service::write_to(transport_handle_t transport, sbyte_buffer buffer, const ip::endpoint& to, completion_cb_t handler)
 {
   if (transport && transport->is_open())
-    return !buffer.empty() ? transport->write_to(io_send_buffer{std::move(buffer)}, to, std::move(handler)) : 0;
+    return !buffer.empty() ? post_write(transport->write_to(io_send_buffer{std::move(buffer)}, to, std::move(handler))) : 0;
+  else
+  {
+    YASIO_KLOGE("write_to failed, the connection not ok!");
+    return -1;
+  }
+}
+int io_service::write_to(transport_handle_t transport, shared_buffer_ptr buffer, const ip::endpoint& to, completion_cb_t handler)
+{
+  if (transport && transport->is_open())
+    return buffer && !buffer->empty() ? post_write(transport->write_to(io_send_buffer{std::move(buffer)}, to, std::move(handler))) : 0;
   else
   {
     YASIO_KLOGE("write_to failed, the connection not ok!");
@@ -1221,7 +2234,7 @@ int io_service::write_to(transport_handle_t transport, sbyte_buffer buffer, cons
 int io_service::forward_to(transport_handle_t transport, const void* buf, size_t len, const ip::endpoint& to, completion_cb_t handler)
 {
   if (transport && transport->is_open())
-    return len != 0 ? transport->write_to(io_send_buffer{(const char*)buf, len}, to, std::move(handler)) : 0;
+    return len != 0 ? post_write(transport->write_to(io_send_buffer{(const char*)buf, len}, to, std::move(handler))) : 0;
   else
   {
     YASIO_KLOGE("write_to failed, the connection not ok!");
@@ -1321,9 +2334,17 @@ void io_service::do_connect_completion(io_channel* ctx)
 #if defined(YASIO_SSL_BACKEND)
 yssl_ctx_st* io_service::init_ssl_context(ssl_role role)
 {
-  auto ctx         = role == YSSL_CLIENT ? yssl_ctx_new(yssl_options{yasio__c_str(options_.cafile_), nullptr, true})
-                                         : yssl_ctx_new(yssl_options{yasio__c_str(options_.crtfile_), yasio__c_str(options_.keyfile_), false});
+  auto ctx         = role == YSSL_CLIENT ? yssl_ctx_new(yssl_options{yasio__c_str(options_.cafile_), nullptr, true, options_.ssl_session_cache_,
+                                                                 options_.ssl_early_data_, options_.ssl_ktls_, options_.ssl_pool_size_,
+                                                                 options_.ssl_release_buffers_})
+                                         : yssl_ctx_new(yssl_options{yasio__c_str(options_.crtfile_), yasio__c_str(options_.keyfile_), false, 0, false,
+                                                                     options_.ssl_ktls_, options_.ssl_pool_size_, options_.ssl_release_buffers_});
   ssl_roles_[role] = ctx;
+  if (ctx && role == YSSL_SERVER && options_.ssl_handshake_workers_ > 0 && !ssl_workers_)
+  {
+    ssl_workers_.reset(new thread_pool());
+    ssl_workers_->start(options_.ssl_handshake_workers_, "yasio-ssl");
+  }
   return ctx;
 }
 void io_service::cleanup_ssl_context(ssl_role role)
@@ -1678,6 +2699,11 @@ void io_service::handle_connect_succeed(transport_handle_t transport)
     // apply tcp keepalive options
     if (options_.tcp_keepalive_.onoff)
       connection->set_keepalive(options_.tcp_keepalive_.onoff, options_.tcp_keepalive_.idle, options_.tcp_keepalive_.interval, options_.tcp_keepalive_.probs);
+#if YASIO__HAS_ZEROCOPY
+    // the zerocopy not apply to ssl, the records encrypted to ssl internal buffer
+    if (options_.tcp_zerocopy_ > 0 && !yasio__testbits(ctx->properties_, YCM_SSL) && connection->set_optval(SOL_SOCKET, SO_ZEROCOPY, 1) == 0)
+      transport->zerocopy_threshold_ = options_.tcp_zerocopy_;
+#endif
   }
 #if !defined(_WIN32) // windows: UDP will ignore sndbuf, other: ensure sndbuf >= max_ip_mtu(65535)
   if (yasio__testbits(ctx->properties_, YCM_UDP))
@@ -1694,15 +2720,10 @@ void io_service::active_transport(transport_handle_t t)
   auto ctx = t->ctx_;
   auto& s  = t->socket_;
   this->transports_.push_back(t);
-  if (yasio__testbits(ctx->properties_, YCM_KCP))
-  {
-    ++this->nsched_;
 #if defined(YASIO_ENABLE_KCP)
-    auto interval = static_cast<io_transport_kcp*>(t)->interval();
-    if (this->sched_freq_ > interval)
-      this->sched_freq_ = interval;
+  if (yasio__testbits(ctx->properties_, YCM_KCP))
+    static_cast<io_transport_kcp*>(t)->schedule_now();
 #endif
-  }
   if (!yasio__testbits(ctx->properties_, YCM_SSL))
     notify_connect_succeed(t);
   else if (yasio__testbits(ctx->properties_, YCM_CLIENT))
@@ -1778,7 +2799,8 @@ bool io_service::do_read(transport_handle_t transport)
     if (!transport->socket_->is_open())
       break;
     int error  = 0;
-    int revent = io_watcher_.is_ready(transport->socket_->native_handle(), socket_event::read | socket_event::error);
+    // the poll may be skipped when the wait duration is zero, the ready bits of a paused transport are stale
+    int revent = !transport->read_paused_ ? io_watcher_.is_ready(transport->socket_->native_handle(), socket_event::read | socket_event::error) : 0;
     int n      = transport->do_read(revent, error, this->wait_duration_);
     if (n >= 0)
     {
@@ -1814,8 +2836,11 @@ bool io_service::do_read(transport_handle_t transport)
       }
       else if (n > 0)
       { // forward packet, don't perform unpack, it's useful for implement streaming based protocol, like http, websocket and ...
-        this->forward_packet(transport->cindex(), io_packet_view{transport->buffer_.data(), n}, transport);
+        this->forward_packet(transport, transport->buffer_.data(), n);
       }
+      if (options_.event_queue_limits_.enabled && n > 0 && !transport->read_paused_ && yasio__testbits(transport->ctx_->properties_, YCM_TCP) &&
+          is_event_queue_full(transport, 0))
+        pause_read(transport);
     }
     else
     { // n < 0, regard as connection should close
@@ -1845,7 +2870,14 @@ void io_service::unpack(transport_handle_t transport, int bytes_want /*want cons
     }
     // move properly pdu to ready queue, the other thread who care about will retrieve it.
     YASIO_KLOGV("[index: %d] received a properly packet from peer, packet size:%d", transport->cindex(), transport->expected_size_);
-    this->fire_event(transport->cindex(), transport->fetch_packet(), transport);
+    if (!options_.on_packet_)
+      this->fire_event(transport->cindex(), transport->fetch_packet(), transport);
+    else
+    { // handle in place, keep the packet buffer capacity for next one
+      options_.on_packet_(options_.on_packet_ud_, transport, pkt.data(), static_cast<int>(pkt.size()));
+      transport->expected_size_ = -1;
+      pkt.clear();
+    }
   }
   else /* all buffer consumed, set 'offset' to ZERO, pdu incomplete, continue recv remain data. */
     offset = 0;
@@ -1963,6 +2995,16 @@ highp_time_t io_service::get_timeout(highp_time_t usec)
 {
   this->wait_duration_ = this->sched_freq_; // Reset next wait duration per frame
 
+#if defined(YASIO_ENABLE_KCP)
+  if (!kcp_sched_.empty())
+  { // wait until the earliest kcp deadline
+    auto diff        = static_cast<IINT32>(kcp_sched_.front()->expire_time_ - kcp_clock());
+    auto kcp_timeout = diff > 0 ? static_cast<highp_time_t>(diff) * std::milli::den : 0;
+    if (usec > kcp_timeout)
+      usec = kcp_timeout;
+  }
+#endif
+
   if (this->timer_queue_.empty())
     return usec;
 
@@ -2138,6 +3180,11 @@ int io_service::resolve(std::vector<ip::endpoint>& endpoints, const char* hostna
   return xxsocket::resolve_v4to6(endpoints, hostname, port);
 }
 void io_service::wakeup() { io_watcher_.wakeup(); }
+int io_service::post_write(int n)
+{
+  this->wakeup();
+  return n;
+}
 const char* io_service::strerror(int error)
 {
   switch (error)
@@ -2158,6 +3205,8 @@ const char* io_service::strerror(int error)
       return "SSL read failed!";
     case yasio::errc::read_timeout:
       return "The remote host did not respond after a period of time.";
+    case yasio::errc::send_queue_full:
+      return "The send queue is full!";
     case yasio::errc::eof:
       return "End of file.";
     case -1:
@@ -2201,7 +3250,7 @@ void io_service::set_option_internal(int opt, va_list ap) // lgtm [cpp/poorly-do
       options_.print_ = *va_arg(ap, print_fn2_t*);
       break;
     case YOPT_S_NO_NEW_THREAD:
-      this->options_.no_new_thread_ = !!va_arg(ap, int);
+      this->options_.no_new_thread_ = static_cast<uint8_t>(yasio::clamp(va_arg(ap, int), 0, 2));
       break;
 #if defined(YASIO_SSL_BACKEND)
     case YOPT_S_SSL_CACERT:
@@ -2247,6 +3296,21 @@ void io_service::set_option_internal(int opt, va_list ap) // lgtm [cpp/poorly-do
     case YOPT_S_FORWARD_PACKET:
       options_.forward_packet_ = !!va_arg(ap, int);
       break;
+    case YOPT_S_PACKET_HANDLER:
+      options_.on_packet_    = va_arg(ap, packet_handler_fn_t);
+      options_.on_packet_ud_ = va_arg(ap, void*);
+      break;
+    case YOPT_S_EVENT_QUEUE_LIMITS: {
+      auto& limits               = options_.event_queue_limits_;
+      limits.max_events          = (std::max)(va_arg(ap, int), 0);
+      limits.max_bytes           = (std::max)(va_arg(ap, int), 0);
+      limits.transport_max_bytes = (std::max)(va_arg(ap, int), 0);
+      limits.enabled             = limits.max_events > 0 || limits.max_bytes > 0 || limits.transport_max_bytes > 0;
+      break;
+    }
+    case YOPT_S_TCP_ZEROCOPY:
+      options_.tcp_zerocopy_ = (std::max)(va_arg(ap, int), 0);
+      break;
 #if defined(_WIN32)
     case YOPT_S_HRES_TIMER:
       options_.hres_timer_ = !!va_arg(ap, int);
@@ -2257,6 +3321,20 @@ void io_service::set_option_internal(int opt, va_list ap) // lgtm [cpp/poorly-do
       options_.crtfile_ = va_arg(ap, const char*);
       options_.keyfile_ = va_arg(ap, const char*);
       break;
+    case YOPT_S_SSL_SESSION_CACHE:
+      options_.ssl_session_cache_ = va_arg(ap, int);
+      options_.ssl_early_data_    = !!va_arg(ap, int);
+      break;
+    case YOPT_S_SSL_KTLS:
+      options_.ssl_ktls_ = !!va_arg(ap, int);
+      break;
+    case YOPT_S_SSL_HANDSHAKE_WORKERS:
+      options_.ssl_handshake_workers_ = (std::max)(va_arg(ap, int), 0);
+      break;
+    case YOPT_S_SSL_POOL:
+      options_.ssl_pool_size_       = (std::max)(va_arg(ap, int), 0);
+      options_.ssl_release_buffers_ = !!va_arg(ap, int);
+      break;
 #endif
     case YOPT_C_UNPACK_PARAMS: {
       auto channel = channel_at(static_cast<size_t>(va_arg(ap, int)));
@@ -2269,6 +3347,24 @@ void io_service::set_option_internal(int opt, va_list ap) // lgtm [cpp/poorly-do
       }
       break;
     }
+    case YOPT_C_SEND_WATERMARKS: {
+      auto channel = channel_at(static_cast<size_t>(va_arg(ap, int)));
+      if (channel)
+      { // the low watermarks never exceeds high watermarks
+        auto& limits      = channel->sqparams_;
+        limits.high_bytes = (std::max)(va_arg(ap, int), 0);
+        limits.low_bytes  = yasio::clamp(va_arg(ap, int), 0, limits.high_bytes);
+        limits.high_ops   = (std::max)(va_arg(ap, int), 0);
+        limits.low_ops    = yasio::clamp(va_arg(ap, int), 0, limits.high_ops);
+      }
+      break;
+    }
+    case YOPT_C_SEND_QUEUE_POLICY: {
+      auto channel = channel_at(static_cast<size_t>(va_arg(ap, int)));
+      if (channel)
+        channel->sqparams_.policy = va_arg(ap, int);
+      break;
+    }
     case YOPT_C_UNPACK_STRIP: {
       auto channel = channel_at(static_cast<size_t>(va_arg(ap, int)));
       if (channel)
@@ -2406,6 +3502,33 @@ void io_service::set_option_internal(int opt, va_list ap) // lgtm [cpp/poorly-do
         channel->kcp_options().kcp_minrto_ = va_arg(ap, int);
       break;
     }
+    case YOPT_C_KCP_FLUSH_POLICY: {
+      auto channel = channel_at(static_cast<size_t>(va_arg(ap, int)));
+      if (channel)
+      {
+        channel->kcp_options().kcp_flush_policy_ = va_arg(ap, int);
+        channel->kcp_options().kcp_flush_delay_  = va_arg(ap, int);
+      }
+      break;
+    }
+    case YOPT_C_KCP_FEC: {
+      int index         = va_arg(ap, int);
+      int data_shards   = va_arg(ap, int);
+      int parity_shards = va_arg(ap, int);
+      auto channel      = channel_at(static_cast<size_t>(index));
+      if (channel)
+      {
+        // the shard indices must be distinct in GF(2^8), otherwise the recovered datagrams are corrupt
+        if (data_shards < 0 || parity_shards < 0 || data_shards + parity_shards > 256 || (!data_shards != !parity_shards))
+        {
+          YASIO_KLOGE("[index: %d] invalid kcp fec shards: data=%d, parity=%d, fec disabled", index, data_shards, parity_shards);
+          data_shards = parity_shards = 0;
+        }
+        channel->kcp_options().kcp_fec_data_shards_   = data_shards;
+        channel->kcp_options().kcp_fec_parity_shards_ = parity_shards;
+      }
+      break;
+    }
 #endif
     case YOPT_T_CONNECT: {
       auto transport = va_arg(ap, transport_handle_t);
@@ -47,6 +47,7 @@ SOFTWARE.
 #include "yasio/string_view.hpp"
 #include "yasio/object_pool.hpp"
 #include "yasio/byte_buffer.hpp"
+#include "yasio/chunked_buffer.hpp"
 #include "yasio/xxsocket.hpp"
 #include "yasio/io_watcher.hpp"
 
@@ -57,11 +58,19 @@ SOFTWARE.
 #if defined(YASIO_ENABLE_KCP)
 #  include "ikcp.h"
 struct yasio_kcp_options;
+namespace yasio
+{
+class fec_codec;
+}
 #endif
 
 #if defined(YASIO_SSL_BACKEND)
 typedef struct ssl_ctx_st yssl_ctx_st;
 struct yssl_st;
+namespace yasio
+{
+class thread_pool;
+}
 #endif
 
 #if defined(YASIO_USE_CARES)
@@ -119,6 +128,10 @@ enum
 
   // Don't start a new thread to run event loop
   // params: value:int(0)
+  // remarks:
+  //   a. 1: run the event loop in 'io_service::start' until the service stopped
+  //   b. 2: 'io_service::start' returns immediately, the caller drives the event loop by 'io_service::poll',
+  //      and the events are delivered to the event callback inside 'poll' without queuing, unless YOPT_S_NO_DISPATCH set
   YOPT_S_NO_NEW_THREAD,
 
   // Sets ssl verification cert, if empty, don't verify
@@ -296,6 +309,98 @@ enum
   // remarks: only works for udp client transport
   YOPT_T_DISCONNECT,
 
+  // The setting for kcp flush policy, see YKFP_XXX
+  // params: index:int, policy:int(YKFP_IMMEDIATE), delay:int(ms, only for YKFP_DEADLINE)
+  // remarks: the deferred policies merge segments queued by multiple sends into MTU sized datagrams
+  YOPT_C_KCP_FLUSH_POLICY,
+
+  // The setting for kcp forward error correction, disabled by default
+  // params: index:int, dataShards:int, parityShards:int
+  // remarks: the two endpoint must have same setting, dataShards + parityShards <= 256,
+  //          the invalid shards are rejected and fec disabled, 0 and 0 disables it explicitly,
+  //          each group of dataShards datagrams are followed by parityShards parity datagrams,
+  //          the kcp mtu is reduced by 8 bytes of fec header
+  YOPT_C_KCP_FEC,
+
+  // Sets ssl client session cache, the sessions are cached by host:port for resumption
+  // params: capacity:int(64), early_data:int(0)
+  // remarks:
+  //   a. this option must be set before 'io_service::start', capacity 0: disable session resumption
+  //   b. with early data(0-RTT), the open event fires before handshake finished when resumed session allows,
+  //      and the data written at open event sent with the handshake, early data may be replayed by attacker,
+  //      only enable it for idempotent requests
+  //   c. early data only supported by OpenSSL backend
+  YOPT_S_SSL_SESSION_CACHE,
+
+  // Sets whether hand over ssl record crypto to kernel(kTLS) after handshake
+  // params: enable:int(0)
+  // remarks:
+  //   a. this option must be set before 'io_service::start', works on Linux with OpenSSL 3 and tls module loaded,
+  //      otherwise fallback to user space crypto silently
+  //   b. when kernel encrypts the records sent, the transport writes plain data to socket directly
+  //   c. the kTLS connections do handshake by OpenSSL socket BIO which doesn't send with MSG_NOSIGNAL,
+  //      the SIGPIPE raised by ssl calls is blocked and discarded in the calling thread, no handler required
+  YOPT_S_SSL_KTLS,
+
+  // Sets the count of worker threads to run ssl server handshakes
+  // params: count:int(0)
+  // remarks:
+  //   a. this option must be set before 'io_service::start', 0: run handshakes on the io thread
+  //   b. each handshake step runs on a worker when the connection readable, the io thread keep serving
+  //      established connections while the workers doing the public key crypto
+  YOPT_S_SSL_HANDSHAKE_WORKERS,
+
+  // Sets ssl object pool and buffer policy for many short lived or idle connections
+  // params: capacity:int(0), release_buffers:int(1)
+  // remarks:
+  //   a. this option must be set before 'io_service::start', capacity 0(default): free the ssl objects when connection closed,
+  //      the pool is opt-in, it saves allocations but no measurable handshake throughput, see tests/sslchurn
+  //   b. the closed ssl objects are reset and reused by new connections of same role
+  //   c. release_buffers 1: the idle connections hold no record buffers, 0: keep the buffers to save
+  //      allocations of busy connections, OpenSSL only
+  YOPT_S_SSL_POOL,
+
+  // Sets the threshold of tcp zerocopy send(MSG_ZEROCOPY)
+  // params: threshold:int(0)
+  // remarks:
+  //   a. the message not less than threshold bytes sent without copying to kernel, 0: disable,
+  //      the zerocopy only worth for large message, i.e. >= 10KB
+  //   b. the message buffer kept until kernel notified, then the completion handler invoked,
+  //      so the handlers of zerocopy messages may be invoked after the ones sent later
+  //   c. Linux 4.14+ plain tcp only, the zerocopy disabled for the connection once kernel copied, i.e. loopback
+  YOPT_S_TCP_ZEROCOPY,
+
+  // Sets the send queue watermarks of channel transports
+  // params: index:int, high_bytes:int(0), low_bytes:int(0), high_ops:int(0), low_ops:int(0)
+  // remarks:
+  //   a. 0: unlimited, the write exceeds high watermark handled by YOPT_C_SEND_QUEUE_POLICY
+  //   b. the YEK_ON_WRITABLE event fires once the send queue drops to both low watermarks
+  //      after the high watermark exceeded, then the producer can resume writing
+  YOPT_C_SEND_WATERMARKS,
+
+  // Sets the policy of write exceeds the send queue high watermark, see YSQP_XXX
+  // params: index:int, policy:int(YSQP_REJECT)
+  YOPT_C_SEND_QUEUE_POLICY,
+
+  // Sets the limits of events queued for dispatch, the receive backpressure
+  // params: max_events:int(0), max_bytes:int(0), transport_max_bytes:int(0)
+  // remarks:
+  //   a. this option must be set before 'io_service::start', 0: unlimited
+  //   b. the bytes are the packets size, the transport_max_bytes limits the packets of each transport
+  //   c. when exceeds, the tcp transports stop reading until 'dispatch' drains the queue to half of limits,
+  //      then the kernel receive window push back the sender, the udp/kcp transports never paused
+  YOPT_S_EVENT_QUEUE_LIMITS,
+
+  // Sets the inline packet handler, native C++ ONLY
+  // params: handler:packet_handler_fn_t, ud:void*
+  // remarks:
+  //   a. the packets are passed to the handler at io_service thread without io_event allocation,
+  //      the YEK_ON_PACKET events no longer fired, the other events not affected
+  //   b. the data only valid during the call, the handler should process or forward it in place
+  //   c. with YOPT_S_FORWARD_PACKET, the handler receives the raw data without unpacking
+  //   d. this option must be set before 'io_service::start', nullptr: disable
+  YOPT_S_PACKET_HANDLER,
+
   // Sets io_base sockopt
   // params: io_base*,level:int,optname:int,optval:int,optlen:int
   YOPT_B_SOCKOPT = 201,
@@ -336,12 +441,37 @@ enum
   YCF_EXCLUSIVEADDRUSE = 1 << 10,
 };
 
+// kcp flush policies
+enum
+{
+  /* Flush at each send, the default behavior */
+  YKFP_IMMEDIATE,
+
+  /* Flush once at end of current event loop iteration */
+  YKFP_END_OF_LOOP,
+
+  /* Flush when the delay elapsed or at next kcp update, whichever is earlier */
+  YKFP_DEADLINE,
+};
+
+// send queue policies, see: YOPT_C_SEND_WATERMARKS
+enum
+{
+  /* Reject the write with yasio::errc::send_queue_full */
+  YSQP_REJECT,
+
+  /* Accept the write, and drop the oldest ops not started sending until below high watermark,
+     the handlers of dropped ops are invoked with yasio::errc::send_queue_full */
+  YSQP_DROP_OLDEST,
+};
+
 // event kinds
 enum
 {
   YEK_ON_OPEN = 1,
   YEK_ON_CLOSE,
   YEK_ON_PACKET,
+  YEK_ON_WRITABLE, // the send queue drops to low watermarks, see: YOPT_C_SEND_WATERMARKS
   YEK_CONNECT_RESPONSE = YEK_ON_OPEN,   // implicit deprecated alias
   YEK_CONNECTION_LOST  = YEK_ON_CLOSE,  // implicit deprecated alias
   YEK_PACKET           = YEK_ON_PACKET, // implicit deprecated alias
@@ -366,6 +496,7 @@ class io_channel;
 class io_transport;
 class io_transport_tcp; // tcp client/server
 class io_transport_ssl; // ssl client
+struct ssl_handshake_job;
 class io_transport_udp; // udp client/server
 class io_transport_kcp; // kcp client/server
 class io_service;
@@ -377,6 +508,7 @@ typedef io_transport* transport_handle_t;
 typedef std::shared_ptr<xxsocket> xxsocket_ptr;
 
 typedef std::unique_ptr<io_send_op> send_op_ptr;
+typedef std::shared_ptr<const sbyte_buffer> shared_buffer_ptr;
 typedef std::unique_ptr<io_event> event_ptr;
 typedef std::shared_ptr<highp_timer> highp_timer_ptr;
 
@@ -389,6 +521,7 @@ typedef std::function<int(void* d, int n)> decode_len_fn_t;
 typedef std::function<int(std::vector<ip::endpoint>&, const char*, unsigned short)> resolv_fn_t;
 typedef std::function<void(const char*)> print_fn_t;
 typedef std::function<void(int level, const char*)> print_fn2_t;
+typedef void (*packet_handler_fn_t)(void* ud, transport_handle_t, const char* data, int len);
 
 typedef std::pair<highp_timer*, timer_cb_t> timer_impl_t;
 
@@ -398,6 +531,9 @@ typedef highp_timer_ptr deadline_timer_ptr;
 typedef event_cb_t io_event_cb_t;
 typedef completion_cb_t io_completion_cb_t;
 
+// Make the immutable buffer can be written to many transports without copying, see: io_service::broadcast
+inline shared_buffer_ptr make_shared_buffer(sbyte_buffer&& buffer) { return std::make_shared<const sbyte_buffer>(std::move(buffer)); }
+
 namespace
 {
 static const int yasio__max_rcvbuf = YASIO_SZ(64, k);
@@ -410,6 +546,20 @@ enum ssl_role
   YSSL_SERVER,
 };
 
+// The ssl handshake statistics
+struct ssl_stats {
+  unsigned int handshakes;          // the finished client handshakes
+  unsigned int resumed;             // the client handshakes resumed from session cache
+  unsigned int resumed_unknown;     // the client handshakes can't tell resumed or not, i.e. TLS 1.3 of mbedtls
+  unsigned int early_data_accepted; // the client handshakes with early data(0-RTT) accepted by server
+  unsigned int server_handshakes;   // the finished server handshakes
+  unsigned int server_handshake_rate; // the server handshakes finished in last second
+  double resumption_rate() const
+  {
+    return handshakes > resumed_unknown ? static_cast<double>(resumed) / (handshakes - resumed_unknown) : 0.0;
+  }
+};
+
 struct io_hostent {
   io_hostent() = default;
   io_hostent(cxx17::string_view ip, u_short port) : host_(cxx17::svtos(ip)), port_(port) {}
@@ -625,6 +775,15 @@ private:
   } uparams_;
   decode_len_fn_t decode_len_;
 
+  // The send queue limits of transports, 0: unlimited
+  struct __unnamed02 {
+    int high_bytes = 0;
+    int low_bytes  = 0;
+    int high_ops   = 0;
+    int low_ops    = 0;
+    int policy     = YSQP_REJECT;
+  } sqparams_;
+
   /*
   !!! for tcp/udp client to bind local specific network adapter, empty for any
   */
@@ -666,10 +825,17 @@ public:
     data_ = const_buffer;
     size_ = const_buffer_size;
   }
+  explicit io_send_buffer(shared_buffer_ptr shared_buffer)
+  {
+    shared_buffer_ = std::move(shared_buffer);
+    data_          = shared_buffer_->data();
+    size_          = shared_buffer_->size();
+  }
   io_send_buffer(const io_send_buffer&) = delete;
   io_send_buffer(io_send_buffer&& rhs) YASIO__NOEXCEPT
   {
     mutable_buffer_ = std::move(rhs.mutable_buffer_);
+    shared_buffer_  = std::move(rhs.shared_buffer_);
     data_           = rhs.data_;
     size_           = rhs.size_;
   }
@@ -681,6 +847,7 @@ public:
 
 private:
   yasio::sbyte_buffer mutable_buffer_;
+  shared_buffer_ptr shared_buffer_; // the immutable buffer shared by many ops, i.e. broadcast
 
   const char* data_;
   size_t size_;
@@ -696,13 +863,97 @@ public:
   io_send_buffer buffer_; // sending data buffer
   completion_cb_t handler_;
 
+  bool zerocopy_         = false; // whether sent with MSG_ZEROCOPY, see: YOPT_S_TCP_ZEROCOPY
+  uint32_t zerocopy_end_ = 0;     // the zerocopy send id of op last sent + 1
+
   YASIO__DECL virtual int perform(transport_handle_t transport, const void* buf, int n, int& error);
 
+  // Write the remain data from offset_, returns bytes sent, the caller advance offset_
+  YASIO__DECL virtual int write_some(transport_handle_t transport, int& error);
+
+  // Total bytes to send
+  virtual size_t size() const { return buffer_.size(); }
+
 #if !defined(YASIO_DISABLE_OBJECT_POOL)
   DEFINE_CONCURRENT_OBJECT_POOL_ALLOCATION(io_send_op, 128)
 #endif
 };
 
+// for tcp transport only, send the chunks by gather write, the chunks returned to pool after op complete
+class YASIO_API io_send_chain_op : public io_send_op {
+public:
+  io_send_chain_op(chunked_buffer&& chain, completion_cb_t&& handler)
+      : io_send_op(io_send_buffer{nullptr, 0}, std::move(handler)), chain_(std::move(chain))
+  {}
+
+  YASIO__DECL int write_some(transport_handle_t transport, int& error) override;
+
+  size_t size() const override { return chain_.length(); }
+
+#if !defined(YASIO_DISABLE_OBJECT_POOL)
+  DEFINE_CONCURRENT_OBJECT_POOL_ALLOCATION(io_send_chain_op, 128)
+#endif
+private:
+  chunked_buffer chain_;
+  size_t chunk_index_  = 0; // the chunk sending
+  size_t chunk_offset_ = 0; // read pos of the chunk sending
+};
+
+// send the external spans by gather write when possible, the spans must keep valid until op complete
+class YASIO_API io_send_spans_op : public io_send_op {
+public:
+  io_send_spans_op(const cxx17::string_view* spans, int count, completion_cb_t&& handler)
+      : io_send_op(io_send_buffer{nullptr, 0}, std::move(handler))
+  {
+    for (int i = 0; i < count; ++i)
+    {
+      if (!spans[i].empty())
+      {
+        spans_.push_back(spans[i]);
+        size_ += spans[i].size();
+      }
+    }
+  }
+
+  YASIO__DECL int write_some(transport_handle_t transport, int& error) override;
+
+  size_t size() const override { return size_; }
+
+#if !defined(YASIO_DISABLE_OBJECT_POOL)
+  DEFINE_CONCURRENT_OBJECT_POOL_ALLOCATION(io_send_spans_op, 128)
+#endif
+private:
+  std::vector<cxx17::string_view> spans_;
+  size_t size_        = 0;
+  size_t span_index_  = 0; // the span sending
+  size_t span_offset_ = 0; // read pos of the span sending
+};
+
+// for tcp transport only, send the range of file by sendfile or splice, read chunk by chunk when unavailable
+class YASIO_API io_send_file_op : public io_send_op {
+public:
+  io_send_file_op(int fd, long long offset, size_t length, completion_cb_t&& handler)
+      : io_send_op(io_send_buffer{nullptr, 0}, std::move(handler)), fd_(fd), file_offset_(offset), length_(length)
+  {}
+
+  YASIO__DECL int write_some(transport_handle_t transport, int& error) override;
+
+  size_t size() const override { return length_; }
+
+#if !defined(YASIO_DISABLE_OBJECT_POOL)
+  DEFINE_CONCURRENT_OBJECT_POOL_ALLOCATION(io_send_file_op, 128)
+#endif
+private:
+  YASIO__DECL int read_chunk(int& error);
+
+  int fd_;
+  long long file_offset_; // the file position of next sendfile or read, not used for pipe
+  size_t length_;
+  int mode_ = 0; // the send method, see: send_file_mode
+  sbyte_buffer chunk_; // the file data read, for read fallback only
+  size_t chunk_offset_ = 0;
+};
+
 // for udp transport only
 class YASIO_API io_sendto_op : public io_send_op {
 public:
@@ -721,6 +972,9 @@ class io_transport : public io_base {
   friend class io_service;
   friend class io_send_op;
   friend class io_sendto_op;
+  friend class io_send_chain_op;
+  friend class io_send_spans_op;
+  friend class io_send_file_op;
   friend class io_event;
 
   io_transport(const io_transport&) = delete;
@@ -751,20 +1005,44 @@ protected:
   // For log macro only
   YASIO__DECL const print_fn2_t& __get_cprint() const;
 
-  // Call at user thread
+  // Call at user thread, queue the op only, the caller wakeup the io_service
   YASIO__DECL virtual int write(io_send_buffer&&, completion_cb_t&&);
 
-  // Call at user thread
+  // Call at user thread, tcp only, queue the op only
+  YASIO__DECL int write_chain(chunked_buffer&&, completion_cb_t&&);
+  YASIO__DECL int write_spans(const cxx17::string_view* spans, int count, completion_cb_t&&);
+
+  // Call at user thread, tcp only, queue the op only
+  YASIO__DECL int write_file(int fd, long long offset, size_t length, completion_cb_t&&);
+
+  // Call at user thread, queue the op only, the caller wakeup the io_service
   virtual int write_to(io_send_buffer&&, const ip::endpoint&, completion_cb_t&&)
   {
     YASIO_LOG("[warning] io_transport doesn't support 'write_to' operation!");
     return 0;
   }
 
+  // Call at user thread, queue the op if the send queue below high watermarks or policy allows,
+  // returns bytes to send or yasio::errc::send_queue_full
+  YASIO__DECL int enqueue(send_op_ptr&& op);
+
   YASIO__DECL int call_read(void* data, int size, int revent, int& error);
   YASIO__DECL int call_write(io_send_op*, int& error);
   YASIO__DECL void complete_op(io_send_op*, int error);
 
+  // Call at io_service, drop the oldest ops by YSQP_DROP_OLDEST, and fire YEK_ON_WRITABLE when drops to low watermarks
+  YASIO__DECL void check_watermarks();
+  YASIO__DECL void release_op(io_send_op*);
+
+  // The zerocopy send, see: YOPT_S_TCP_ZEROCOPY
+  YASIO__DECL int write_zerocopy(io_send_op*, int& error);
+  // Invoke the handlers of zerocopy ops notified by kernel
+  YASIO__DECL void harvest_zerocopy();
+
+  // Watch the pipe readable when the send file op drained it, instead of the socket writable, see: io_service::write_file
+  YASIO__DECL void watch_source(int fd);
+  YASIO__DECL void unwatch_source();
+
   // Call at io_service
   YASIO__DECL virtual int do_read(int revent, int& error, highp_time_t& wait_duration);
 
@@ -788,8 +1066,32 @@ protected:
 
   std::function<int(const void*, int, const ip::endpoint*, int&)> write_cb_;
   std::function<int(void*, int, int, int&)> read_cb_;
+  // The gather write primitive, only available for plain tcp
+  std::function<int(const cxx17::string_view*, int, int&)> writev_cb_;
 
   privacy::concurrent_queue<send_op_ptr> send_queue_;
+
+  // The bytes of packet events queued for dispatch, io thread only, see: YOPT_S_EVENT_QUEUE_LIMITS
+  size_t queued_event_bytes_ = 0;
+  bool read_paused_          = false;
+
+  // The bytes and count of ops in send queue, see: YOPT_C_SEND_WATERMARKS
+  std::atomic<size_t> queued_bytes_{0};
+  std::atomic<int> queued_ops_{0};
+  enum
+  {
+    blocked_low   = 1, // the high watermark exceeded, waiting drops to low watermarks
+    blocked_drain = 2, // an op exceeds the high watermark alone rejected, waiting the queue drained
+  };
+  std::atomic<uint8_t> blocked_{0};
+
+  // The zerocopy state, the ops sent are kept until kernel notified, see: YOPT_S_TCP_ZEROCOPY
+  int zerocopy_threshold_ = 0; // 0: disabled
+  uint32_t zerocopy_next_ = 0; // the count of zerocopy sends, same as kernel counter
+  uint32_t zerocopy_done_ = 0; // the count of zerocopy sends notified by kernel
+  std::vector<send_op_ptr> zerocopy_ops_;
+
+  int source_fd_ = -1; // the pipe watched, see: watch_source
 };
 
 class YASIO_API io_transport_tcp : public io_transport {
@@ -806,9 +1108,21 @@ public:
 
   YASIO__DECL void do_ssl_shutdown();
 
+  // The ssl object of transport, nullptr once closed
+  yssl_st* get_ssl() const { return ssl_; }
+
 protected:
-  YASIO__DECL int do_ssl_handshake(int& error); // always invoke at do_read
+  YASIO__DECL int do_ssl_handshake(int revent, int& error); // always invoke at do_read
+  YASIO__DECL bool do_write(highp_time_t& wait_duration) override;
   yssl_st* ssl_ = nullptr;
+
+  // The early data state:
+  //   1: open event fired before handshake, 2: early data writable, handshake continues at next read
+  //   3: replaying early data rejected by server
+  u_short early_state_ = 0;
+
+  // The handshake step running on worker, see: YOPT_S_SSL_HANDSHAKE_WORKERS
+  std::shared_ptr<ssl_handshake_job> hs_job_;
 };
 #else
 class io_transport_ssl {};
@@ -858,16 +1172,26 @@ protected:
 
   YASIO__DECL int do_read(int revent, int& error, highp_time_t& wait_duration) override;
 
+  YASIO__DECL int handle_input(char* buf, int len, int& error, highp_time_t& wait_duration) override;
+
+  // Drain all queued sends to kcp at once, the segments will be merged by the deferred flush
   YASIO__DECL bool do_write(highp_time_t& wait_duration) override;
 
-  YASIO__DECL int handle_input(char* buf, int len, int& error, highp_time_t& wait_duration) override;
+  // Mark the kcp state changed by send or input, ikcp_update will be called at current loop
+  YASIO__DECL void schedule_now();
 
-  int interval() const { return kcp_->interval * std::milli::den; }
+  // Flush the kcp segments by flush policy, and schedule the transport
+  YASIO__DECL void schedule_flush();
 
   sbyte_buffer rawbuf_; // the low level raw buffer
   ikcpcb* kcp_{nullptr};
   IUINT32 expire_time_{0}; // the next expire time(ms) to call ikcp_update
+  int sched_index_ = -1;   // the index at io_service kcp deadline heap, -1: not scheduled
+  int flush_policy_   = 0;     // see YKFP_XXX
+  int flush_delay_    = 0;     // the max delay(ms) of YKFP_DEADLINE
+  bool flush_pending_ = false; // whether has segments queued by deferred flush policy
   std::function<int(const void*, int, const ip::endpoint*, int&)> underlaying_write_cb_;
+  std::unique_ptr<fec_codec> fec_; // the fec layer between kcp and udp, nullptr: disabled
 };
 #else
 class io_transport_kcp {};
@@ -1038,6 +1362,11 @@ public:
   // the additional API to get rtt of tcp transport
   YASIO__DECL static unsigned int tcp_rtt(transport_handle_t);
 
+#if defined(YASIO_SSL_BACKEND)
+  // the ssl handshake statistics, see also: YOPT_S_SSL_SESSION_CACHE, YOPT_S_SSL_HANDSHAKE_WORKERS
+  YASIO__DECL ssl_stats get_ssl_stats() const;
+#endif
+
 public:
   YASIO__DECL io_service();
   YASIO__DECL io_service(int channel_count);
@@ -1060,6 +1389,21 @@ public:
   bool is_running() const { return this->state_ == io_service::state::RUNNING; }
   bool is_stopping() const { return !!this->stop_flag_; }
 
+  /* summary: run one iteration of the event loop, for embedding into an external loop, i.e. game loop
+  ** params:
+  **   timeout_us: the max time to wait io events, 0: don't wait
+  ** returns: false when the service not running, or stopped by this iteration
+  ** remark:
+  ** a. only works with YOPT_S_NO_NEW_THREAD = 2, and must be called on the thread which invoke 'start'
+  ** b. the 'stop' called outside 'poll' drives the remaining iterations until all transports closed
+  */
+  YASIO__DECL bool poll(highp_time_t timeout_us = 0);
+
+  // The descriptor becomes readable when the io_service has io events to poll, for integrating into
+  // an external epoll/kqueue loop, returns -1 if the io_watcher of current platform isn't pollable,
+  // and the timers still require invoking 'poll' periodically
+  int pollable_fd() const { return io_watcher_.pollable_descriptor(); }
+
   // should call at the thread who care about async io
   // events(CONNECT_RESPONSE,CONNECTION_LOST,PACKET), such cocos2d-x opengl or
   // any other game engines' render thread.
@@ -1070,6 +1414,17 @@ public:
   YASIO__DECL void set_option(int opt, ...);
   YASIO__DECL void set_option_internal(int opt, va_list args);
 
+  // Sets the inline packet handler object, see YOPT_S_PACKET_HANDLER, the handler invoked as
+  // (*handler)(transport_handle_t, const char* data, int len) and must outlive the service
+  template <typename _Handler>
+  void set_packet_handler(_Handler* handler)
+  {
+    packet_handler_fn_t fn = [](void* ud, transport_handle_t transport, const char* data, int len) {
+      (*static_cast<_Handler*>(ud))(transport, data, len);
+    };
+    this->set_option(YOPT_S_PACKET_HANDLER, fn, static_cast<void*>(handler));
+  }
+
   // open a channel, default: YCK_TCP_CLIENT
   YASIO__DECL bool open(size_t index, int kind = YCK_TCP_CLIENT);
 
@@ -1102,6 +1457,61 @@ public:
   YASIO__DECL int write(transport_handle_t thandle, sbyte_buffer buffer, completion_cb_t completion_handler = nullptr);
   YASIO__DECL int forward(transport_handle_t thandle, const void* buf, size_t len, completion_cb_t completion_handler);
 
+  /*
+  ** Summary: Write the immutable buffer shared with other writes, e.g. write(thandle, make_shared_buffer(std::move(obs.buffer())))
+  ** remark: The buffer released when the last op referencing it completed, it's safe to write it to any transports
+  */
+  YASIO__DECL int write(transport_handle_t thandle, shared_buffer_ptr buffer, completion_cb_t completion_handler = nullptr);
+
+  /*
+  ** Summary: Write the same immutable buffer to many transports, the ops queued with one wakeup
+  ** retval: the count of transports the buffer queued to, the closed ones are skipped
+  ** remark:
+  **        + The payload isn't copied, every op references the shared buffer
+  **        + TCP/UDP/KCP: Same as write, the connected UDP sends to last peer address
+  */
+  YASIO__DECL int broadcast(const transport_handle_t* thandles, size_t count, const shared_buffer_ptr& buffer);
+  int broadcast(const std::vector<transport_handle_t>& thandles, const shared_buffer_ptr& buffer)
+  {
+    return broadcast(thandles.data(), thandles.size(), buffer);
+  }
+
+  /*
+  ** Summary: Write the chunks built by chunked_obstream, e.g. write(thandle, std::move(obs.buffer()))
+  ** remark:
+  **        + TCP: Send as gather write, the chunks returned to pool when write complete
+  **        + SSL: Send chunk by chunk
+  **        + UDP/KCP: The chunks are flatten to one packet
+  */
+  YASIO__DECL int write(transport_handle_t thandle, chunked_buffer&& buffer, completion_cb_t completion_handler = nullptr);
+
+  /*
+  ** Summary: Write the external spans as one op without copy, e.g. the head and body of a http request
+  ** remark:
+  **        + The spans must keep valid until the completion handler invoked, same as forward
+  **        + TCP: Send as gather write
+  **        + SSL: Send span by span
+  **        + UDP/KCP: The spans are copied to one packet
+  */
+  YASIO__DECL int forward(transport_handle_t thandle, const cxx17::string_view* spans, int count, completion_cb_t completion_handler);
+
+  /*
+  ** Summary: Write the range of file without reading it to user space when possible
+  ** params:
+  **        'fd': the file descriptor, must keep open until the completion handler invoked
+  **        'offset': the start position of file, ignored for pipe
+  **        'length': the bytes to send, -1: to the end of regular file
+  ** retval: < 0: failed, otherwise the bytes to send, at most INT_MAX
+  ** remark:
+  **        + TCP: sendfile on Linux and macOS, splice from pipe on Linux, chunked read otherwise
+  **        + SSL: chunked read and write through ssl, sendfile when kernel TLS enabled
+  **        + The completion handler invoked when the whole range handed to kernel
+  **        + The pipe drained is watched for readable, the op continues when more data written to it,
+  **          the pipe fd is set to non-blocking mode
+  **        + UDP/KCP: Not supported
+  */
+  YASIO__DECL int write_file(transport_handle_t thandle, int fd, long long offset, long long length, completion_cb_t completion_handler = nullptr);
+
   /*
    ** Summary: Write data to unconnected UDP transport with specified address.
    ** retval: < 0: failed
@@ -1114,6 +1524,7 @@ public:
     return write_to(thandle, sbyte_buffer{(const char*)buf, (const char*)buf + len}, to, std::move(completion_handler));
   }
   YASIO__DECL int write_to(transport_handle_t thandle, sbyte_buffer buffer, const ip::endpoint& to, completion_cb_t completion_handler = nullptr);
+  YASIO__DECL int write_to(transport_handle_t thandle, shared_buffer_ptr buffer, const ip::endpoint& to, completion_cb_t completion_handler = nullptr);
   YASIO__DECL int forward_to(transport_handle_t thandle, const void* buf, size_t len, const ip::endpoint& to, completion_cb_t completion_handler);
 
   // The highp_timer support, !important, the callback is called on the thread of io_service
@@ -1157,10 +1568,38 @@ private:
   YASIO__DECL void process_timers();
   YASIO__DECL void process_deferred_events();
 
+  // The receive backpressure, see: YOPT_S_EVENT_QUEUE_LIMITS
+  YASIO__DECL void track_event(io_event* event);
+  // Untrack the event dispatched, the bytes per transport are posted back to io thread by released
+  YASIO__DECL void untrack_event(io_event* event, std::pair<unsigned int, size_t>& released);
+  // Apply the bytes released by dispatch to transports, io thread only
+  YASIO__DECL void release_event_bytes();
+  // Whether the event queue exceeds the limits, the shift 1 for half of limits
+  YASIO__DECL bool is_event_queue_full(transport_handle_t transport, int shift) const;
+  YASIO__DECL void pause_read(transport_handle_t);
+  YASIO__DECL void resume_reads();
+
   YASIO__DECL void wakeup();
 
+  // Wakeup the io_service to flush the ops just queued, returns n
+  YASIO__DECL int post_write(int n);
+
   YASIO__DECL highp_time_t get_timeout(highp_time_t usec);
 
+#if defined(YASIO_ENABLE_KCP)
+  // The kcp transports are kept in a min-heap keyed by the deadline from ikcp_check,
+  // only the due transports are updated, so the idle transports cost nothing.
+  YASIO__DECL void schedule_kcp(io_transport_kcp*, IUINT32 expire_time);
+  YASIO__DECL void unschedule_kcp(io_transport_kcp*);
+  YASIO__DECL void process_kcp_transports();
+  YASIO__DECL void kcp_sift_up(int index);
+  YASIO__DECL void kcp_sift_down(int index);
+  IUINT32 kcp_clock() const
+  {
+    return static_cast<IUINT32>(std::chrono::duration_cast<std::chrono::milliseconds>(current_time_.time_since_epoch()).count());
+  }
+#endif
+
   YASIO__DECL int do_resolve(io_channel* ctx);
   YASIO__DECL void do_connect(io_channel*);
   YASIO__DECL void do_connect_completion(io_channel*);
@@ -1168,6 +1607,7 @@ private:
 #if defined(YASIO_SSL_BACKEND)
   YASIO__DECL yssl_ctx_st* init_ssl_context(ssl_role role);
   YASIO__DECL void cleanup_ssl_context(ssl_role role);
+  YASIO__DECL void count_ssl_server_handshake();
 #endif
 
 #if defined(YASIO_USE_CARES)
@@ -1193,6 +1633,10 @@ private:
 
   // The major non-blocking event-loop
   YASIO__DECL void run(void);
+  // The event loop iteration, the max_wait_us < 0: wait until the next timeout, returns false when poll_io failed fatally
+  YASIO__DECL bool run_once(highp_time_t max_wait_us);
+  // Prepare the per-loop resources, release by handle_worker_exit
+  YASIO__DECL void prepare_loop();
 
   YASIO__DECL bool do_read(transport_handle_t);
   bool do_write(transport_handle_t transport) { return transport->do_write(this->wait_duration_); }
@@ -1210,12 +1654,22 @@ private:
     auto event = cxx14::make_unique<io_event>(std::forward<_Types>(args)...);
     if (options_.on_defer_event_ && options_.on_defer_event_(event))
       return;
+    if (options_.no_new_thread_ == 2 && !options_.no_dispatch_)
+    { // the caller thread is io thread, no hand-off required
+      options_.on_event_(std::move(event));
+      return;
+    }
+    if (options_.event_queue_limits_.enabled)
+      track_event(event.get());
     events_.emplace(std::move(event));
   }
-  template <typename... _Types>
-  inline void forward_packet(_Types&&... args)
+  // Forward the packet without unpacking, to the inline packet handler if set
+  inline void forward_packet(transport_handle_t transport, char* data, int len)
   {
-    options_.on_event_(cxx14::make_unique<io_event>(std::forward<_Types>(args)...));
+    if (options_.on_packet_)
+      options_.on_packet_(options_.on_packet_ud_, transport, data, len);
+    else
+      options_.on_event_(cxx14::make_unique<io_event>(transport->cindex(), io_packet_view{data, len}, transport));
   }
 
   // new/delete client socket connection channel
@@ -1263,6 +1717,15 @@ private:
   std::vector<transport_handle_t> tpool_;
   std::map<ip::endpoint, transport_handle_t> transport_map_;
 
+  // The events queued for dispatch and the transports stop reading, see: YOPT_S_EVENT_QUEUE_LIMITS
+  std::atomic<int> queued_events_{0};
+  std::atomic<size_t> queued_event_bytes_{0};
+  std::atomic<bool> reads_paused_{false};
+  std::vector<transport_handle_t> paused_transports_;
+  // The packet bytes dispatched per transport id, the user thread never touches transports
+  privacy::concurrent_queue<std::pair<unsigned int, size_t>, true> released_event_bytes_;
+  std::vector<std::pair<unsigned int, size_t>> released_bytes_;
+
   // timer support timer_pair, back is earliest expire timer
   std::vector<timer_impl_t> timer_queue_;
   std::recursive_mutex timer_queue_mtx_;
@@ -1272,9 +1735,12 @@ private:
 
   io_watcher io_watcher_;
 
-  int nsched_     = 0;
   int sched_freq_ = 5 * 60 * 1000 * 1000; // 5mins in us
 
+#if defined(YASIO_ENABLE_KCP)
+  std::vector<io_transport_kcp*> kcp_sched_; // the kcp deadline heap, front is the earliest
+#endif
+
   // options
   struct __unnamed_options {
     highp_time_t connect_timeout_     = 10LL * std::micro::den;
@@ -1302,12 +1768,25 @@ private:
       int probs    = 10;
     } tcp_keepalive_;
 
-    bool no_new_thread_ = false;
+    int tcp_zerocopy_ = 0;
+
+    // the receive backpressure settings
+    struct __unnamed02 {
+      bool enabled            = false;
+      int max_events          = 0;
+      int max_bytes           = 0;
+      int transport_max_bytes = 0;
+    } event_queue_limits_;
+
+    uint8_t no_new_thread_ = 0;
 
     // The resolve function
     resolv_fn_t resolv_;
     // the event callback
     event_cb_t on_event_;
+    // the inline packet handler
+    packet_handler_fn_t on_packet_ = nullptr;
+    void* on_packet_ud_            = nullptr;
     // The custom debug print function
     print_fn2_t print_;
 
@@ -1318,6 +1797,17 @@ private:
     // SSL server
     std::string crtfile_;
     std::string keyfile_;
+
+    // SSL client session cache
+    int ssl_session_cache_ = 64;
+    bool ssl_early_data_   = false;
+
+    bool ssl_ktls_ = false;
+
+    int ssl_handshake_workers_ = 0;
+
+    int ssl_pool_size_        = 0;
+    bool ssl_release_buffers_ = true;
 #endif
 
 #if defined(YASIO_USE_CARES)
@@ -1329,8 +1819,20 @@ private:
   mutable u_short ipsv_ = 0;
   // The stop flag to notify all transports needs close
   uint8_t stop_flag_ = 0;
+  // Whether the caller thread is inside io_service::poll
+  bool polling_ = false;
 #if defined(YASIO_SSL_BACKEND)
   yssl_ctx_st* ssl_roles_[2];
+  std::atomic<unsigned int> ssl_handshakes_{0};
+  std::atomic<unsigned int> ssl_resumed_{0};
+  std::atomic<unsigned int> ssl_resumed_unknown_{0};
+  std::atomic<unsigned int> ssl_early_data_accepted_{0};
+  std::atomic<unsigned int> ssl_server_handshakes_{0};
+  // the server handshakes counted per second
+  std::atomic<long long> ssl_rate_start_{0};
+  std::atomic<unsigned int> ssl_rate_count_{0};
+  std::atomic<unsigned int> ssl_rate_last_{0};
+  std::unique_ptr<thread_pool> ssl_workers_;
 #endif
 #if defined(YASIO_USE_CARES)
   ares_channel ares_         = nullptr; // the ares handle for non blocking io dns resolve support
@@ -33,10 +33,17 @@ SOFTWARE.
 #include <limits>
 #include <stack>
 #include <fstream>
+#include <type_traits>
 #include "yasio/string_view.hpp"
 #include "yasio/endian_portable.hpp"
 #include "yasio/utils.hpp"
 #include "yasio/byte_buffer.hpp"
+#include "yasio/chunked_buffer.hpp"
+#include "yasio/impl/stream_vbyte.hpp"
+#include "yasio/impl/half_array.hpp"
+#if YASIO__HAS_CXX20
+#  include <span>
+#endif
 namespace yasio
 {
 enum : size_t
@@ -52,13 +59,24 @@ inline void write_ix_impl(_Stream* stream, _Intty value)
   // Write out an int 7 bits at a time.  The high bit of the byte,
   // when on, tells reader to continue reading more bytes.
   auto v = (typename std::make_unsigned<_Intty>::type)value; // support negative numbers
-  while (v >= 0x80)
+  if (v < 0x80)
   {
-    stream->write_byte((uint8_t)((uint32_t)v | 0x80));
-    v >>= 7;
+    stream->write_byte((uint8_t)v);
+    return;
   }
-  stream->write_byte((uint8_t)v);
+
+  // encode to stack and write once, only one capacity check per value
+  uint8_t buf[(sizeof(_Intty) * 8 + 6) / 7];
+  int n = 0;
+  do
+  {
+    buf[n++] = (uint8_t)((uint32_t)v | 0x80);
+    v >>= 7;
+  } while (v >= 0x80);
+  buf[n++] = (uint8_t)v;
+  stream->write_bytes(buf, n);
 }
+
 template <typename _Stream, typename _Intty, bool _LargeInt>
 struct write_ix_helper {};
 
@@ -118,6 +136,15 @@ public:
     ::memset(first_ + this->pos_, val, count);
     this->pos_ += count;
   }
+  // advance n bytes and return the start for overwrite
+  char* prepare_bytes(size_t n)
+  {
+    if (yasio__unlikely((n + pos_) > this->max_size()))
+      YASIO__THROW(std::out_of_range("fixed_buffer_span: out of range"), nullptr);
+    auto ptr = first_ + this->pos_;
+    this->pos_ += n;
+    return ptr;
+  }
 
   void reserve(size_t /*capacity*/){};
   void shrink_to_fit(){};
@@ -168,6 +195,12 @@ public:
     return n;
   }
   void fill_bytes(size_t count, uint8_t val) { outs_->insert(outs_->end(), static_cast<size_type>(count), val); }
+  char* prepare_bytes(size_t n)
+  {
+    auto offset = outs_->size();
+    outs_->resize(static_cast<size_type>(offset + n));
+    return outs_->data() + offset;
+  }
   void reserve(size_t capacity) { outs_->reserve(static_cast<size_type>(capacity)); }
   void shrink_to_fit() { outs_->shrink_to_fit(); };
   void clear() { outs_->clear(); }
@@ -365,6 +398,75 @@ public:
     write_bytes(&nv, sizeof(nv));
   }
 
+  /* write arithmetic array without length field, reserve once and convert all elements in bulk */
+  template <typename _Nty>
+  void write_array(const _Nty* values, size_t count)
+  {
+    static_assert(std::is_arithmetic<_Nty>::value, "yasio: write_array requires arithmetic type!");
+    if (count)
+    {
+      auto ptr = outs_->prepare_bytes(count * sizeof(_Nty));
+      if (ptr)
+        convert_traits_type::template to_array<_Nty>(ptr, values, count);
+    }
+  }
+  template <typename _Nty, typename _Alloc>
+  void write_array(const std::vector<_Nty, _Alloc>& values)
+  {
+    write_array(values.data(), values.size());
+  }
+  template <typename _Nty, size_t _Size>
+  void write_array(const std::array<_Nty, _Size>& values)
+  {
+    write_array(values.data(), _Size);
+  }
+  template <typename _Nty, size_t _Size>
+  void write_array(const _Nty (&values)[_Size])
+  {
+    write_array(&values[0], _Size);
+  }
+#if YASIO__HAS_CXX20
+  template <typename _Nty, size_t _Extent>
+  void write_array(std::span<_Nty, _Extent> values)
+  {
+    write_array(values.data(), values.size());
+  }
+#endif
+
+  /* write uint32 array with stream-vbyte layout, the count isn't written,
+  ** the layout differs from a sequence of write_ix, read it by read_vbyte_array
+  */
+  void write_vbyte_array(const uint32_t* values, size_t count)
+  {
+    if (count)
+    {
+      auto ptr = outs_->prepare_bytes(detail::svb_encoded_size(values, count));
+      if (ptr)
+        detail::svb_encode(values, count, reinterpret_cast<uint8_t*>(ptr));
+    }
+  }
+  template <typename _Alloc>
+  void write_vbyte_array(const std::vector<uint32_t, _Alloc>& values)
+  {
+    write_vbyte_array(values.data(), values.size());
+  }
+
+  /* write float array as IEEE 754 half-precision, 2 bytes per value, the count isn't written */
+  void write_half_array(const float* values, size_t count)
+  {
+    if (count)
+    {
+      auto ptr = outs_->prepare_bytes(count * sizeof(uint16_t));
+      if (ptr)
+        detail::encode_half_array<convert_traits_type>(ptr, values, count);
+    }
+  }
+  template <typename _Alloc>
+  void write_half_array(const std::vector<float, _Alloc>& values)
+  {
+    write_half_array(values.data(), values.size());
+  }
+
   template <typename _Intty>
   void write_ix(_Intty value)
   {
@@ -499,6 +601,154 @@ using fast_obstream_any = basic_obstream<convert_traits<host_convert_tag>, _Exte
 using obstream      = obstream_any<dynamic_extent>;
 using fast_obstream = fast_obstream_any<dynamic_extent>;
 
+//-------- basic_chunked_obstream
+/*
+** The stream writes to pooled chunks, large message grows without reallocate & copy,
+** send by io_service::write(transport, std::move(obs.buffer())) as a gather write.
+** The offset based apis: pwrite, pop are patched across chunks.
+*/
+template <typename _ConvertTraits>
+class basic_chunked_obstream : public binary_writer_impl<_ConvertTraits, chunked_buffer> {
+public:
+  using super_type          = binary_writer_impl<_ConvertTraits, chunked_buffer>;
+  using convert_traits_type = _ConvertTraits;
+
+  using buffer_type = typename super_type::buffer_type;
+  explicit basic_chunked_obstream(chunk_pool* pool = &chunk_pool::get_default()) : super_type(&buffer_), buffer_(pool) {}
+  basic_chunked_obstream(const basic_chunked_obstream&) = delete;
+  basic_chunked_obstream(basic_chunked_obstream&& rhs) YASIO__NOEXCEPT : super_type(&buffer_), buffer_(std::move(rhs.buffer_)) {}
+
+  template <typename _Nty>
+  void pwrite(ptrdiff_t offset, const _Nty value)
+  {
+    auto nv = convert_traits_type::template to<_Nty>(value);
+    buffer_.write_bytes(static_cast<size_t>(offset), &nv, static_cast<int>(sizeof(nv)));
+  }
+
+#if defined(YASIO_OBS_BUILTIN_STACK)
+  // the base pops patch by data(), which the chunked buffer doesn't provide
+  void pop8() { pop_top<uint8_t>(); }
+  void pop8(uint8_t value) { pop_top<uint8_t>(value); }
+  void pop16() { pop_top<uint16_t>(); }
+  void pop16(uint16_t value) { pop_top<uint16_t>(value); }
+  void pop32() { pop_top<uint32_t>(); }
+  void pop32(uint32_t value) { pop_top<uint32_t>(value); }
+  using super_type::pop;
+#else
+  template <typename _Intty>
+  void pop(size_t offset)
+  {
+    this->pwrite(offset, static_cast<_Intty>(this->length() - offset - sizeof(_Intty)));
+  }
+  template <typename _Intty>
+  void pop(size_t offset, _Intty value)
+  {
+    this->pwrite(offset, value);
+  }
+#endif
+
+  // convert the whole elements fit in the tail chunk in bulk, the element crosses chunks by write
+  template <typename _Nty>
+  void write_array(const _Nty* values, size_t count)
+  {
+    static_assert(std::is_arithmetic<_Nty>::value, "yasio: write_array requires arithmetic type!");
+    while (count)
+    {
+      size_t avail;
+      auto ptr = buffer_.prepare(avail);
+      auto n   = (std::min)(count, avail / sizeof(_Nty));
+      if (n)
+      {
+        convert_traits_type::template to_array<_Nty>(ptr, values, n);
+        buffer_.commit(n * sizeof(_Nty));
+      }
+      else
+        this->write(*values), n = 1;
+      values += n;
+      count -= n;
+    }
+  }
+  template <typename _Nty, typename _Alloc>
+  void write_array(const std::vector<_Nty, _Alloc>& values)
+  {
+    write_array(values.data(), values.size());
+  }
+  template <typename _Nty, size_t _Size>
+  void write_array(const std::array<_Nty, _Size>& values)
+  {
+    write_array(values.data(), _Size);
+  }
+  template <typename _Nty, size_t _Size>
+  void write_array(const _Nty (&values)[_Size])
+  {
+    write_array(&values[0], _Size);
+  }
+#if YASIO__HAS_CXX20
+  template <typename _Nty, size_t _Extent>
+  void write_array(std::span<_Nty, _Extent> values)
+  {
+    write_array(values.data(), values.size());
+  }
+#endif
+
+  void write_vbyte_array(const uint32_t* values, size_t count)
+  {
+    if (count)
+    {
+      sbyte_buffer tmp;
+      tmp.resize(detail::svb_encoded_size(values, count));
+      detail::svb_encode(values, count, reinterpret_cast<uint8_t*>(tmp.data()));
+      this->write_bytes(tmp.data(), static_cast<int>(tmp.size()));
+    }
+  }
+  template <typename _Alloc>
+  void write_vbyte_array(const std::vector<uint32_t, _Alloc>& values)
+  {
+    write_vbyte_array(values.data(), values.size());
+  }
+
+  void write_half_array(const float* values, size_t count)
+  {
+    char block[detail::half_array_block * sizeof(uint16_t)];
+    while (count)
+    {
+      size_t n = (std::min)(count, static_cast<size_t>(detail::half_array_block));
+      detail::encode_half_array<convert_traits_type>(block, values, n);
+      this->write_bytes(block, static_cast<int>(n * sizeof(uint16_t)));
+      values += n;
+      count -= n;
+    }
+  }
+  template <typename _Alloc>
+  void write_half_array(const std::vector<float, _Alloc>& values)
+  {
+    write_half_array(values.data(), values.size());
+  }
+
+protected:
+#if defined(YASIO_OBS_BUILTIN_STACK)
+  template <typename _Intty>
+  void pop_top()
+  {
+    auto offset = this->offset_stack_.top();
+    this->pwrite(offset, static_cast<_Intty>(this->length() - offset - sizeof(_Intty)));
+    this->offset_stack_.pop();
+  }
+  template <typename _Intty>
+  void pop_top(_Intty value)
+  {
+    auto offset = this->offset_stack_.top();
+    this->pwrite(offset, value);
+    this->offset_stack_.pop();
+  }
+#endif
+
+  buffer_type buffer_;
+};
+
+using chunked_obstream      = basic_chunked_obstream<convert_traits<network_convert_tag>>;
+using fast_chunked_obstream = basic_chunked_obstream<convert_traits<host_convert_tag>>;
+
 //-------- basic_obstream_span
 template <typename _ConvertTraits, typename _Cont = sbyte_buffer>
 class basic_obstream_span;
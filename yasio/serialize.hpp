@@ -0,0 +1,421 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// A multi-platform support c++11 library with focus on asynchronous socket I/O for any
+// client application.
+//////////////////////////////////////////////////////////////////////////////////////////
+/*
+The MIT License (MIT)
+
+Copyright (c) 2012-2024 HALX99
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef YASIO__SERIALIZE_HPP
+#define YASIO__SERIALIZE_HPP
+#include <stddef.h>
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "yasio/compiler/feature_test.hpp"
+#include "yasio/string_view.hpp"
+
+/*
+** Describe the fields of message struct in wire order, i.e.
+**   struct player_info {
+**     int32_t id;
+**     std::string name;
+**     float x, y, z;
+**     YASIO_DEFINE_FIELDS(id, name, x, y, z)
+**   };
+** then write by yasio::serialize(obs, value) and read by yasio::deserialize(ibs, value),
+** the wire format is same as the hand-written obs.write<int32_t>(id), obs.write_v(name), ...
+*/
+#define YASIO_DEFINE_FIELDS(...)                                                                        \
+  auto yasio__fields() -> decltype(std::tie(__VA_ARGS__)) { return std::tie(__VA_ARGS__); }             \
+  auto yasio__fields() const -> decltype(std::tie(__VA_ARGS__)) { return std::tie(__VA_ARGS__); }
+
+namespace yasio
+{
+namespace detail
+{
+// the max bytes of consecutive fixed size fields encoded on stack then written by one write_bytes
+enum : size_t
+{
+  max_fixed_run_bytes = 512
+};
+
+inline size_t ix_size(uint32_t value)
+{
+  size_t n = 1;
+  for (; value >= 0x80; value >>= 7)
+    ++n;
+  return n;
+}
+
+template <typename _Ty, typename = void>
+struct has_fields : std::false_type {};
+template <typename _Ty>
+struct has_fields<_Ty, decltype((void)std::declval<_Ty&>().yasio__fields())> : std::true_type {};
+
+template <typename _Ty>
+using fields_tuple_t = decltype(std::declval<_Ty&>().yasio__fields());
+
+template <typename _Tuple, size_t _Index>
+using field_type_t = typename std::decay<typename std::tuple_element<_Index, _Tuple>::type>::type;
+
+// the integral type stored on the wire, enums are stored as it's underlying type
+template <typename _Ty, bool _IsEnum = std::is_enum<_Ty>::value>
+struct wire_type {
+  using type = _Ty;
+};
+template <typename _Ty>
+struct wire_type<_Ty, true> {
+  using type = typename std::underlying_type<_Ty>::type;
+};
+
+template <typename _Ty, typename = void>
+struct field_traits; // unsupported field type
+
+template <typename _Tuple, size_t _Index = 0, bool _End = (_Index >= std::tuple_size<_Tuple>::value)>
+struct fields_info {
+  using field_type                = field_type_t<_Tuple, _Index>;
+  using next_type                 = fields_info<_Tuple, _Index + 1>;
+  static const bool fixed         = field_traits<field_type>::fixed && next_type::fixed;
+  static const size_t fixed_size  = field_traits<field_type>::fixed_size + next_type::fixed_size;
+
+  static size_t size(const _Tuple& t) { return field_traits<field_type>::size(std::get<_Index>(t)) + next_type::size(t); }
+};
+template <typename _Tuple, size_t _Index>
+struct fields_info<_Tuple, _Index, true> {
+  static const bool fixed        = true;
+  static const size_t fixed_size = 0;
+  static size_t size(const _Tuple&) { return 0; }
+};
+
+// count of consecutive fixed size fields start at _Index, limited by max_fixed_run_bytes
+template <typename _Tuple, size_t _Index, size_t _Bytes = 0, bool _End = (_Index >= std::tuple_size<_Tuple>::value)>
+struct fixed_run {
+  using traits_type          = field_traits<field_type_t<_Tuple, _Index>>;
+  static const bool joinable = traits_type::fixed && (_Bytes + traits_type::fixed_size) <= max_fixed_run_bytes;
+  using next_type            = fixed_run<_Tuple, _Index + 1, _Bytes + traits_type::fixed_size>;
+  static const size_t count  = joinable ? 1 + next_type::count : 0;
+  static const size_t bytes  = joinable ? traits_type::fixed_size + next_type::bytes : 0;
+};
+template <typename _Tuple, size_t _Index, size_t _Bytes>
+struct fixed_run<_Tuple, _Index, _Bytes, true> {
+  static const size_t count = 0;
+  static const size_t bytes = 0;
+};
+
+// encode/decode fields [_Index, _Last) of fixed size run at raw memory
+template <typename _Stream, typename _Tuple, size_t _Index, size_t _Last, bool _End = (_Index >= _Last)>
+struct fixed_run_codec {
+  using traits_type = field_traits<field_type_t<_Tuple, _Index>>;
+  using next_type   = fixed_run_codec<_Stream, _Tuple, _Index + 1, _Last>;
+  static void put(char* ptr, const _Tuple& t)
+  {
+    traits_type::template put<_Stream>(ptr, std::get<_Index>(t));
+    next_type::put(ptr + traits_type::fixed_size, t);
+  }
+  static void get(const char* ptr, const _Tuple& t)
+  {
+    traits_type::template get<_Stream>(ptr, std::get<_Index>(t));
+    next_type::get(ptr + traits_type::fixed_size, t);
+  }
+};
+template <typename _Stream, typename _Tuple, size_t _Index, size_t _Last>
+struct fixed_run_codec<_Stream, _Tuple, _Index, _Last, true> {
+  static void put(char*, const _Tuple&) {}
+  static void get(const char*, const _Tuple&) {}
+};
+
+template <typename _Stream, typename _Tuple, size_t _Index = 0, size_t _Run = fixed_run<_Tuple, _Index>::count,
+          bool _End = (_Index >= std::tuple_size<_Tuple>::value)>
+struct fields_codec {
+  // the fixed size run: encode on stack and write once, read the whole run with one bounds check
+  static void write(_Stream& obs, const _Tuple& t)
+  {
+    char buf[fixed_run<_Tuple, _Index>::bytes];
+    fixed_run_codec<_Stream, _Tuple, _Index, _Index + _Run>::put(buf, t);
+    obs.write_bytes(buf, static_cast<int>(sizeof(buf)));
+    fields_codec<_Stream, _Tuple, _Index + _Run>::write(obs, t);
+  }
+  static void read(_Stream& ibs, const _Tuple& t)
+  {
+    auto run = ibs.read_bytes(static_cast<int>(fixed_run<_Tuple, _Index>::bytes));
+    if (yasio__unlikely(!run.data()))
+      return;
+    fixed_run_codec<_Stream, _Tuple, _Index, _Index + _Run>::get(run.data(), t);
+    fields_codec<_Stream, _Tuple, _Index + _Run>::read(ibs, t);
+  }
+};
+template <typename _Stream, typename _Tuple, size_t _Index>
+struct fields_codec<_Stream, _Tuple, _Index, 0, false> {
+  using traits_type = field_traits<field_type_t<_Tuple, _Index>>;
+  static void write(_Stream& obs, const _Tuple& t)
+  {
+    traits_type::write(obs, std::get<_Index>(t));
+    fields_codec<_Stream, _Tuple, _Index + 1>::write(obs, t);
+  }
+  static void read(_Stream& ibs, const _Tuple& t)
+  {
+    traits_type::read(ibs, std::get<_Index>(t));
+    fields_codec<_Stream, _Tuple, _Index + 1>::read(ibs, t);
+  }
+};
+template <typename _Stream, typename _Tuple, size_t _Index, size_t _Run>
+struct fields_codec<_Stream, _Tuple, _Index, _Run, true> {
+  static void write(_Stream&, const _Tuple&) {}
+  static void read(_Stream&, const _Tuple&) {}
+};
+
+// arithmetic & enum
+template <typename _Ty>
+struct field_traits<_Ty, typename std::enable_if<std::is_arithmetic<_Ty>::value || std::is_enum<_Ty>::value>::type> {
+  using wire_value_type          = typename wire_type<_Ty>::type;
+  static const bool fixed        = true;
+  static const size_t fixed_size = sizeof(_Ty);
+
+  static size_t size(const _Ty&) { return fixed_size; }
+  template <typename _Stream>
+  static void put(char* ptr, const _Ty& value)
+  {
+    _Stream::swrite(ptr, static_cast<wire_value_type>(value));
+  }
+  template <typename _Stream>
+  static void get(const char* ptr, _Ty& value)
+  {
+    value = static_cast<_Ty>(_Stream::template sread<wire_value_type>(ptr));
+  }
+  template <typename _Stream>
+  static void write(_Stream& obs, const _Ty& value)
+  {
+    obs.write(static_cast<wire_value_type>(value));
+  }
+  template <typename _Stream>
+  static void read(_Stream& ibs, _Ty& value)
+  {
+    value = static_cast<_Ty>(ibs.template read<wire_value_type>());
+  }
+};
+
+// std::array of fixed size elements
+template <typename _Ty, size_t _Size>
+struct field_traits<std::array<_Ty, _Size>, typename std::enable_if<field_traits<_Ty>::fixed>::type> {
+  using elem_traits              = field_traits<_Ty>;
+  static const bool fixed        = true;
+  static const size_t fixed_size = elem_traits::fixed_size * _Size;
+
+  static size_t size(const std::array<_Ty, _Size>&) { return fixed_size; }
+  template <typename _Stream>
+  static void put(char* ptr, const std::array<_Ty, _Size>& value)
+  {
+    for (size_t i = 0; i < _Size; ++i, ptr += elem_traits::fixed_size)
+      elem_traits::template put<_Stream>(ptr, value[i]);
+  }
+  template <typename _Stream>
+  static void get(const char* ptr, std::array<_Ty, _Size>& value)
+  {
+    for (size_t i = 0; i < _Size; ++i, ptr += elem_traits::fixed_size)
+      elem_traits::template get<_Stream>(ptr, value[i]);
+  }
+  template <typename _Stream>
+  static void write(_Stream& obs, const std::array<_Ty, _Size>& value)
+  {
+    for (auto& elem : value)
+      elem_traits::write(obs, elem);
+  }
+  template <typename _Stream>
+  static void read(_Stream& ibs, std::array<_Ty, _Size>& value)
+  {
+    for (auto& elem : value)
+      elem_traits::read(ibs, elem);
+  }
+};
+
+// string with '7bit encoded int' length field, same as write_v/read_v
+template <typename _Ty>
+struct field_traits<_Ty, typename std::enable_if<std::is_same<_Ty, std::string>::value || std::is_same<_Ty, cxx17::string_view>::value>::type> {
+  static const bool fixed        = false;
+  static const size_t fixed_size = 0;
+
+  static size_t size(const _Ty& value) { return ix_size(static_cast<uint32_t>(value.size())) + value.size(); }
+  template <typename _Stream>
+  static void write(_Stream& obs, const _Ty& value)
+  {
+    obs.write_v(value);
+  }
+  template <typename _Stream>
+  static void read(_Stream& ibs, std::string& value)
+  {
+    auto sv = ibs.read_v();
+    value.assign(sv.data(), sv.size());
+  }
+  // the view is valid while the input buffer alive
+  template <typename _Stream>
+  static void read(_Stream& ibs, cxx17::string_view& value)
+  {
+    value = ibs.read_v();
+  }
+};
+
+// std::vector with '7bit encoded int' count field, the arithmetic elements are converted in bulk
+template <typename _Ty, typename _Alloc>
+struct field_traits<std::vector<_Ty, _Alloc>> {
+  static_assert(!std::is_same<_Ty, bool>::value, "yasio: std::vector<bool> field not supported!");
+  using elem_traits              = field_traits<_Ty>;
+  static const bool fixed        = false;
+  static const size_t fixed_size = 0;
+
+  static size_t size(const std::vector<_Ty, _Alloc>& value)
+  {
+    size_t n = ix_size(static_cast<uint32_t>(value.size()));
+    if (elem_traits::fixed)
+      return n + value.size() * elem_traits::fixed_size;
+    for (auto& elem : value)
+      n += elem_traits::size(elem);
+    return n;
+  }
+  template <typename _Stream>
+  static void write(_Stream& obs, const std::vector<_Ty, _Alloc>& value)
+  {
+    obs.write_ix(static_cast<int32_t>(value.size()));
+    write_elems(obs, value, std::is_arithmetic<_Ty>{});
+  }
+  template <typename _Stream>
+  static void read(_Stream& ibs, std::vector<_Ty, _Alloc>& value)
+  {
+    auto count = ibs.template read_ix<int32_t>();
+    if (yasio__unlikely(count < 0))
+      YASIO__THROW0(std::logic_error("yasio: negative count of vector field"));
+    read_elems(ibs, value, static_cast<size_t>(count), std::is_arithmetic<_Ty>{});
+  }
+
+private:
+  template <typename _Stream>
+  static void write_elems(_Stream& obs, const std::vector<_Ty, _Alloc>& value, std::true_type)
+  {
+    obs.write_array(value.data(), value.size());
+  }
+  template <typename _Stream>
+  static void write_elems(_Stream& obs, const std::vector<_Ty, _Alloc>& value, std::false_type)
+  {
+    for (auto& elem : value)
+      elem_traits::write(obs, elem);
+  }
+  template <typename _Stream>
+  static void read_elems(_Stream& ibs, std::vector<_Ty, _Alloc>& value, size_t count, std::true_type)
+  {
+    ibs.read_array(value, count);
+  }
+  template <typename _Stream>
+  static void read_elems(_Stream& ibs, std::vector<_Ty, _Alloc>& value, size_t count, std::false_type)
+  {
+    value.clear();
+    for (size_t i = 0; i < count && !ibs.eof(); ++i)
+    {
+      value.emplace_back();
+      elem_traits::read(ibs, value.back());
+    }
+  }
+};
+
+// nested struct described by YASIO_DEFINE_FIELDS, it's fixed size when all fields are fixed size
+template <typename _Ty>
+struct field_traits<_Ty, typename std::enable_if<has_fields<_Ty>::value>::type> {
+  using tuple_type               = fields_tuple_t<const _Ty>;
+  using mutable_tuple_type       = fields_tuple_t<_Ty>;
+  using info_type                = fields_info<tuple_type>;
+  static const bool fixed        = info_type::fixed;
+  static const size_t fixed_size = info_type::fixed ? info_type::fixed_size : 0;
+
+  static size_t size(const _Ty& value) { return fixed ? fixed_size : info_type::size(value.yasio__fields()); }
+  template <typename _Stream>
+  static void put(char* ptr, const _Ty& value)
+  {
+    fixed_run_codec<_Stream, tuple_type, 0, std::tuple_size<tuple_type>::value>::put(ptr, value.yasio__fields());
+  }
+  template <typename _Stream>
+  static void get(const char* ptr, _Ty& value)
+  {
+    fixed_run_codec<_Stream, mutable_tuple_type, 0, std::tuple_size<mutable_tuple_type>::value>::get(ptr, value.yasio__fields());
+  }
+  template <typename _Stream>
+  static void write(_Stream& obs, const _Ty& value)
+  {
+    fields_codec<_Stream, tuple_type>::write(obs, value.yasio__fields());
+  }
+  template <typename _Stream>
+  static void read(_Stream& ibs, _Ty& value)
+  {
+    fields_codec<_Stream, mutable_tuple_type>::read(ibs, value.yasio__fields());
+  }
+};
+
+template <typename _Cont>
+inline auto reserve_for(_Cont& outs, size_t size, int) -> decltype(outs.capacity(), void())
+{
+  if (outs.capacity() < size) // grow geometric, so serialize many objects to one stream is amortized O(1)
+    outs.reserve((std::max)(size, outs.capacity() * 3 / 2));
+}
+template <typename _Cont>
+inline void reserve_for(_Cont& outs, size_t size, long)
+{
+  outs.reserve(size);
+}
+} // namespace detail
+
+/* The packed size of struct is compile time constant if all fields are fixed size */
+template <typename _Ty>
+struct is_fixed_packed : std::integral_constant<bool, detail::field_traits<_Ty>::fixed> {};
+template <typename _Ty>
+struct fixed_packed_size : std::integral_constant<size_t, detail::field_traits<_Ty>::fixed_size> {
+  static_assert(detail::field_traits<_Ty>::fixed, "yasio: the type is not fixed size!");
+};
+
+/* The exact bytes of value serialized */
+template <typename _Ty>
+inline size_t packed_size(const _Ty& value)
+{
+  return detail::field_traits<_Ty>::size(value);
+}
+
+/*
+** Serialize value to obstream or obstream_span, the capacity reserved once with exact packed size,
+** and the consecutive fixed size fields written by one write_bytes.
+*/
+template <typename _Stream, typename _Ty>
+inline void serialize(_Stream& obs, const _Ty& value)
+{
+  detail::reserve_for(obs.buffer(), obs.length() + packed_size(value), 0);
+  detail::field_traits<_Ty>::write(obs, value);
+}
+
+/* Deserialize value from ibstream or ibstream_view, the consecutive fixed size fields read with one bounds check */
+template <typename _Stream, typename _Ty>
+inline void deserialize(_Stream& ibs, _Ty& value)
+{
+  detail::field_traits<_Ty>::read(ibs, value);
+}
+} // namespace yasio
+#endif
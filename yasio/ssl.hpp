@@ -30,16 +30,22 @@ SOFTWARE.
 #define YASIO__SSL_HPP
 
 #include "yasio/config.hpp"
+#include <string>
+#include <vector>
 
 #if YASIO_SSL_BACKEND == 1 // OpenSSL
 #  include <openssl/bio.h>
 #  include <openssl/ssl.h>
 #  include <openssl/err.h>
 typedef struct ssl_ctx_st yssl_ctx_st;
+typedef SSL_SESSION yssl_session_st;
 struct yssl_st {
   ssl_st* session;
   int fd;
-  BIO_METHOD* bmth;
+  bool sock_bio;          // the ssl uses OpenSSL socket BIO for kTLS, otherwise our BIO shared by context
+  std::string key;        // the session cache key 'host:port', client only
+  int early_state;        // the early data(0-RTT) state, see: YSSL_EARLY_XXX
+  std::string early_data; // the early data sent, replay after handshake when server rejected
 };
 #  define yssl_unwrap(ssl) ssl->session
 
@@ -52,15 +58,26 @@ struct yssl_st {
 #  include "mbedtls/ctr_drbg.h"
 #  include "mbedtls/error.h"
 #  include "mbedtls/version.h"
+struct yssl_session_cache;
 typedef struct ssl_ctx_st {
   mbedtls_ctr_drbg_context ctr_drbg;
   mbedtls_entropy_context entropy;
   mbedtls_x509_crt cert;
   mbedtls_pk_context pkey;
   mbedtls_ssl_config conf;
+  yssl_session_cache* sessions;
+  std::vector<struct yssl_st*> pool; // the idle ssl contexts for reuse
+  int pool_size;
 } yssl_ctx_st;
+typedef mbedtls_ssl_session yssl_session_st;
 struct yssl_st : public mbedtls_ssl_context {
   mbedtls_net_context bio;
+  yssl_ctx_st* owner;
+  yssl_session_cache* sessions;
+  std::string key;        // the session cache key 'host:port', client only
+  std::string offered_id; // the session id offered by mbedtls_ssl_set_session, client only
+  bool offered;           // whether mbedtls_ssl_set_session succeeded
+  int resumed;            // see yssl_session_reused
 };
 #endif
 
@@ -69,13 +86,67 @@ struct yssl_options {
   char* crtfile_;
   char* keyfile_;
   bool client;
+  int session_cache_size_; // client only, the max count of cached sessions, 0: disable session resumption
+  bool early_data_;        // client only, whether send early data(0-RTT) with resumed session
+  bool ktls_;              // whether hand over record crypto to kernel after handshake, OpenSSL 3 on Linux only
+  int pool_size_;          // the max count of closed ssl objects kept for reuse, 0: disable
+  bool release_buffers_;   // whether free the record buffers of idle connections, OpenSSL only
+};
+
+/*
+** The client session cache, keyed by 'host:port', the most recent stored session is at back,
+** the least recent one is evicted when full.
+*/
+YASIO__DECL void yssl_session_free(yssl_session_st* session);
+struct yssl_session_cache {
+  explicit yssl_session_cache(int capacity, bool early_data) : capacity_(capacity), early_data_(early_data) {}
+  ~yssl_session_cache()
+  {
+    for (auto& item : sessions_)
+      yssl_session_free(item.second);
+  }
+  void put(const std::string& key, yssl_session_st* session)
+  {
+    if (auto old = take(key, true))
+      yssl_session_free(old);
+    if (static_cast<int>(sessions_.size()) >= capacity_)
+    {
+      yssl_session_free(sessions_.front().second);
+      sessions_.erase(sessions_.begin());
+    }
+    sessions_.emplace_back(key, session);
+  }
+  // Gets the session of key, the caller owns the session when remove is true
+  yssl_session_st* take(const std::string& key, bool remove)
+  {
+    for (auto it = sessions_.begin(); it != sessions_.end(); ++it)
+    {
+      if (it->first != key)
+        continue;
+      auto session = it->second;
+      if (remove)
+        sessions_.erase(it);
+      return session;
+    }
+    return nullptr;
+  }
+
+  int capacity_;
+  bool early_data_;
+  std::vector<std::pair<std::string, yssl_session_st*>> sessions_;
 };
 
 YASIO__DECL yssl_ctx_st* yssl_ctx_new(const yssl_options& opts);
 YASIO__DECL void yssl_ctx_free(yssl_ctx_st*& ctx);
 
-YASIO__DECL yssl_st* yssl_new(yssl_ctx_st* ctx, int fd, const char* hostname, bool client);
+/*
+** Creates ssl of connection, the client resumes the cached session of 'hostname:port' if present,
+** the ssl closed by yssl_shutdown is reset and reused when the pool of context not empty.
+*/
+YASIO__DECL yssl_st* yssl_new(yssl_ctx_st* ctx, int fd, const char* hostname, unsigned short port, bool client);
 YASIO__DECL void yssl_shutdown(yssl_st*&, bool writable);
+// Frees the ssl without close_notify and pooling, the context pool untouched, so it can be called on other thread
+YASIO__DECL void yssl_free(yssl_st*&);
 
 /**
 * @returns
@@ -86,10 +157,32 @@ YASIO__DECL void yssl_shutdown(yssl_st*&, bool writable);
 *      - yasio::errc::ssl_handshake_failed: failed
 */
 YASIO__DECL int yssl_do_handshake(yssl_st* ssl, int& err);
+// Whether the last handshake step blocked on writing, i.e. the send buffer of socket is full
+YASIO__DECL bool yssl_want_write(yssl_st* ssl);
 YASIO__DECL const char* yssl_strerror(yssl_st* ssl, int sslerr, char* buf, size_t buflen);
 
 YASIO__DECL int yssl_write(yssl_st* ssl, const void* data, size_t len, int& err);
 YASIO__DECL int yssl_read(yssl_st* ssl, void* data, size_t len, int& err);
+
+// Whether the finished handshake is resumed from cached session, 1: resumed, 0: full handshake,
+// -1: unknown, i.e. TLS 1.3 of mbedtls
+YASIO__DECL int yssl_session_reused(yssl_st* ssl);
+/*
+** Whether the client can write early data before handshake finished,
+** the early data rejected by server will be replayed by yssl_write after handshake,
+** call yssl_write with len=0 to flush it.
+*/
+YASIO__DECL bool yssl_early_writable(yssl_st* ssl);
+// Whether the early data accepted by server, only valid after handshake finished
+YASIO__DECL bool yssl_early_data_accepted(yssl_st* ssl);
+
+/*
+** Whether the kernel TLS(kTLS) encrypts the records sent, only valid after handshake finished,
+** if true, the plain data can be sent to socket directly.
+*/
+YASIO__DECL bool yssl_ktls_send(yssl_st* ssl);
+// Whether the kernel TLS decrypts the records received, only valid after handshake finished
+YASIO__DECL bool yssl_ktls_recv(yssl_st* ssl);
 #endif
 
 ///////////////////////////////////////////////////////////////////
@@ -39,6 +39,7 @@ SOFTWARE.
 #include "yasio/utils.hpp"
 
 #if !defined(_WIN32)
+#  include <sys/uio.h>
 #  include "yasio/impl/ifaddrs.hpp"
 #endif
 
@@ -768,6 +769,41 @@ int xxsocket::recv_n(socket_native_type s, void* buf, int len, std::chrono::micr
 int xxsocket::send(const void* buf, int len, int flags) const { return static_cast<int>(::send(this->fd, (const char*)buf, len, flags)); }
 int xxsocket::send(socket_native_type s, const void* buf, int len, int flags) { return static_cast<int>(::send(s, (const char*)buf, len, flags)); }
 
+int xxsocket::sendv(const cxx17::string_view* bufs, int count, int flags) const { return xxsocket::sendv(this->fd, bufs, count, flags); }
+int xxsocket::sendv(socket_native_type s, const cxx17::string_view* bufs, int count, int flags)
+{
+  enum
+  {
+    max_iov_count = 64
+  };
+  if (count > max_iov_count)
+    count = max_iov_count;
+#if defined(_WIN32)
+  WSABUF iov[max_iov_count];
+  for (int i = 0; i < count; ++i)
+  {
+    iov[i].buf = const_cast<char*>(bufs[i].data());
+    iov[i].len = static_cast<ULONG>(bufs[i].size());
+  }
+  DWORD bytes_transferred = 0;
+  if (::WSASend(s, iov, static_cast<DWORD>(count), &bytes_transferred, static_cast<DWORD>(flags), nullptr, nullptr) != 0)
+    return -1;
+  return static_cast<int>(bytes_transferred);
+#else
+  struct iovec iov[max_iov_count];
+  for (int i = 0; i < count; ++i)
+  {
+    iov[i].iov_base = const_cast<char*>(bufs[i].data());
+    iov[i].iov_len  = bufs[i].size();
+  }
+  struct msghdr msg;
+  ::memset(&msg, 0, sizeof(msg));
+  msg.msg_iov    = iov;
+  msg.msg_iovlen = count;
+  return static_cast<int>(::sendmsg(s, &msg, flags));
+#endif
+}
+
 int xxsocket::recv(void* buf, int len, int flags) const { return static_cast<int>(this->recv(this->fd, buf, len, flags)); }
 int xxsocket::recv(socket_native_type s, void* buf, int len, int flags) { return static_cast<int>(::recv(s, (char*)buf, len, flags)); }
 
@@ -833,6 +833,17 @@ public:
   YASIO__DECL int send(const void* buf, int len, int flags = 0) const;
   YASIO__DECL static int send(socket_native_type fd, const void* buf, int len, int flags = 0);
 
+  /* @brief: Sends multi buffers on this connected socket by one system call (gather write)
+  ** @params:
+  **        bufs: the buffers to send in order
+  **        count: count of buffers, at most 64 buffers will be sent per call
+  **
+  ** @returns:
+  **         Same as send, the total bytes sent may less than sum of buffers.
+  */
+  YASIO__DECL int sendv(const cxx17::string_view* bufs, int count, int flags = 0) const;
+  YASIO__DECL static int sendv(socket_native_type fd, const cxx17::string_view* bufs, int count, int flags = 0);
+
   /* @brief: Receives data from this connected socket or a bound connectionless socket.
   ** @params: omit
   **
@@ -1142,6 +1153,46 @@ private:
   socket_native_type fd;
 }; // namespace inet
 
+#if defined(__linux__)
+/*
+** Blocks SIGPIPE of current thread in the scope, for the primitives can't send with MSG_NOSIGNAL,
+** i.e. sendfile, splice and the socket BIO of OpenSSL, the SIGPIPE raised in the scope is discarded.
+*/
+class sigpipe_guard {
+public:
+  explicit sigpipe_guard(bool enabled = true)
+  {
+    skip_ = !enabled;
+    if (skip_)
+      return;
+    sigset_t pending;
+    sigemptyset(&mask_);
+    sigaddset(&mask_, SIGPIPE);
+    sigpending(&pending);
+    // the SIGPIPE pending already is blocked by the thread and raised outside of the scope, leave it alone
+    skip_ = sigismember(&pending, SIGPIPE) == 1;
+    if (!skip_)
+      pthread_sigmask(SIG_BLOCK, &mask_, &old_);
+  }
+  ~sigpipe_guard()
+  {
+    if (skip_)
+      return;
+    int error        = errno; // the caller checks errno of the primitive after the scope
+    timespec timeout = {0, 0};
+    while (sigtimedwait(&mask_, nullptr, &timeout) == -1 && errno == EINTR)
+      ;
+    pthread_sigmask(SIG_SETMASK, &old_, nullptr);
+    errno = error;
+  }
+
+private:
+  sigset_t mask_;
+  sigset_t old_;
+  bool skip_;
+};
+#endif
+
 } // namespace inet
 #if !YASIO__HAS_CXX11
 using namespace yasio::inet;